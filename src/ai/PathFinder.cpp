@@ -52,6 +52,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #include "math/Random.h"
 #include "math/Vector3.h"
 #include "platform/Platform.h"
+#include "physics/AnchorTree.h"
 #include "physics/Anchors.h"
 
 static const float MIN_RADIUS = 110.0f;
@@ -189,9 +190,11 @@ public:
 };
 
 PathFinder::PathFinder(size_t map_size, const ANCHOR_DATA * map_data,
-                       size_t slight_count, const EERIE_LIGHT * const * slight_list)
+                       size_t slight_count, const EERIE_LIGHT * const * slight_list,
+                       const AnchorTree * map_tree)
 	: radius(RADIUS_DEFAULT), height(HEIGHT_DEFAULT), heuristic(HEURISTIC_DEFAULT),
-	  map_s(map_size), map_d(map_data), slight_c(slight_count), slight_l(slight_list) { }
+	  map_s(map_size), map_d(map_data), map_t(map_tree),
+	  slight_c(slight_count), slight_l(slight_list) { }
 
 void PathFinder::setHeuristic(float _heuristic) {
 	if(_heuristic >= HEURISTIC_MAX) {
@@ -396,6 +399,11 @@ bool PathFinder::wanderAround(NodeId from, float rad, Result & rlist, bool steal
 
 PathFinder::NodeId PathFinder::getNearestNode(const Vec3f & pos) const {
 	
+	if(map_t) {
+		long best = map_t->getNearest(pos);
+		return (best < 0) ? 0 : NodeId(best);
+	}
+	
 	NodeId best = 0;
 	float distance = std::numeric_limits<float>::max();
 	
@@ -50,6 +50,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #include "math/MathFwd.h"
 
 struct ANCHOR_DATA;
+class AnchorTree;
 struct EERIE_LIGHT;
 
 
@@ -68,9 +69,12 @@ public:
 	 * Create a PathFinder instance for the provided data.
 	 * The pathfinder instance does not copy the provided data and will not clean it up
 	 * The light data is only used when the stealth parameter is set to true.
+	 * If a spatial index for the map data is provided, it is used to find the
+	 * node nearest to a position instead of checking every node.
 	 */
 	PathFinder(size_t map_size, const ANCHOR_DATA * map_data,
-	           size_t light_count, const EERIE_LIGHT * const * light_list);
+	           size_t light_count, const EERIE_LIGHT * const * light_list,
+	           const AnchorTree * map_tree = NULL);
 	
 	typedef unsigned long NodeId;
 	typedef std::vector<NodeId> Result;
@@ -151,6 +155,7 @@ private:
 	
 	size_t map_s; // Map size
 	const ANCHOR_DATA * map_d; // Map data
+	const AnchorTree * map_t; // Map spatial index
 	size_t slight_c; // Light count
 	const EERIE_LIGHT * const * slight_l; // Light data
 	
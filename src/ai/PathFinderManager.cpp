@@ -58,6 +58,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #include "platform/Lock.h"
 #include "physics/Anchors.h"
 #include "scene/Light.h"
+#include "script/Script.h"
 
 using std::memcpy;
 
@@ -244,7 +245,7 @@ void PathFinderThread::run() {
 	
 	EERIE_BACKGROUND * eb = ACTIVEBKG;
 	PathFinder pathfinder(eb->nbanchors, eb->anchors,
-	                      MAX_LIGHTS, (EERIE_LIGHT **)GLight);
+	                      MAX_LIGHTS, (EERIE_LIGHT **)GLight, eb->anchorTree);
 
 	while(!isStopRequested()) {
 		
@@ -326,6 +327,8 @@ void PathFinderThread::run() {
 				}
 				*(curpr.returnnumber) = result.size();
 				
+				ARX_SCRIPT_EventStackPost(curpr.handle, result.empty() ? SM_PATHFINDER_FAILURE
+				                                                       : SM_PATHFINDER_SUCCESS);
 			}
 		}
 
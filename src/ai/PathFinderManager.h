@@ -47,6 +47,8 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #ifndef ARX_AI_PATHFINDERMANAGER_H
 #define ARX_AI_PATHFINDERMANAGER_H
 
+#include "game/EntityManager.h"
+
 class Entity;
 
 struct PATHFINDER_REQUEST {
@@ -57,6 +59,7 @@ struct PATHFINDER_REQUEST {
 	// As soon as returnnumber is no more -1
 	// Pathfinding is considered finished
 	Entity * ioid;
+	EntityHandle handle; //!< Receives the pathfinder success or failure event
 	unsigned short ** returnlist;	//must be NULL
 };
 
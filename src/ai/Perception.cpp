@@ -0,0 +1,128 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ai/Perception.h"
+
+#include <boost/unordered_map.hpp>
+
+#include "core/GameTime.h"
+#include "game/EntityManager.h"
+#include "graphics/Math.h"
+#include "physics/Collisions.h"
+#include "platform/Platform.h"
+
+namespace {
+
+//! Number of ray casts per frame that may be used for non-forced tests
+const size_t RAY_BUDGET = 8;
+
+//! Distance either end point may move before a cached result is discarded
+const float MOVE_THRESHOLD = 20.f;
+
+//! Time in milliseconds after which a cached result is discarded
+const float MAX_AGE = 1000.f;
+
+struct LineOfSightEntry {
+	EntityHandle observer;
+	EntityHandle target;
+	Vec3f orgn;
+	Vec3f dest;
+	float time;
+	bool visible;
+};
+
+typedef boost::unordered_map<u64, LineOfSightEntry> LineOfSightCache;
+
+LineOfSightCache cache;
+size_t raysLeft = RAY_BUDGET;
+float lastSweep = 0.f;
+
+bool isExpired(const LineOfSightEntry & entry, float now) {
+	return entry.time > now || now - entry.time >= MAX_AGE;
+}
+
+} // anonymous namespace
+
+void ARX_PERCEPTION_BeginFrame() {
+	
+	raysLeft = RAY_BUDGET;
+	
+	float now = float(arxtime);
+	if(now >= lastSweep && now - lastSweep < MAX_AGE) {
+		return;
+	}
+	
+	lastSweep = now;
+	
+	LineOfSightCache::iterator it = cache.begin();
+	while(it != cache.end()) {
+		if(isExpired(it->second, now)) {
+			it = cache.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+void ARX_PERCEPTION_Reset() {
+	cache.clear();
+	raysLeft = RAY_BUDGET;
+	lastSweep = 0.f;
+}
+
+Visibility ARX_PERCEPTION_LineOfSight(const Entity * observer, const Entity * target,
+                                      const Vec3f & orgn, const Vec3f & dest,
+                                      bool force) {
+	
+	EntityHandle observerHandle = entities.handle(observer);
+	EntityHandle targetHandle = entities.handle(target);
+	u64 key = (u64(observerHandle.index()) << 32) | u64(targetHandle.index());
+	
+	float now = float(arxtime);
+	
+	LineOfSightCache::iterator it = cache.find(key);
+	if(it != cache.end()) {
+		const LineOfSightEntry & entry = it->second;
+		if(entry.observer == observerHandle && entry.target == targetHandle
+		   && !isExpired(entry, now) && closerThan(entry.orgn, orgn, MOVE_THRESHOLD)
+		   && closerThan(entry.dest, dest, MOVE_THRESHOLD)) {
+			return entry.visible ? VISIBILITY_VISIBLE : VISIBILITY_HIDDEN;
+		}
+	}
+	
+	if(raysLeft > 0) {
+		raysLeft--;
+	} else if(!force) {
+		return VISIBILITY_UNKNOWN;
+	}
+	
+	Vec3f start = orgn, end = dest, hit;
+	bool visible = IO_Visible(&start, &end, NULL, &hit) || distSqr(hit, dest) < square(25.f);
+	
+	LineOfSightEntry & entry = cache[key];
+	entry.observer = observerHandle;
+	entry.target = targetHandle;
+	entry.orgn = orgn;
+	entry.dest = dest;
+	entry.time = now;
+	entry.visible = visible;
+	
+	return visible ? VISIBILITY_VISIBLE : VISIBILITY_HIDDEN;
+}
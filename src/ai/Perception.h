@@ -0,0 +1,59 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ARX_AI_PERCEPTION_H
+#define ARX_AI_PERCEPTION_H
+
+#include "math/Vector3.h"
+
+class Entity;
+
+enum Visibility {
+	VISIBILITY_UNKNOWN, //!< The test was deferred to a later frame
+	VISIBILITY_HIDDEN,
+	VISIBILITY_VISIBLE
+};
+
+/*!
+ * Start a new frame of perception checks.
+ * This resets the per-frame ray cast budget and drops old cached results.
+ */
+void ARX_PERCEPTION_BeginFrame();
+
+//! Forget all cached line of sight results.
+void ARX_PERCEPTION_Reset();
+
+/*!
+ * Check if there is a line of sight between two entities.
+ *
+ * Results are cached per observer and target and reused for a short time as long
+ * as neither the origin nor the destination moved noticeably. Only a limited
+ * number of ray casts are made each frame: if the budget is used up, the test is
+ * deferred and VISIBILITY_UNKNOWN is returned unless force is set.
+ *
+ * @param orgn the eye position of the observer
+ * @param dest the position of the target to look at
+ * @param force always return a result, even if the ray cast budget is used up
+ */
+Visibility ARX_PERCEPTION_LineOfSight(const Entity * observer, const Entity * target,
+                                      const Vec3f & orgn, const Vec3f & dest,
+                                      bool force = false);
+
+#endif // ARX_AI_PERCEPTION_H
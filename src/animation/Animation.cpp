@@ -377,6 +377,76 @@ void GetAnimTotalTranslate( ANIM_HANDLE * eanim, long alt_idx, Vec3f * pos) {
 	}
 }
 
+static bool IsInKeyFrame(const EERIE_ANIM * eanim, long i, long tim) {
+	long tcf = long(eanim->frames[i - 1].time);
+	long tnf = long(eanim->frames[i].time);
+	return (tim < tnf && tim >= tcf) || (i == eanim->nb_key_frames - 1 && tim == tnf);
+}
+
+/*!
+ * Find the key frame pair containing the given time.
+ * Gives the same result as walking the frames in order: pairs within the ordered
+ * frames cannot overlap, so the pair after the last one found (hint) is tried first
+ * and then a binary search is done, only frames beyond that are searched linearly.
+ * \return the index of the second frame of the pair, or -1 if there is none
+ */
+static long FindKeyFrame(const EERIE_ANIM * eanim, long tim, long hint) {
+	
+	long ordered = eanim->nb_ordered_frames;
+	
+	for(long i = hint + 1; i <= hint + 2; i++) {
+		if(i >= 1 && i < ordered && IsInKeyFrame(eanim, i, tim)) {
+			return i;
+		}
+	}
+	
+	if(ordered >= 2) {
+		long low = 1, high = ordered;
+		while(low < high) {
+			long mid = (low + high) / 2;
+			if(tim < long(eanim->frames[mid].time)) {
+				high = mid;
+			} else {
+				low = mid + 1;
+			}
+		}
+		long i = min(low, ordered - 1);
+		if(IsInKeyFrame(eanim, i, tim)) {
+			return i;
+		}
+	}
+	
+	for(long i = max(ordered, 1l); i < eanim->nb_key_frames; i++) {
+		if(long(eanim->frames[i - 1].time) == long(eanim->frames[i].time)) {
+			return -1;
+		}
+		if(IsInKeyFrame(eanim, i, tim)) {
+			return i;
+		}
+	}
+	
+	return -1;
+}
+
+const EERIE_GROUP * GetAnimationPose(const EERIE_ANIM * eanim, long fr, float pour) {
+	
+	arx_assert(fr >= 0 && fr + 1 < eanim->nb_key_frames);
+	
+	static vector<EERIE_GROUP> pose;
+	pose.resize(eanim->nb_groups);
+	
+	EERIE_GROUP * sGroup = &eanim->groups[fr * eanim->nb_groups];
+	EERIE_GROUP * eGroup = sGroup + eanim->nb_groups;
+	for(long j = 0; j < eanim->nb_groups; j++) {
+		pose[j].key = sGroup[j].key;
+		Quat_Slerp(&pose[j].quat, &sGroup[j].quat, &eGroup[j].quat, pour);
+		pose[j].translate = sGroup[j].translate + (eGroup[j].translate - sGroup[j].translate) * pour;
+		pose[j].zoom = sGroup[j].zoom + (eGroup[j].zoom - sGroup[j].zoom) * pour;
+	}
+	
+	return &pose[0];
+}
+
 // Main Procedure to draw an animated object
 //------------------------------------------
 // Needs some update...
@@ -501,69 +571,66 @@ suite:
 	else
 		tim=eanim->ctime;
 
+	long hint = eanim->fr;
 	eanim->fr=eanim->cur_anim->anims[eanim->altidx_cur]->nb_key_frames-2;
 	eanim->pour=1.f;
 
-	for (long i=1;i<eanim->cur_anim->anims[eanim->altidx_cur]->nb_key_frames;i++)
-	{
-		tcf=(long)eanim->cur_anim->anims[eanim->altidx_cur]->frames[i-1].time;
-		tnf=(long)eanim->cur_anim->anims[eanim->altidx_cur]->frames[i].time;
-
-		if (tcf == tnf) return;
+	long i = FindKeyFrame(eanim->cur_anim->anims[eanim->altidx_cur], tim, hint);
+	if(i < 0) {
+		return;
+	}
+	
+	tcf=(long)eanim->cur_anim->anims[eanim->altidx_cur]->frames[i-1].time;
+	tnf=(long)eanim->cur_anim->anims[eanim->altidx_cur]->frames[i].time;
 
-		if(((tim<tnf) && (tim>=tcf))
-		   || ((i==eanim->cur_anim->anims[eanim->altidx_cur]->nb_key_frames-1) && (tim==tnf))) {
-			
-			fr=i-1;
-			tim-=tcf;
-			pour=(float)((float)tim/((float)tnf-(float)tcf));
-			
-			// Frame Sound Management
-			if(!(eanim->flags & EA_ANIMEND) && time
-			   && (eanim->cur_anim->anims[eanim->altidx_cur]->frames[fr].sample != -1)
-			   && (eanim->lastframe != fr)) {
-				
-				if ((eanim->lastframe<fr) && (eanim->lastframe!=-1))
-				{
-					for (long n=eanim->lastframe+1;n<=fr;n++)
-						ARX_SOUND_PlayAnim(eanim->cur_anim->anims[eanim->altidx_cur]->frames[n].sample,
-						                   io ? &io->pos : NULL);
-				}
-				else
-				{
-					ARX_SOUND_PlayAnim(eanim->cur_anim->anims[eanim->altidx_cur]->frames[fr].sample,
-					                   io ? &io->pos : NULL);
-				}
-			}
+	fr=i-1;
+	tim-=tcf;
+	pour=(float)((float)tim/((float)tnf-(float)tcf));
+	
+	// Frame Sound Management
+	if(!(eanim->flags & EA_ANIMEND) && time
+	   && (eanim->cur_anim->anims[eanim->altidx_cur]->frames[fr].sample != -1)
+	   && (eanim->lastframe != fr)) {
+		
+		if ((eanim->lastframe<fr) && (eanim->lastframe!=-1))
+		{
+			for (long n=eanim->lastframe+1;n<=fr;n++)
+				ARX_SOUND_PlayAnim(eanim->cur_anim->anims[eanim->altidx_cur]->frames[n].sample,
+				                   io ? &io->pos : NULL);
+		}
+		else
+		{
+			ARX_SOUND_PlayAnim(eanim->cur_anim->anims[eanim->altidx_cur]->frames[fr].sample,
+			                   io ? &io->pos : NULL);
+		}
+	}
 
-			// Frame Flags Management
-			if(!(eanim->flags & EA_ANIMEND) && time
-			   && (eanim->cur_anim->anims[eanim->altidx_cur]->frames[fr].flag > 0)
-			   && (eanim->lastframe != fr)) {
-				
-				if (io!=entities.player())
+	// Frame Flags Management
+	if(!(eanim->flags & EA_ANIMEND) && time
+	   && (eanim->cur_anim->anims[eanim->altidx_cur]->frames[fr].flag > 0)
+	   && (eanim->lastframe != fr)) {
+		
+		if (io!=entities.player())
+		{
+			if ((eanim->lastframe<fr) && (eanim->lastframe!=-1))
+			{
+				for (long n=eanim->lastframe+1;n<=fr;n++)
 				{
-					if ((eanim->lastframe<fr) && (eanim->lastframe!=-1))
-					{
-						for (long n=eanim->lastframe+1;n<=fr;n++)
-						{
-							if (eanim->cur_anim->anims[eanim->altidx_cur]->frames[n].flag==9)
-								ARX_NPC_NeedStepSound(io, &io->pos);
-						}
-					}
-					else if (eanim->cur_anim->anims[eanim->altidx_cur]->frames[fr].flag == 9)
+					if (eanim->cur_anim->anims[eanim->altidx_cur]->frames[n].flag==9)
 						ARX_NPC_NeedStepSound(io, &io->pos);
 				}
 			}
-			
-			// Memorize this frame as lastframe.
-			eanim->lastframe=fr;
-			eanim->fr=fr;
-			eanim->pour=pour;
-			break;
+			else if (eanim->cur_anim->anims[eanim->altidx_cur]->frames[fr].flag == 9)
+				ARX_NPC_NeedStepSound(io, &io->pos);
 		}
 	}
+	
+	// Memorize this frame as lastframe.
+	eanim->lastframe=fr;
+	eanim->fr=fr;
+	eanim->pour=pour;
 }
+
 Entity * DESTROYED_DURING_RENDERING=NULL;
 
 void EERIEDrawAnimQuat(EERIE_3DOBJ * eobj,
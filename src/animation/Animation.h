@@ -55,6 +55,8 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 class TextureContainer;
 class Entity;
 struct EERIE_3DOBJ;
+struct EERIE_ANIM;
+struct EERIE_GROUP;
 struct EERIE_LIGHT;
 struct ANIM_USE;
 struct EERIEMATRIX;
@@ -87,6 +89,12 @@ TexturedVertex * PushVertexInTableCull_TMultiplicative(TextureContainer * tex);
 void CalculateInterZMapp(EERIE_3DOBJ * _pobj3dObj, long lIdList, long * _piInd, TextureContainer * _pTex, TexturedVertex * _pVertex);
 void EERIE_ANIMMANAGER_ReloadAll();
 
+/*!
+ * Get the group transforms of an animation interpolated between key frames fr and fr + 1.
+ * The returned array holds nb_groups entries and is only valid until the next call.
+ */
+const EERIE_GROUP * GetAnimationPose(const EERIE_ANIM * eanim, long fr, float pour);
+
 void EERIEDrawAnimQuat(EERIE_3DOBJ * eobj, ANIM_USE * eanim, Anglef * angle, Vec3f  * pos, unsigned long time, Entity * io, bool render = true, bool update_movement = true);
 
 void DrawEERIEInterMatrix(EERIE_3DOBJ * eobj, EERIEMATRIX * mat, Vec3f  * pos, Entity * io, EERIE_MOD_INFO * modinfo = NULL);
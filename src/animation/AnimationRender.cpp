@@ -49,6 +49,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #include <algorithm>
 
 #include "animation/Animation.h"
+#include "animation/Skinning.h"
 
 #include "core/Application.h"
 #include "core/GameTime.h"
@@ -280,8 +281,7 @@ static	void	Cedric_AnimateObject(Entity * io, EERIE_3DOBJ * eobj, ANIM_USE * ani
 
 	for (long count = MAX_ANIM_LAYERS - 1; count >= 0; count--)
 	{
-		EERIE_QUAT		t, temp;
-		Vec3f		vect;
+		EERIE_QUAT		temp;
 		Vec3f		scale;
 
 		if(!io) {
@@ -317,28 +317,28 @@ static	void	Cedric_AnimateObject(Entity * io, EERIE_3DOBJ * eobj, ANIM_USE * ani
 
 		// Now go for groups rotation/translation/scaling, And transform Linked objects by the way
 		l = min(eobj->nbgroups - 1, eanim->nb_groups - 1);
+		
+		const EERIE_GROUP * pose = NULL;
+		if(eanim->nb_key_frames != 1) {
+			pose = GetAnimationPose(eanim, animuse->fr, animuse->pour);
+		}
 
 		for (j = l; j >= 0; j--)
 		{
 			if (grps[j])
 				continue;
 
-			EERIE_GROUP * sGroup = &eanim->groups[j+(animuse->fr*eanim->nb_groups)];
-			EERIE_GROUP * eGroup = &eanim->groups[j+(animuse->fr*eanim->nb_groups)+eanim->nb_groups];
-
 			if (!eanim->voidgroups[j])
 				grps[j] = 1;
 
-			if (eanim->nb_key_frames != 1)
+			if (pose)
 			{
-				Quat_Slerp(&t, &sGroup->quat, &eGroup->quat, animuse->pour);
 				Quat_Copy(&temp, &obj->bones[j].quatinit);
-				Quat_Multiply(&obj->bones[j].quatinit, &temp, &t);
+				Quat_Multiply(&obj->bones[j].quatinit, &temp, &pose[j].quat);
 
-				vect = sGroup->translate + (eGroup->translate - sGroup->translate) * animuse->pour;
-				obj->bones[j].transinit = vect + obj->bones[j].transinit_global;
+				obj->bones[j].transinit = pose[j].translate + obj->bones[j].transinit_global;
 
-				scale = sGroup->zoom + (eGroup->zoom - sGroup->zoom) * animuse->pour;
+				scale = pose[j].zoom;
 				if(BH_MODE && j == eobj->fastaccess.head_group) {
 					scale += Vec3f::ONE;
 				}
@@ -426,39 +426,11 @@ void EE_P2(TexturedVertex * in, TexturedVertex * out);
 /* Transform object vertices  */
 int Cedric_TransformVerts(Entity * io, EERIE_3DOBJ * eobj, EERIE_C_DATA * obj,
                           Vec3f * pos) {
-	int v;
-
-	EERIE_3DPAD * inVert;
 	EERIE_VERTEX * outVert;
 
- 	/* Transform & project all vertices */
-	for (long i = 0; i != obj->nb_bones; i++)
-	{
-		EERIEMATRIX	 matrix;
-
-		MatrixFromQuat(&matrix, &obj->bones[i].quatanim);
-		Vec3f vector = obj->bones[i].transanim;
-		
-		// Apply Scale
-		matrix._11 *= obj->bones[i].scaleanim.x;
-		matrix._12 *= obj->bones[i].scaleanim.x;
-		matrix._13 *= obj->bones[i].scaleanim.x;
-		
-		matrix._21 *= obj->bones[i].scaleanim.y;
-		matrix._22 *= obj->bones[i].scaleanim.y;
-		matrix._23 *= obj->bones[i].scaleanim.y;
-		
-		matrix._31 *= obj->bones[i].scaleanim.z;
-		matrix._32 *= obj->bones[i].scaleanim.z;
-		matrix._33 *= obj->bones[i].scaleanim.z;
-		
-		for(v = 0; v != obj->bones[i].nb_idxvertices; v++) {
-			inVert  = &eobj->vertexlocal[obj->bones[i].idxvertices[v]];
-			outVert = &eobj->vertexlist3[obj->bones[i].idxvertices[v]];
-			TransformVertexMatrix(&matrix, inVert, &outVert->v);
-			outVert->v += vector;
-			outVert->vert.p = outVert->v;
-		}
+	/* Transform all vertices */
+	if(!eobj->vertexlist3.empty()) {
+		eobj->skin->transform(obj, &eobj->vertexlist3[0]);
 	}
 
 	if(eobj->cdata && eobj->sdata) {
@@ -2395,7 +2367,13 @@ void ApplyDynLight(EERIEPOLY * ep)
 	if (ep->type & POLY_QUAD) nbvert = 4;
 	else nbvert = 3;
 
-	if (TOTPDL == 0)
+	// Only the lights binned to the polygon's tile can reach it. Polygons outside the
+	// binned tiles, such as the ones GetColorz() uses for entities, check all lights.
+	TILE_LIGHTS * tls = GetTileLights(ep->center);
+	EERIE_LIGHT ** lights = tls ? tls->el : PDL;
+	long nlights = tls ? tls->num : TOTPDL;
+
+	if (TOTPDL == 0 || nlights == 0)
 	{
 		for (i = 0; i < nbvert; i++)
 			ep->tv[i].color = ep->v[i].color;
@@ -2418,9 +2396,9 @@ void ApplyDynLight(EERIEPOLY * ep)
 		epb[i] = (float)(c & 255);
 	}
 
-	for (i = 0; i < TOTPDL; i++)
+	for (i = 0; i < nlights; i++)
 	{
-		EERIE_LIGHT * el = PDL[i];
+		EERIE_LIGHT * el = lights[i];
 
 		if (el->fallend + 35.f < 0)
 		{
@@ -2505,7 +2483,9 @@ void ApplyDynLight_VertexBuffer(EERIEPOLY * ep, SMY_VERTEX * _pVertex, unsigned
 	if (ep->type & POLY_QUAD) nbvert = 4;
 	else nbvert = 3;
 
-	if (TOTPDL == 0)
+	TILE_LIGHTS * tls = GetTileLights(ep->center);
+
+	if (TOTPDL == 0 || !tls || tls->num == 0)
 	{
 
 		ep->tv[0].color = _pVertex[_usInd0].color = ep->v[0].color;
@@ -2533,9 +2513,9 @@ void ApplyDynLight_VertexBuffer(EERIEPOLY * ep, SMY_VERTEX * _pVertex, unsigned
 		epb[i] = (float)(long)(c & 255);
 	}
 
-	for (i = 0; i < TOTPDL; i++)
+	for (i = 0; i < tls->num; i++)
 	{
-		EERIE_LIGHT * el = PDL[i];
+		EERIE_LIGHT * el = tls->el[i];
 
 		for (j = 0; j < nbvert; j++)
 		{
@@ -0,0 +1,217 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "animation/Skinning.h"
+
+#include <algorithm>
+#include <map>
+
+#include <boost/crc.hpp>
+
+#include "graphics/GraphicsTypes.h"
+#include "graphics/Math.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ARX_SKINNING_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+typedef std::multimap<u32, SkinData *> SkinRegistry;
+SkinRegistry skins;
+
+template <class T>
+void hashVector(boost::crc_32_type & crc, const std::vector<T> & data) {
+	if(!data.empty()) {
+		crc.process_bytes(&data[0], data.size() * sizeof(T));
+	}
+}
+
+} // anonymous namespace
+
+SkinData * SkinData::acquire(const EERIE_3DOBJ * eobj) {
+	
+	const EERIE_C_DATA * obj = eobj->c_data;
+	arx_assert(obj && eobj->vertexlocal);
+	
+	SkinData * skin = new SkinData;
+	
+	skin->bones.resize(obj->nb_bones);
+	for(long i = 0; i < obj->nb_bones; i++) {
+		
+		Bone & bone = skin->bones[i];
+		bone.begin = skin->x.size();
+		bone.count = obj->bones[i].nb_idxvertices;
+		
+		// Pad each bone to a multiple of four so that vertices can always be
+		// loaded in groups of four.
+		size_t padded = (bone.count + 3) & ~size_t(3);
+		skin->x.resize(bone.begin + padded, 0.f);
+		skin->y.resize(bone.begin + padded, 0.f);
+		skin->z.resize(bone.begin + padded, 0.f);
+		skin->indices.resize(bone.begin + padded, 0);
+		
+		for(size_t v = 0; v < bone.count; v++) {
+			long idx = obj->bones[i].idxvertices[v];
+			const EERIE_3DPAD & in = eobj->vertexlocal[idx];
+			skin->x[bone.begin + v] = in.x;
+			skin->y[bone.begin + v] = in.y;
+			skin->z[bone.begin + v] = in.z;
+			skin->indices[bone.begin + v] = u32(idx);
+		}
+	}
+	
+	boost::crc_32_type crc;
+	hashVector(crc, skin->x);
+	hashVector(crc, skin->y);
+	hashVector(crc, skin->z);
+	hashVector(crc, skin->indices);
+	for(size_t i = 0; i < skin->bones.size(); i++) {
+		crc.process_bytes(&skin->bones[i].count, sizeof(skin->bones[i].count));
+	}
+	skin->hash = crc.checksum();
+	
+	std::pair<SkinRegistry::iterator, SkinRegistry::iterator> range;
+	range = skins.equal_range(skin->hash);
+	for(SkinRegistry::iterator it = range.first; it != range.second; ++it) {
+		if(it->second->equals(*skin)) {
+			delete skin;
+			it->second->refcount++;
+			return it->second;
+		}
+	}
+	
+	skins.insert(std::make_pair(skin->hash, skin));
+	
+	return skin;
+}
+
+void SkinData::release() {
+	
+	arx_assert(refcount > 0);
+	
+	if(--refcount > 0) {
+		return;
+	}
+	
+	std::pair<SkinRegistry::iterator, SkinRegistry::iterator> range;
+	range = skins.equal_range(hash);
+	for(SkinRegistry::iterator it = range.first; it != range.second; ++it) {
+		if(it->second == this) {
+			skins.erase(it);
+			break;
+		}
+	}
+	
+	delete this;
+}
+
+bool SkinData::equals(const SkinData & other) const {
+	
+	if(bones.size() != other.bones.size()) {
+		return false;
+	}
+	for(size_t i = 0; i < bones.size(); i++) {
+		if(bones[i].count != other.bones[i].count) {
+			return false;
+		}
+	}
+	
+	return x == other.x && y == other.y && z == other.z && indices == other.indices;
+}
+
+void SkinData::transform(const EERIE_C_DATA * obj, EERIE_VERTEX * vertices) const {
+	
+	arx_assert(size_t(obj->nb_bones) == bones.size());
+	
+	for(size_t i = 0; i < bones.size(); i++) {
+		
+		const Bone & bone = bones[i];
+		if(bone.count == 0) {
+			continue;
+		}
+		
+		const EERIE_BONE & src = obj->bones[i];
+		
+		EERIEMATRIX m;
+		MatrixFromQuat(&m, &src.quatanim);
+		
+		// Apply Scale
+		m._11 *= src.scaleanim.x, m._12 *= src.scaleanim.x, m._13 *= src.scaleanim.x;
+		m._21 *= src.scaleanim.y, m._22 *= src.scaleanim.y, m._23 *= src.scaleanim.y;
+		m._31 *= src.scaleanim.z, m._32 *= src.scaleanim.z, m._33 *= src.scaleanim.z;
+		
+		const Vec3f & t = src.transanim;
+		
+		const float * px = &x[0] + bone.begin;
+		const float * py = &y[0] + bone.begin;
+		const float * pz = &z[0] + bone.begin;
+		const u32 * idx = &indices[0] + bone.begin;
+		
+#ifdef ARX_SKINNING_SSE2
+		
+		const __m128 m11 = _mm_set1_ps(m._11), m12 = _mm_set1_ps(m._12), m13 = _mm_set1_ps(m._13);
+		const __m128 m21 = _mm_set1_ps(m._21), m22 = _mm_set1_ps(m._22), m23 = _mm_set1_ps(m._23);
+		const __m128 m31 = _mm_set1_ps(m._31), m32 = _mm_set1_ps(m._32), m33 = _mm_set1_ps(m._33);
+		const __m128 tx = _mm_set1_ps(t.x), ty = _mm_set1_ps(t.y), tz = _mm_set1_ps(t.z);
+		
+		for(size_t v = 0; v < bone.count; v += 4) {
+			
+			__m128 vx = _mm_loadu_ps(px + v);
+			__m128 vy = _mm_loadu_ps(py + v);
+			__m128 vz = _mm_loadu_ps(pz + v);
+			
+			// Same operation order as TransformVertexMatrix() so that the
+			// results match the scalar code exactly.
+			__m128 ox = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, m11), _mm_mul_ps(vy, m21)),
+			                       _mm_mul_ps(vz, m31));
+			__m128 oy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, m12), _mm_mul_ps(vy, m22)),
+			                       _mm_mul_ps(vz, m32));
+			__m128 oz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, m13), _mm_mul_ps(vy, m23)),
+			                       _mm_mul_ps(vz, m33));
+			
+			float rx[4], ry[4], rz[4];
+			_mm_storeu_ps(rx, _mm_add_ps(ox, tx));
+			_mm_storeu_ps(ry, _mm_add_ps(oy, ty));
+			_mm_storeu_ps(rz, _mm_add_ps(oz, tz));
+			
+			size_t n = std::min(bone.count - v, size_t(4));
+			for(size_t k = 0; k < n; k++) {
+				EERIE_VERTEX & out = vertices[idx[v + k]];
+				out.v = Vec3f(rx[k], ry[k], rz[k]);
+				out.vert.p = out.v;
+			}
+		}
+		
+#else
+		
+		for(size_t v = 0; v < bone.count; v++) {
+			EERIE_VERTEX & out = vertices[idx[v]];
+			out.v.x = px[v] * m._11 + py[v] * m._21 + pz[v] * m._31 + t.x;
+			out.v.y = px[v] * m._12 + py[v] * m._22 + pz[v] * m._32 + t.y;
+			out.v.z = px[v] * m._13 + py[v] * m._23 + pz[v] * m._33 + t.z;
+			out.vert.p = out.v;
+		}
+		
+#endif
+		
+	}
+}
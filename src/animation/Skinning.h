@@ -0,0 +1,79 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ARX_ANIMATION_SKINNING_H
+#define ARX_ANIMATION_SKINNING_H
+
+#include <stddef.h>
+#include <vector>
+
+#include "platform/Platform.h"
+
+struct EERIE_3DOBJ;
+struct EERIE_C_DATA;
+struct EERIE_VERTEX;
+
+/*!
+ * Bind-pose vertex positions of an object with cedric data, grouped by bone
+ * and stored as separate x, y and z arrays so that they can be transformed
+ * four vertices at a time.
+ *
+ * Objects with identical bind poses (all instances of a model) share one
+ * SkinData instance.
+ */
+class SkinData {
+	
+public:
+	
+	/*!
+	 * Get the skin data for the bind pose in eobj->vertexlocal.
+	 * Each call must be matched by a call to release().
+	 */
+	static SkinData * acquire(const EERIE_3DOBJ * eobj);
+	
+	void release();
+	
+	/*!
+	 * Transform the bind pose by the current bone transforms.
+	 * Writes the v and vert.p members of the output vertices.
+	 */
+	void transform(const EERIE_C_DATA * obj, EERIE_VERTEX * vertices) const;
+	
+private:
+	
+	struct Bone {
+		size_t begin; //!< Index of the first vertex, a multiple of four.
+		size_t count; //!< Number of vertices, not including padding.
+	};
+	
+	SkinData() : hash(0), refcount(1) { }
+	
+	bool equals(const SkinData & other) const;
+	
+	std::vector<Bone> bones;
+	std::vector<float> x, y, z;
+	std::vector<u32> indices; //!< Output vertex for each input vertex.
+	
+	u32 hash;
+	size_t refcount;
+	
+};
+
+#endif // ARX_ANIMATION_SKINNING_H
@@ -309,6 +309,7 @@ void Ambiance::Track::keyPlay() {
 		Channel channel;
 		
 		channel.mixer = ambiance->channel.mixer;
+		channel.priority = PRIORITY_HIGH;
 		channel.flags = FLAG_VOLUME | FLAG_PITCH | FLAG_RELATIVE;
 		channel.flags |= ambiance->channel.flags;
 		channel.volume = key_i->volume.cur;
@@ -864,4 +865,23 @@ aalError Ambiance::update() {
 	return AAL_OK;
 }
 
+size_t Ambiance::getUpdateDeadline() const {
+	
+	size_t deadline = (size_t)-1;
+	
+	if(!isPlaying()) {
+		return deadline;
+	}
+	
+	TrackList::const_iterator track = tracks.begin();
+	for(; track != tracks.end(); ++track) {
+		if(!(track->flags & Track::MUTED) && track->key_i != track->keys.end()
+		   && track->key_i->n_start != KEY_CONTINUE) {
+			deadline = std::min(deadline, track->key_i->n_start);
+		}
+	}
+	
+	return deadline;
+}
+
 } // namespace audio
@@ -83,6 +83,13 @@ public:
 	aalError resume();
 	aalError update();
 	
+	/*!
+	 * Get the time in ms after which update() needs to be called again to start
+	 * the next delayed track key on time.
+	 * @return the time or (size_t)-1 if no track key is waiting to be started.
+	 */
+	size_t getUpdateDeadline() const;
+	
 	aalError muteTrack(const std::string & track, bool mute);
 	
 	struct Track;
@@ -43,6 +43,8 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 
 #include "audio/Audio.h"
 
+#include <algorithm>
+
 #include "Configure.h"
 
 #include "audio/AudioResource.h"
@@ -70,8 +72,19 @@ using std::string;
 namespace audio {
 
 namespace {
+
 static Lock * mutex = NULL;
-}
+
+//! Signaled when sounds are started or stopped so that waitForUpdate() returns early
+static Event * wakeup = NULL;
+
+//! Time in ms after the last update() when the next update is needed
+static size_t update_deadline = 0;
+
+//! Minimum time between updates, even if sources report an earlier deadline
+static const size_t MIN_UPDATE_INTERVAL = 5;
+
+} // anonymous namespace
 
 aalError init(const string & backendName, bool enableEAX) {
 	
@@ -133,6 +146,7 @@ aalError init(const string & backendName, bool enableEAX) {
 	}
 	
 	mutex = new Lock();
+	wakeup = new Event();
 	
 	session_time = Time::getMs();
 	
@@ -159,6 +173,7 @@ aalError clean() {
 	environment_path.clear();
 	
 	delete mutex, mutex = NULL;
+	delete wakeup, wakeup = NULL;
 	
 	return AAL_OK;
 }
@@ -224,12 +239,17 @@ aalError update() {
 	
 	session_time = Time::getMs();
 	
+	size_t deadline = (size_t)-1;
+	
 	// Update sources
 	for(Backend::source_iterator p = backend->sourcesBegin(); p != backend->sourcesEnd();) {
 		Source * source = *p;
 		if(source && (source->update(), source->isIdle())) {
 			p = backend->deleteSource(p);
 		} else {
+			if(source) {
+				deadline = std::min(deadline, source->getUpdateDeadline());
+			}
 			++p;
 		}
 	}
@@ -241,10 +261,14 @@ aalError update() {
 			ambiance->update();
 			if(ambiance->getChannel().flags & FLAG_AUTOFREE && ambiance->isIdle()) {
 				_amb.remove(i);
+			} else {
+				deadline = std::min(deadline, ambiance->getUpdateDeadline());
 			}
 		}
 	}
 	
+	update_deadline = deadline;
+	
 	// Update samples
 	for(size_t i = 0; i < _sample.size(); i++) {
 		Sample * sample = _sample[i];
@@ -256,6 +280,19 @@ aalError update() {
 	return backend->updateDeferred();
 }
 
+aalError waitForUpdate(size_t max_wait) {
+	
+	size_t wait;
+	{
+		AAL_ENTRY
+		wait = std::min(std::max(update_deadline, MIN_UPDATE_INTERVAL), max_wait);
+	}
+	
+	wakeup->wait(wait);
+	
+	return AAL_OK;
+}
+
 // Resource creation
 
 MixerId createMixer() {
@@ -621,6 +658,8 @@ aalError samplePlay(SampleId & sample_id, const Channel & channel, unsigned play
 	
 	AAL_ENTRY
 	
+	wakeup->signal();
+	
 	SampleId s_id = Backend::getSampleId(sample_id);
 	sample_id = Backend::clearSource(sample_id);
 	if(!_sample.isValid(s_id) || !_mixer.isValid(channel.mixer)) {
@@ -678,6 +717,8 @@ aalError sampleStop(SourceId & sample_id) {
 	
 	AAL_ENTRY
 	
+	wakeup->signal();
+	
 	Source * source = backend->getSource(sample_id);
 	if(!source) {
 		return AAL_ERROR_HANDLE;
@@ -801,6 +842,8 @@ aalError ambiancePlay(AmbianceId a_id, const Channel & channel, bool loop, size_
 	
 	AAL_ENTRY
 	
+	wakeup->signal();
+	
 	if(!_amb.isValid(a_id) || !_mixer.isValid(channel.mixer)) {
 		return AAL_ERROR_HANDLE;
 	}
@@ -814,6 +857,8 @@ aalError ambianceStop(AmbianceId a_id, size_t fade_interval) {
 	
 	AAL_ENTRY
 	
+	wakeup->signal();
+	
 	if(!_amb.isValid(a_id)) {
 		return AAL_ERROR_HANDLE;
 	}
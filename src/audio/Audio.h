@@ -75,6 +75,13 @@ aalError setEnvironmentPath(const res::path & path);
 aalError setReverbEnabled(bool enable);
 aalError update();
 
+/*!
+ * Wait until update() needs to be called again: when a source is about to run out of
+ * queued data, when the next ambiance key is due or when sounds are started or stopped.
+ * @param max_wait The maximum time to wait in milliseconds.
+ */
+aalError waitForUpdate(size_t max_wait);
+
 // Resource
 
 MixerId createMixer();
@@ -64,6 +64,24 @@ aalError Source::update() {
 	return ret;
 }
 
+size_t Source::getUpdateDeadline() const {
+	
+	if(status != Playing) {
+		return (size_t)-1;
+	}
+	
+	size_t bytes = getBufferedBytes();
+	if(callback_i != callbacks.size() && callbacks[callback_i].second >= time) {
+		bytes = std::min(bytes, callbacks[callback_i].second - time);
+	}
+	
+	if(bytes == (size_t)-1) {
+		return bytes;
+	}
+	
+	return bytesToUnits(bytes, sample->getFormat(), UNIT_MS);
+}
+
 void Source::updateCallbacks() {
 	
 	while(true) {
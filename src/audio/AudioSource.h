@@ -102,6 +102,13 @@ public:
 	virtual aalError resume() = 0;
 	aalError update();
 	
+	/*!
+	 * Get the time in ms after which update() needs to be called again so that the
+	 * source does not run out of queued data and callbacks are not delayed.
+	 * @return the time or (size_t)-1 if the source does not need to be updated.
+	 */
+	size_t getUpdateDeadline() const;
+	
 	inline SourceId getId() const { return id; }
 	inline Sample * getSample() const { return sample; }
 	inline const Channel & getChannel() const { return channel; }
@@ -140,6 +147,12 @@ protected:
 	
 	virtual aalError updateBuffers() = 0;
 	
+	/*!
+	 * @return the number of bytes that can still be played before updateBuffers() needs
+	 *         to queue more data, or (size_t)-1 if there is no such limit.
+	 */
+	virtual size_t getBufferedBytes() const { return (size_t)-1; }
+	
 private:
 	
 	typedef std::vector<std::pair<Callback*, size_t> > CallbackList;
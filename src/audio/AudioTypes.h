@@ -131,9 +131,18 @@ typedef s32 MixerId;
 typedef s32 EnvId;
 typedef s32 AmbianceId;
 
+// Voice priorities - sources with a higher priority are the last to lose their voice
+enum Priority {
+	PRIORITY_LOW = -1, // Effects that are not missed if they are dropped
+	PRIORITY_NORMAL = 0,
+	PRIORITY_HIGH = 1 // Speech, interface and ambiance sounds
+};
+
 // Play channel initialization parameters
 struct Channel {
+	Channel() : flags(0), priority(PRIORITY_NORMAL) { }
 	ChannelFlags flags;
+	Priority priority;
 	MixerId mixer;
 	float volume;
 	float pitch;
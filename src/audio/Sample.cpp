@@ -44,6 +44,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #include "audio/Sample.h"
 
 #include "audio/AudioGlobal.h"
+#include "audio/SampleCache.h"
 #include "audio/Stream.h"
 #include "audio/AudioBackend.h"
 #include "audio/AudioSource.h"
@@ -64,6 +65,7 @@ Sample::~Sample() {
 		}
 	}
 	
+	releaseSampleData(this);
 }
 
 aalError Sample::load() {
@@ -79,6 +81,7 @@ aalError Sample::load() {
 	
 	stream->getFormat(format);
 	length = stream->getLength();
+	preloadSample(this, stream);
 	deleteStream(stream);
 	
 	return AAL_OK;
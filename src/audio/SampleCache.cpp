@@ -0,0 +1,205 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "audio/SampleCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+#include "audio/AudioGlobal.h"
+#include "audio/Sample.h"
+#include "audio/Stream.h"
+
+#include "platform/Platform.h"
+
+namespace audio {
+
+namespace {
+
+//! Maximum amount of decoded sample data to keep in memory
+const size_t SAMPLE_CACHE_SIZE = 32 * 1024 * 1024;
+
+typedef std::list<const Sample *> SampleList;
+
+struct CachedSample {
+	
+	std::vector<char> data;
+	
+	size_t users; //!< Number of streams currently reading the data
+	
+	SampleList::iterator lru;
+	
+};
+
+typedef boost::unordered_map<const Sample *, CachedSample> SampleCache;
+
+SampleCache cache;
+SampleList lru; //!< Cached samples, most recently used first
+size_t cacheSize = 0;
+
+class StreamMemory : public Stream {
+	
+public:
+	
+	StreamMemory(CachedSample & cached, const PCMFormat & _format)
+		: sample(cached), format(_format), cursor(0) {
+		sample.users++;
+	}
+	
+	~StreamMemory() {
+		sample.users--;
+	}
+	
+	aalError setStream(PakFileHandle * stream) {
+		ARX_UNUSED(stream);
+		return AAL_ERROR_SYSTEM;
+	}
+	
+	aalError setPosition(size_t position) {
+		if(position >= sample.data.size()) {
+			return AAL_ERROR_FILEIO;
+		}
+		cursor = position;
+		return AAL_OK;
+	}
+	
+	PakFileHandle * getStream() { return NULL; }
+	
+	aalError getFormat(PCMFormat & _format) {
+		_format = format;
+		return AAL_OK;
+	}
+	
+	size_t getLength() { return sample.data.size(); }
+	size_t getPosition() { return cursor; }
+	
+	aalError read(void * buffer, size_t to_read, size_t & read) {
+		read = std::min(to_read, sample.data.size() - cursor);
+		if(read) {
+			memcpy(buffer, &sample.data[cursor], read);
+			cursor += read;
+		}
+		return AAL_OK;
+	}
+	
+private:
+	
+	CachedSample & sample;
+	PCMFormat format;
+	size_t cursor;
+	
+};
+
+bool isCacheable(const Sample * sample) {
+	return sample->getLength() != 0 && sample->getLength() <= stream_limit_bytes;
+}
+
+//! Drop the least recently used samples until size more bytes fit into the cache
+void makeRoom(size_t size) {
+	
+	SampleList::iterator it = lru.end();
+	while(cacheSize + size > SAMPLE_CACHE_SIZE && it != lru.begin()) {
+		
+		--it;
+		
+		SampleCache::iterator entry = cache.find(*it);
+		if(entry->second.users) {
+			continue;
+		}
+		
+		cacheSize -= entry->second.data.size();
+		cache.erase(entry);
+		it = lru.erase(it);
+	}
+}
+
+CachedSample * addSample(const Sample * sample, Stream * stream) {
+	
+	std::vector<char> data(sample->getLength());
+	size_t read;
+	if(stream->read(&data[0], data.size(), read) || read != data.size()) {
+		return NULL;
+	}
+	
+	CachedSample & entry = cache[sample];
+	entry.data.swap(data);
+	entry.users = 0;
+	entry.lru = lru.insert(lru.begin(), sample);
+	cacheSize += entry.data.size();
+	
+	return &entry;
+}
+
+} // anonymous namespace
+
+Stream * createSampleStream(const Sample * sample) {
+	
+	SampleCache::iterator it = cache.find(sample);
+	if(it != cache.end()) {
+		lru.splice(lru.begin(), lru, it->second.lru);
+		return new StreamMemory(it->second, sample->getFormat());
+	}
+	
+	Stream * stream = createStream(sample->getName());
+	if(!stream || !isCacheable(sample)) {
+		return stream;
+	}
+	
+	makeRoom(sample->getLength());
+	
+	CachedSample * entry = addSample(sample, stream);
+	deleteStream(stream);
+	if(!entry) {
+		// Let the caller see the same error as when reading the file directly
+		return createStream(sample->getName());
+	}
+	
+	return new StreamMemory(*entry, sample->getFormat());
+}
+
+void preloadSample(const Sample * sample, Stream * stream) {
+	
+	if(!isCacheable(sample) || cacheSize + sample->getLength() > SAMPLE_CACHE_SIZE
+	   || cache.find(sample) != cache.end()) {
+		return;
+	}
+	
+	addSample(sample, stream);
+}
+
+void releaseSampleData(const Sample * sample) {
+	
+	SampleCache::iterator it = cache.find(sample);
+	if(it == cache.end()) {
+		return;
+	}
+	
+	arx_assert(!it->second.users);
+	
+	cacheSize -= it->second.data.size();
+	lru.erase(it->second.lru);
+	cache.erase(it);
+}
+
+} // namespace audio
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ARX_AUDIO_SAMPLECACHE_H
+#define ARX_AUDIO_SAMPLECACHE_H
+
+namespace audio {
+
+class Sample;
+class Stream;
+
+/*!
+ * Create a stream for the decoded data of a sample.
+ *
+ * Samples no larger than the stream limit are decoded once and then kept in
+ * memory, so that creating new sources for them does not need to read or
+ * decode the file again. When the cache is full the decoded data of the least
+ * recently used samples is dropped first.
+ *
+ * The stream must be released using deleteStream().
+ */
+Stream * createSampleStream(const Sample * sample);
+
+/*!
+ * Decode a sample into the cache ahead of time using an already opened stream
+ * positioned at the start of the sample. Does nothing if the sample is too large
+ * or if it would only fit by dropping other samples.
+ */
+void preloadSample(const Sample * sample, Stream * stream);
+
+//! Drop the decoded data of a sample
+void releaseSampleData(const Sample * sample);
+
+} // namespace audio
+
+#endif // ARX_AUDIO_SAMPLECACHE_H
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "audio/VoicePool.h"
+
+#include <algorithm>
+
+#include "platform/Platform.h"
+
+namespace audio {
+
+namespace {
+
+//! Voices quieter than this (-60 dB) are considered inaudible.
+const float MIN_AUDIBILITY = 0.001f;
+
+struct RankedVoice {
+	
+	VoicePool::Voice * voice;
+	int priority;
+	float audibility;
+	
+	RankedVoice(VoicePool::Voice * _voice)
+		: voice(_voice), priority(_voice->getPriority()), audibility(_voice->getAudibility()) { }
+	
+	bool operator<(const RankedVoice & o) const {
+		if(priority != o.priority) {
+			return priority > o.priority;
+		}
+		return audibility > o.audibility;
+	}
+	
+};
+
+} // anonymous namespace
+
+VoicePool::VoicePool(size_t _maxVoices) : maxVoices(_maxVoices), activeCount(0) { }
+
+bool VoicePool::activate(Voice * voice) {
+	
+	arx_assert(!voice->active && activeCount < maxVoices);
+	
+	if(!voice->activate()) {
+		return false;
+	}
+	
+	voice->active = true;
+	activeCount++;
+	return true;
+}
+
+void VoicePool::deactivate(Voice * voice) {
+	
+	arx_assert(voice->active && activeCount > 0);
+	
+	voice->deactivate();
+	voice->active = false;
+	activeCount--;
+}
+
+void VoicePool::add(Voice * voice) {
+	
+	arx_assert(std::find(voices.begin(), voices.end(), voice) == voices.end());
+	
+	voices.push_back(voice);
+	
+	RankedVoice added(voice);
+	if(added.audibility < MIN_AUDIBILITY) {
+		return;
+	}
+	
+	if(activeCount < maxVoices) {
+		activate(voice);
+		return;
+	}
+	
+	// Steal the hardware voice of the least important active voice.
+	Voice * victim = NULL;
+	RankedVoice worst = added;
+	for(std::vector<Voice *>::const_iterator i = voices.begin(); i != voices.end(); ++i) {
+		if((*i)->active) {
+			RankedVoice ranked(*i);
+			if(worst < ranked) {
+				victim = *i, worst = ranked;
+			}
+		}
+	}
+	
+	if(victim) {
+		deactivate(victim);
+		activate(voice);
+	}
+}
+
+void VoicePool::remove(Voice * voice) {
+	
+	std::vector<Voice *>::iterator i = std::find(voices.begin(), voices.end(), voice);
+	if(i == voices.end()) {
+		return;
+	}
+	
+	*i = voices.back();
+	voices.pop_back();
+	
+	if(voice->active) {
+		deactivate(voice);
+	}
+}
+
+void VoicePool::update() {
+	
+	if(voices.size() <= maxVoices) {
+		// Enough hardware voices for everyone - only inaudible voices are left virtual.
+		for(std::vector<Voice *>::const_iterator i = voices.begin(); i != voices.end(); ++i) {
+			bool audible = ((*i)->getAudibility() >= MIN_AUDIBILITY);
+			if((*i)->active && !audible) {
+				deactivate(*i);
+			} else if(!(*i)->active && audible) {
+				activate(*i);
+			}
+		}
+		return;
+	}
+	
+	std::vector<RankedVoice> ranked(voices.begin(), voices.end());
+	std::sort(ranked.begin(), ranked.end());
+	
+	size_t count = 0;
+	while(count < maxVoices && ranked[count].audibility >= MIN_AUDIBILITY) {
+		count++;
+	}
+	
+	// Free hardware voices first so that they can be given to the more important voices.
+	for(size_t i = count; i < ranked.size(); i++) {
+		if(ranked[i].voice->active) {
+			deactivate(ranked[i].voice);
+		}
+	}
+	
+	for(size_t i = 0; i < count; i++) {
+		if(!ranked[i].voice->active) {
+			activate(ranked[i].voice);
+		}
+	}
+}
+
+} // namespace audio
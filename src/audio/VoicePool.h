@@ -0,0 +1,111 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ARX_AUDIO_VOICEPOOL_H
+#define ARX_AUDIO_VOICEPOOL_H
+
+#include <stddef.h>
+#include <vector>
+
+namespace audio {
+
+/*!
+ * Distributes a limited number of hardware voices between playing sources.
+ *
+ * Sources that don't get a voice become virtual: they keep track of their play
+ * position and continue from there once they are given a voice again.
+ * Voices go to the sources with the highest priority first and, within the
+ * same priority, to the sources that are the loudest at the listener position.
+ */
+class VoicePool {
+	
+public:
+	
+	class Voice {
+		
+	public:
+		
+		Voice() : active(false) { }
+		virtual ~Voice() { }
+		
+		//! Voices with a higher priority can take hardware voices from lower priority ones.
+		virtual int getPriority() const = 0;
+		
+		/*!
+		 * @return the approximate gain of this voice at the listener position.
+		 *         Voices with a gain of (almost) 0 are never given a hardware voice.
+		 */
+		virtual float getAudibility() const = 0;
+		
+		//! @return true if this voice currently has a hardware voice.
+		inline bool isActive() const { return active; }
+		
+	protected:
+		
+		/*!
+		 * Start using a hardware voice and continue playing from the current position.
+		 * @return false if no hardware voice could be allocated.
+		 */
+		virtual bool activate() = 0;
+		
+		//! Stop using the hardware voice but remember the current position.
+		virtual void deactivate() = 0;
+		
+	private:
+		
+		bool active;
+		
+		friend class VoicePool;
+	};
+	
+	explicit VoicePool(size_t maxVoices);
+	
+	/*!
+	 * Start managing a voice.
+	 * The voice is given a hardware voice immediately if it is audible and there
+	 * is either a free hardware voice or one used by a less important voice.
+	 */
+	void add(Voice * voice);
+	
+	//! Stop managing a voice and free its hardware voice, if any. Unknown voices are ignored.
+	void remove(Voice * voice);
+	
+	//! Re-distribute the hardware voices after priorities or audibility changed.
+	void update();
+	
+	inline size_t getMaxVoices() const { return maxVoices; }
+	inline size_t getActiveCount() const { return activeCount; }
+	inline size_t size() const { return voices.size(); }
+	
+private:
+	
+	bool activate(Voice * voice);
+	void deactivate(Voice * voice);
+	
+	size_t maxVoices;
+	size_t activeCount;
+	
+	std::vector<Voice *> voices;
+	
+};
+
+} // namespace audio
+
+#endif // ARX_AUDIO_VOICEPOOL_H
@@ -44,6 +44,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #include "audio/codec/ADPCM.h"
 
 #include <algorithm>
+#include <cstring>
 
 #include "audio/AudioTypes.h"
 #include "audio/codec/WAVFormat.h"
@@ -59,10 +60,9 @@ static const short gai_p4[] = {
 
 CodecADPCM::CodecADPCM() :
 	stream(NULL), header(NULL), padding(0), shift(0),
-	sample_i(0xffffffff), predictor(NULL), delta(NULL),
+	predictor(NULL), delta(NULL),
 	samp1(NULL), samp2(NULL), coef1(NULL), coef2(NULL),
-	nybble_l(NULL), nybble_c(0), nybble_i(0), nybble(0), odd(false),
-	cache_c(0), cache_i(0), cache_l(NULL), cursor(0) {
+	nybble_l(NULL), nybble_c(0), pcm(NULL), pcm_c(0), pcm_i(0), cursor(0) {
 }
 
 CodecADPCM::~CodecADPCM() {
@@ -72,7 +72,7 @@ CodecADPCM::~CodecADPCM() {
 	delete[] samp2;
 	delete[] coef1;
 	delete[] coef2;
-	delete[] (s8*)cache_l;
+	delete[] pcm;
 	delete[] nybble_l;
 }
 
@@ -88,9 +88,13 @@ aalError CodecADPCM::setHeader(void * _header) {
 		return AAL_ERROR_FORMAT;
 	}
 	
+	// Each block starts with two uncompressed samples per channel
+	if(header->samplesPerBlock < 2) {
+		return AAL_ERROR_FORMAT;
+	}
+	
 	shift = header->wfx.channels - 1;
 	padding = 0;
-	sample_i = 0xffffffff;
 	
 	size_t nb = 1 << shift;
 	
@@ -104,9 +108,9 @@ aalError CodecADPCM::setHeader(void * _header) {
 		return AAL_ERROR_MEMORY;
 	}
 	
-	cache_c = cache_i = (u8)(sizeof(s16) << shift);
-	cache_l = new s8[cache_c];
-	if(!cache_l) {
+	pcm_c = (sizeof(s16) * header->samplesPerBlock) << shift;
+	pcm = new s16[header->samplesPerBlock << shift];
+	if(!pcm) {
 		return AAL_ERROR_MEMORY;
 	}
 	
@@ -126,7 +130,8 @@ aalError CodecADPCM::setHeader(void * _header) {
 		return error;
 	}
 	
-	sample_i++;
+	// The first sample of the first block is skipped
+	pcm_i = sizeof(s16) << shift;
 	
 	return AAL_OK;
 }
@@ -150,8 +155,7 @@ aalError CodecADPCM::setPosition(size_t _position) {
 		return error;
 	}
 	
-	sample_i++;
-	cache_i = 0;
+	pcm_i = 0;
 	
 	while(i) {
 		char buffer[256];
@@ -205,50 +209,53 @@ void CodecADPCM::getSample(size_t i, s8 adpcm_sample) {
 	samp1[i] = (s16)pcm_sample;
 }
 
+void CodecADPCM::decodeBlock() {
+	
+	size_t channels = header->wfx.channels;
+	
+	for(size_t i = 0; i < channels; i++) {
+		pcm[i] = samp2[i];
+		pcm[channels + i] = samp1[i];
+	}
+	
+	// Nybbles are stored high first, interleaved by channel
+	s16 * out = pcm + 2 * channels;
+	const s8 * in = nybble_l;
+	size_t count = (header->samplesPerBlock - 2) << shift;
+	for(size_t n = 0, i = 0; n < count; n++) {
+		if(n & 1) {
+			getSample(i, s8(*in++ & 0x0f));
+		} else {
+			getSample(i, s8((*in >> 4) & 0x0f));
+		}
+		*out++ = samp1[i];
+		i = (i + 1 == channels) ? 0 : i + 1;
+	}
+}
+
 aalError CodecADPCM::read(void * buffer, size_t to_read, size_t & read) {
 	
 	read = 0;
 	while(read < to_read) {
 		
-		// If prefetched bytes are remaining, put the next one into the buffer
-		if(cache_i < cache_c) {
-			((s8 *)buffer)[read++] = ((s8 *)cache_l)[cache_i++];
+		// Copy as many already decoded bytes as possible
+		if(pcm_i < pcm_c) {
+			size_t count = std::min(pcm_c - pcm_i, to_read - read);
+			memcpy((char *)buffer + read, (const char *)pcm + pcm_i, count);
+			read += count, pcm_i += count;
 			continue;
 		}
 		
-		// Load next block header if there is no more sample in current one
-		if(sample_i >= header->samplesPerBlock) {
-			
-			if(padding) {
-				stream->seek(SeekCur, padding);
-			}
-			
-			if(aalError error = getNextBlock()) {
-				return error;
-			}
-			
-		} else if(sample_i == 1) {
-			for(size_t i = 0; i < header->wfx.channels; i++) {
-				((s16 *)cache_l)[i] = samp1[i];
-			}
-		} else {
-			
-			// Get new sample for each channel
-			for(size_t i = 0; i < header->wfx.channels; i++) {
-				if(odd) {
-					getSample(i, (s8)(nybble & 0x0f));
-					odd = false;
-				} else {
-					nybble = nybble_l[nybble_i++];
-					getSample(i, s8((nybble >> 4) & 0x0f));
-					odd = true;
-				}
-				((s16 *)cache_l)[i] = samp1[i];
-			}
+		// Load and decode the next block
+		if(padding) {
+			stream->seek(SeekCur, padding);
 		}
 		
-		sample_i++;
-		cache_i = 0;
+		if(aalError error = getNextBlock()) {
+			return error;
+		}
+		
+		pcm_i = 0;
 	}
 	
 	return AAL_OK;
@@ -273,23 +280,20 @@ aalError CodecADPCM::getNextBlock() {
 		return AAL_ERROR_FILEIO;
 	}
 	
-	odd = false;
-	sample_i = 0;
-	nybble_i = 0;
-	
 	for(size_t i = 0; i < header->wfx.channels; i++) {
 		if(predictor[i] >= header->coefficientCount) {
 			return AAL_ERROR_FORMAT;
 		}
 		coef1[i] = header->coefficients[(size_t)predictor[i]].coef1;
 		coef2[i] = header->coefficients[(size_t)predictor[i]].coef2;
-		((s16 *)cache_l)[i] = samp2[i];
 	}
 	
 	if(!stream->read(nybble_l, nybble_c)) {
 		return AAL_ERROR_FILEIO;
 	}
 	
+	decodeBlock();
+	
 	return AAL_OK;
 }
 
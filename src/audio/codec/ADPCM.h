@@ -75,11 +75,13 @@ private:
 	void getSample(size_t channel_i, s8 nybble);
 	aalError getNextBlock();
 	
+	//! Decode all samples of the current block into the pcm buffer
+	void decodeBlock();
+	
 	PakFileHandle * stream;
 	ADPCMHeader * header;
 	u32 padding;
 	u32 shift;
-	u32 sample_i;
 	char * predictor;
 	s16 * delta;
 	s16 * samp1;
@@ -87,11 +89,9 @@ private:
 	s16 * coef1;
 	s16 * coef2;
 	s8 * nybble_l;
-	u32 nybble_c, nybble_i;
-	s8 nybble;
-	bool odd;
-	u8 cache_c, cache_i;
-	void * cache_l;
+	u32 nybble_c;
+	s16 * pcm; //!< Decoded samples of the current block
+	size_t pcm_c, pcm_i; //!< Size and read position of the pcm buffer in bytes
 	size_t cursor;
 	
 };
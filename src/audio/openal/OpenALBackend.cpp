@@ -21,6 +21,7 @@
 
 #include <stddef.h>
 #include <cstring>
+#include <limits>
 
 #include <boost/math/special_functions/fpclassify.hpp>
 
@@ -41,11 +42,18 @@ class Sample;
 #undef ALError
 #define ALError LogError
 
+/*!
+ * Number of OpenAL sources used for static (non-streaming) samples. Additional playing
+ * samples are virtualized. Streaming samples and ambiances always get their own source,
+ * so this must be lower than the 256 mono sources available with OpenAL Soft.
+ */
+static const size_t MAX_VOICES = 64;
+
 OpenALBackend::OpenALBackend() : device(NULL), context(NULL),
 #ifdef ARX_HAVE_OPENAL_EFX
 	hasEFX(false), effectEnabled(false),
 #endif
-	rolloffFactor(1.f) {
+	voices(MAX_VOICES), rolloffFactor(1.f), listenerPosition(Vec3f::ZERO) {
 	
 }
 
@@ -53,6 +61,14 @@ OpenALBackend::~OpenALBackend() {
 	
 	sources.clear();
 	
+	arx_assert(!voices.size());
+	
+	if(!freeSources.empty()) {
+		alDeleteSources(freeSources.size(), &freeSources[0]);
+		AL_CHECK_ERROR_N("deleting sources",)
+		freeSources.clear();
+	}
+	
 	if(context) {
 		
 		alcDestroyContext(context);
@@ -143,11 +159,47 @@ aalError OpenALBackend::init(bool enableEffects) {
 
 aalError OpenALBackend::updateDeferred() {
 	
-	// Nothing to do here.
+	voices.update();
 	
 	return AAL_OK;
 }
 
+ALuint OpenALBackend::allocSource() {
+	
+	if(!freeSources.empty()) {
+		ALuint source = freeSources.back();
+		freeSources.pop_back();
+		return source;
+	}
+	
+	ALuint source;
+	alGenSources(1, &source);
+	AL_CHECK_ERROR_N("generating source", return 0;)
+	
+	return source;
+}
+
+void OpenALBackend::freeSource(ALuint source) {
+	
+	alSourceStop(source);
+	alSourcei(source, AL_BUFFER, 0);
+	
+	alSourcei(source, AL_SOURCE_RELATIVE, AL_FALSE);
+	alSourcef(source, AL_GAIN, 1.f);
+	alSourcef(source, AL_PITCH, 1.f);
+	alSource3f(source, AL_POSITION, 0.f, 0.f, 0.f);
+	alSource3f(source, AL_VELOCITY, 0.f, 0.f, 0.f);
+	alSource3f(source, AL_DIRECTION, 0.f, 0.f, 0.f);
+	alSourcef(source, AL_CONE_INNER_ANGLE, 360.f);
+	alSourcef(source, AL_CONE_OUTER_ANGLE, 360.f);
+	alSourcef(source, AL_CONE_OUTER_GAIN, 0.f);
+	alSourcef(source, AL_REFERENCE_DISTANCE, 1.f);
+	alSourcef(source, AL_MAX_DISTANCE, std::numeric_limits<float>::max());
+	AL_CHECK_ERROR_N("resetting source", alDeleteSources(1, &source); return;)
+	
+	freeSources.push_back(source);
+}
+
 Source * OpenALBackend::createSource(SampleId sampleId, const Channel & channel) {
 	
 	SampleId s_id = getSampleId(sampleId);
@@ -225,6 +277,8 @@ aalError OpenALBackend::setListenerPosition(const Vec3f & position) {
 	alListener3f(AL_POSITION, position.x, position.y, position.z);
 	AL_CHECK_ERROR("setting listener posiotion")
 	
+	listenerPosition = position;
+	
 	return AAL_OK;
 }
 
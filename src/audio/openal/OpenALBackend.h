@@ -22,6 +22,8 @@
 
 #include "Configure.h"
 
+#include <vector>
+
 #include <al.h>
 #include <alc.h>
 #ifdef ARX_HAVE_OPENAL_EFX
@@ -31,7 +33,9 @@
 #include "audio/AudioBackend.h"
 #include "audio/AudioTypes.h"
 #include "audio/AudioResource.h"
+#include "audio/VoicePool.h"
 #include "math/MathFwd.h"
+#include "math/Vector3.h"
 
 namespace audio {
 
@@ -88,8 +92,23 @@ private:
 	
 	ResourceList<OpenALSource> sources;
 	
+	/*!
+	 * Get an OpenAL source name, reusing one that was returned with freeSource() if possible.
+	 * @return 0 if no more sources can be created.
+	 */
+	ALuint allocSource();
+	
+	//! Reset a source to the default properties and keep it for reuse.
+	void freeSource(ALuint source);
+	
+	std::vector<ALuint> freeSources;
+	
+	VoicePool voices;
+	
 	float rolloffFactor;
 	
+	Vec3f listenerPosition;
+	
 	friend class OpenALSource;
 };
 
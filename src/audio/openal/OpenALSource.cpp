@@ -21,12 +21,15 @@
 
 #include <cmath>
 #include <algorithm>
+#include <limits>
 
+#include "audio/openal/OpenALBackend.h"
 #include "audio/openal/OpenALUtils.h"
 #include "audio/AudioGlobal.h"
 #include "audio/AudioResource.h"
 #include "audio/Stream.h"
 #include "audio/Sample.h"
+#include "audio/SampleCache.h"
 #include "audio/Mixer.h"
 #include "io/resource/ResourcePath.h"
 #include "io/log/Logger.h"
@@ -49,6 +52,24 @@ static size_t nbbuffers = 0;
 // How often to queue the buffer when looping but not streaming.
 #define MAXLOOPBUFFERS std::max((size_t)NBUFFERS, NBUFFERS * stream_limit_bytes / sample->getLength())
 
+static OpenALBackend & getBackend() {
+	return *static_cast<OpenALBackend *>(backend);
+}
+
+//! Final gain of a source, combining the channel and mixer volumes.
+static float getFinalVolume(const Channel & channel) {
+	
+	const Mixer * mixer = _mixer[channel.mixer];
+	float volume = mixer ? mixer->getFinalVolume() : 1.f;
+	
+	if(volume) {
+		// LogToLinearVolume(LinearToLogVolume(volume) * channel.volume)
+		volume = std::pow(100000.f * volume, channel.volume) / 100000.f;
+	}
+	
+	return volume;
+}
+
 aalError OpenALSource::sourcePlay() {
 	
 	ALint val;
@@ -92,6 +113,7 @@ OpenALSource::OpenALSource(Sample * _sample) :
 	streaming(false), loadCount(0), written(0), stream(NULL),
 	read(0),
 	source(0),
+	virtualQueued(0), virtualTime(0), rolloff(1.f),
 	refcount(NULL) {
 	for(size_t i = 0; i < NBUFFERS; i++) {
 		buffers[i] = 0;
@@ -102,18 +124,12 @@ OpenALSource::~OpenALSource() {
 	
 	LogAL("clean");
 	
-	if(alIsSource(source)) {
-		
-		alSourceStop(source);
-		AL_CHECK_ERROR_N("stopping source",)
-		
-		alDeleteSources(1, &source);
-		nbsources--;
-		AL_CHECK_ERROR_N("deleting source",)
-		
-		source = 0;
-	} else {
-		arx_assert(!source);
+	if(!streaming) {
+		getBackend().voices.remove(this);
+	}
+	
+	if(source) {
+		freeSource();
 	}
 	
 	if(streaming) {
@@ -182,17 +198,12 @@ aalError OpenALSource::init(SourceId _id, OpenALSource * inst, const Channel & _
 		
 	}
 	
-	alGenSources(1, &source);
-	nbsources++;
-	alSourcei(source, AL_LOOPING, AL_FALSE);
-	AL_CHECK_ERROR("generating source")
-	
 	streaming = (sample->getLength() > (stream_limit_bytes * NBUFFERS));
 	
 	LogAL("init: length=" << sample->getLength() << " " << (streaming ? "streaming" : "static") << (buffers[0] ? " (copy)" : ""));
 	
 	if(!streaming && !buffers[0]) {
-		stream = createStream(sample->getName());
+		stream = createSampleStream(sample);
 		if(!stream) {
 			ALError << "error creating stream";
 			return AAL_ERROR_FILEIO;
@@ -211,11 +222,6 @@ aalError OpenALSource::init(SourceId _id, OpenALSource * inst, const Channel & _
 	setVolume(channel.volume);
 	setPitch(channel.pitch);
 	
-	if(!(channel.flags & FLAG_POSITION) || (channel.flags & FLAG_RELATIVE)) {
-		alSourcei(source, AL_SOURCE_RELATIVE, AL_TRUE);
-		AL_CHECK_ERROR("setting relative flag")
-	}
-	
 	// Create 3D interface if required
 	if(channel.flags & FLAG_ANY_3D_FX) {
 		
@@ -233,9 +239,55 @@ aalError OpenALSource::init(SourceId _id, OpenALSource * inst, const Channel & _
 		setPan(channel.pan);
 	}
 	
+	// Static sources get their OpenAL source from the voice pool once they are played.
+	if(streaming) {
+		return allocSource();
+	}
+	
 	return AAL_OK;
 }
 
+aalError OpenALSource::allocSource() {
+	
+	arx_assert(!source);
+	
+	source = getBackend().allocSource();
+	if(!source) {
+		return AAL_ERROR_SYSTEM;
+	}
+	nbsources++;
+	
+	alSourcei(source, AL_LOOPING, AL_FALSE);
+	AL_CHECK_ERROR("initializing source")
+	
+	if(!(channel.flags & FLAG_POSITION) || (channel.flags & FLAG_RELATIVE)) {
+		alSourcei(source, AL_SOURCE_RELATIVE, AL_TRUE);
+		AL_CHECK_ERROR("setting relative flag")
+	}
+	
+	updateVolume();
+	setPitch(channel.pitch);
+	
+	if(channel.flags & FLAG_ANY_3D_FX) {
+		setPosition(channel.position);
+		setVelocity(channel.velocity);
+		setDirection(channel.direction);
+		setCone(channel.cone);
+		setFalloff(channel.falloff);
+	}
+	
+	return setRolloffFactor(rolloff);
+}
+
+void OpenALSource::freeSource() {
+	
+	arx_assert(source);
+	
+	getBackend().freeSource(source);
+	nbsources--;
+	source = 0;
+}
+
 aalError OpenALSource::fillAllBuffers() {
 	
 	arx_assert(streaming);
@@ -368,19 +420,15 @@ aalError OpenALSource::fillBuffer(size_t i, size_t size) {
 
 aalError OpenALSource::updateVolume() {
 	
-	if(!alIsSource(source) || !(channel.flags & FLAG_VOLUME)) {
+	if(!(channel.flags & FLAG_VOLUME)) {
 		return AAL_ERROR_INIT;
 	}
 	
-	const Mixer * mixer = _mixer[channel.mixer];
-	float volume = mixer ? mixer->getFinalVolume() : 1.f;
-	
-	if(volume) {
-		// LogToLinearVolume(LinearToLogVolume(volume) * channel.volume)
-		volume = std::pow(100000.f * volume, channel.volume) / 100000.f;
+	if(!source) {
+		return AAL_OK;
 	}
 	
-	alSourcef(source, AL_GAIN, volume);
+	alSourcef(source, AL_GAIN, getFinalVolume(channel));
 	AL_CHECK_ERROR("setting source gain")
 	
 	return AAL_OK;
@@ -388,12 +436,16 @@ aalError OpenALSource::updateVolume() {
 
 aalError OpenALSource::setPitch(float p) {
 	
-	if(!alIsSource(source) || !(channel.flags & FLAG_PITCH)) {
+	if(!(channel.flags & FLAG_PITCH)) {
 		return AAL_ERROR_INIT;
 	}
 	
 	channel.pitch = clamp(p, 0.1f, 2.f);
 	
+	if(!source) {
+		return AAL_OK;
+	}
+	
 	alSourcef(source, AL_PITCH, channel.pitch);
 	AL_CHECK_ERROR("setting source pitch")
 	
@@ -402,7 +454,7 @@ aalError OpenALSource::setPitch(float p) {
 
 aalError OpenALSource::setPan(float p) {
 	
-	if(!alIsSource(source) || !(channel.flags & FLAG_PAN)) {
+	if(!(channel.flags & FLAG_PAN)) {
 		return AAL_ERROR_INIT;
 	}
 	
@@ -420,7 +472,7 @@ aalError OpenALSource::setPan(float p) {
 
 aalError OpenALSource::setPosition(const Vec3f & position) {
 	
-	if(!alIsSource(source) || !(channel.flags & FLAG_POSITION)) {
+	if(!(channel.flags & FLAG_POSITION)) {
 		return AAL_ERROR_INIT;
 	}
 	
@@ -430,6 +482,10 @@ aalError OpenALSource::setPosition(const Vec3f & position) {
 		return AAL_ERROR; // OpenAL soft will lock up if given NaN or +-Inf here
 	}
 	
+	if(!source) {
+		return AAL_OK;
+	}
+	
 	alSource3f(source, AL_POSITION, position.x, position.y, position.z);
 	AL_CHECK_ERROR("setting source position")
 	
@@ -438,7 +494,7 @@ aalError OpenALSource::setPosition(const Vec3f & position) {
 
 aalError OpenALSource::setVelocity(const Vec3f & velocity) {
 	
-	if(!alIsSource(source) || !(channel.flags & FLAG_VELOCITY)) {
+	if(!(channel.flags & FLAG_VELOCITY)) {
 		return AAL_ERROR_INIT;
 	}
 	
@@ -448,6 +504,10 @@ aalError OpenALSource::setVelocity(const Vec3f & velocity) {
 		return AAL_ERROR; // OpenAL soft will lock up if given NaN or +-Inf here
 	}
 	
+	if(!source) {
+		return AAL_OK;
+	}
+	
 	alSource3f(source, AL_VELOCITY, velocity.x, velocity.y, velocity.z);
 	AL_CHECK_ERROR("setting source velocity")
 	
@@ -456,12 +516,16 @@ aalError OpenALSource::setVelocity(const Vec3f & velocity) {
 
 aalError OpenALSource::setDirection(const Vec3f & direction) {
 	
-	if(!alIsSource(source) || !(channel.flags & FLAG_DIRECTION)) {
+	if(!(channel.flags & FLAG_DIRECTION)) {
 		return AAL_ERROR_INIT;
 	}
 	
 	channel.direction = direction;
 	
+	if(!source) {
+		return AAL_OK;
+	}
+	
 	alSource3f(source, AL_DIRECTION, direction.x, direction.y, direction.z);
 	AL_CHECK_ERROR("setting source direction")
 	
@@ -470,7 +534,7 @@ aalError OpenALSource::setDirection(const Vec3f & direction) {
 
 aalError OpenALSource::setCone(const SourceCone & cone) {
 	
-	if(!alIsSource(source) || !(channel.flags & FLAG_CONE)) {
+	if(!(channel.flags & FLAG_CONE)) {
 		return AAL_ERROR_INIT;
 	}
 	
@@ -478,6 +542,10 @@ aalError OpenALSource::setCone(const SourceCone & cone) {
 	channel.cone.outer_angle = cone.outer_angle;
 	channel.cone.outer_volume = clamp(cone.outer_volume, 0.f, 1.f);
 	
+	if(!source) {
+		return AAL_OK;
+	}
+	
 	alSourcef(source, AL_CONE_INNER_ANGLE, channel.cone.inner_angle);
 	alSourcef(source, AL_CONE_OUTER_ANGLE, channel.cone.outer_angle);
 	alSourcef(source, AL_CONE_OUTER_GAIN, channel.cone.outer_volume);
@@ -488,12 +556,16 @@ aalError OpenALSource::setCone(const SourceCone & cone) {
 
 aalError OpenALSource::setFalloff(const SourceFalloff & falloff) {
 	
-	if(!alIsSource(source) || !(channel.flags & FLAG_FALLOFF)) {
+	if(!(channel.flags & FLAG_FALLOFF)) {
 		return AAL_ERROR_INIT;
 	}
 	
 	channel.falloff = falloff;
 	
+	if(!source) {
+		return AAL_OK;
+	}
+	
 	alSourcef(source, AL_MAX_DISTANCE, falloff.end);
 	alSourcef(source, AL_REFERENCE_DISTANCE, falloff.start);
 	AL_CHECK_ERROR("setting source falloff")
@@ -503,6 +575,8 @@ aalError OpenALSource::setFalloff(const SourceFalloff & falloff) {
 
 aalError OpenALSource::play(unsigned play_count) {
 	
+	bool wasIdle = (status == Idle);
+	
 	if(status != Playing) {
 		
 		LogAL("play(" << play_count << ") vol=" << channel.volume);
@@ -512,8 +586,13 @@ aalError OpenALSource::play(unsigned play_count) {
 		read = written = 0;
 		reset();
 		
-		alSourcei(source, AL_SEC_OFFSET, 0);
-		AL_CHECK_ERROR("set source offset")
+		if(source) {
+			alSourcei(source, AL_SEC_OFFSET, 0);
+			AL_CHECK_ERROR("set source offset")
+		} else {
+			virtualQueued = 0;
+			virtualTime = session_time;
+		}
 		
 	} else {
 		TraceAL("play(+" << play_count << ") vol=" << channel.volume);
@@ -529,6 +608,16 @@ aalError OpenALSource::play(unsigned play_count) {
 		if(aalError error = fillAllBuffers()) {
 			return error;
 		}
+	} else if(!source) {
+		// Without a voice we only count the buffers - they are queued in activate()
+		size_t nbuffers = MAXLOOPBUFFERS;
+		for(; virtualQueued < nbuffers && loadCount; virtualQueued++) {
+			markAsLoaded();
+		}
+		if(wasIdle) {
+			getBackend().voices.add(this);
+		}
+		return AAL_OK;
 	} else {
 		ALint queuedBuffers;
 		alGetSourcei(source, AL_BUFFERS_QUEUED, &queuedBuffers);
@@ -553,10 +642,12 @@ aalError OpenALSource::stop() {
 	
 	LogAL("stop");
 	
-	alSourceStop(source);
-	alSourceRewind(source);
-	alSourcei(source, AL_BUFFER, 0);
-	AL_CHECK_ERROR("stopping source")
+	if(source) {
+		alSourceStop(source);
+		alSourceRewind(source);
+		alSourcei(source, AL_BUFFER, 0);
+		AL_CHECK_ERROR("stopping source")
+	}
 	
 	if(streaming) {
 		for(size_t i = 0; i < NBUFFERS; i++) {
@@ -568,10 +659,16 @@ aalError OpenALSource::stop() {
 				buffers[i] = 0;
 			}
 		}
+	} else {
+		virtualQueued = 0;
 	}
 	
 	status = Idle;
 	
+	if(!streaming) {
+		getBackend().voices.remove(this);
+	}
+	
 	return AAL_OK;
 }
 
@@ -585,7 +682,9 @@ aalError OpenALSource::pause() {
 	
 	status = Paused;
 	
-	sourcePause();
+	if(source) {
+		sourcePause();
+	}
 	
 	return AAL_OK;
 }
@@ -600,6 +699,12 @@ aalError OpenALSource::resume() {
 	
 	status = Playing;
 	
+	if(!source) {
+		// The voice pool will give us a voice if we are audible
+		virtualTime = session_time;
+		return AAL_OK;
+	}
+	
 	if(updateCulling()) {
 		return AAL_OK;
 	}
@@ -611,6 +716,11 @@ bool OpenALSource::updateCulling() {
 	
 	arx_assert(status == Playing);
 	
+	if(!streaming) {
+		// Static sources are culled by the voice pool based on their audibility.
+		return false;
+	}
+	
 	if(!(channel.flags & FLAG_POSITION) || !alIsSource(source)) {
 		return false;
 	}
@@ -659,6 +769,10 @@ bool OpenALSource::updateCulling() {
 
 aalError OpenALSource::updateBuffers() {
 	
+	if(!source) {
+		return updateVirtual();
+	}
+	
 	// Stream data / queue buffers.
 	
 	// We need to get the source state before the number of processed buffers to prevent a race condition with the source reaching the end of the last buffer.
@@ -752,6 +866,14 @@ aalError OpenALSource::updateBuffers() {
 		}
 	}
 	
+	if(!source) {
+		// stop() returned the source to the voice pool
+		arx_assert(status == Idle);
+		time -= read;
+		read = 0;
+		return ret;
+	}
+	
 	
 	// Inform callbacks about the time played.
 	
@@ -792,16 +914,190 @@ aalError OpenALSource::updateBuffers() {
 	return ret;
 }
 
+size_t OpenALSource::getBufferedBytes() const {
+	
+	// read is the offset into the first queued buffer - refill once that is done
+	size_t size = streaming ? stream_limit_bytes : bufferSizes[0];
+	
+	return (read < size) ? size - read : 0;
+}
+
 bool OpenALSource::markAsLoaded() {
 	return (loadCount == (unsigned)-1 || --loadCount);
 }
 
 aalError OpenALSource::setRolloffFactor(float factor) {
 	
+	rolloff = factor;
+	
+	if(!source) {
+		return AAL_OK;
+	}
+	
 	alSourcef(source, AL_ROLLOFF_FACTOR, factor);
 	AL_CHECK_ERROR("setting rolloff factor");
 	
 	return AAL_OK;
 }
 
+aalError OpenALSource::updateVirtual() {
+	
+	arx_assert(!streaming && status == Playing);
+	
+	size_t size = bufferSizes[0];
+	if(!size) {
+		return stop();
+	}
+	
+	const PCMFormat & format = sample->getFormat();
+	float rate = float(format.frequency);
+	if(channel.flags & FLAG_PITCH) {
+		rate *= channel.pitch;
+	}
+	
+	size_t elapsed = session_time - virtualTime;
+	virtualTime = session_time;
+	
+	size_t frames = size_t(float(elapsed) * 0.001f * rate);
+	size_t newRead = read + frames * format.channels * (format.quality >> 3);
+	
+	while(virtualQueued && newRead >= size) {
+		newRead -= size;
+		time += size;
+		virtualQueued--;
+		if(loadCount) {
+			virtualQueued++;
+			markAsLoaded();
+		}
+	}
+	
+	if(!virtualQueued) {
+		LogAL("done playing (virtual)");
+		time -= read;
+		read = 0;
+		return stop();
+	}
+	
+	time = time - read + newRead;
+	read = newRead;
+	
+	return AAL_OK;
+}
+
+int OpenALSource::getPriority() const {
+	return channel.priority;
+}
+
+float OpenALSource::getAudibility() const {
+	
+	if(status != Playing) {
+		return 0.f;
+	}
+	
+	float gain = (channel.flags & FLAG_VOLUME) ? getFinalVolume(channel) : 1.f;
+	
+	if(!(channel.flags & FLAG_POSITION)) {
+		return gain;
+	}
+	
+	const Vec3f & listener = (channel.flags & FLAG_RELATIVE) ? Vec3f::ZERO
+	                         : getBackend().listenerPosition;
+	float d = dist(channel.position, listener);
+	
+	float start = 1.f, end = std::numeric_limits<float>::max();
+	if(channel.flags & FLAG_FALLOFF) {
+		start = channel.falloff.start, end = channel.falloff.end;
+	}
+	
+	if(!(d <= end)) {
+		return 0.f;
+	}
+	
+	// Same as AL_INVERSE_DISTANCE_CLAMPED
+	d = std::max(d, start);
+	float attenuation = start + rolloff * (d - start);
+	if(attenuation > 0.f) {
+		gain *= start / attenuation;
+	}
+	
+	return gain;
+}
+
+bool OpenALSource::activate() {
+	
+	arx_assert(!streaming && !source && status != Idle);
+	
+	if(!virtualQueued) {
+		// Done playing - we will be stopped in the next update
+		return false;
+	}
+	
+	if(allocSource()) {
+		if(source) {
+			freeSource();
+		}
+		return false;
+	}
+	
+	for(size_t i = 0; i < virtualQueued; i++) {
+		TraceAL("queueing buffer " << buffers[0]);
+		alSourceQueueBuffers(source, 1, &buffers[0]);
+	}
+	AL_CHECK_ERROR_N("queueing buffer", freeSource(); return false;)
+	virtualQueued = 0;
+	
+	if(read) {
+		alSourcei(source, AL_BYTE_OFFSET, ALint(convertStereoToMono() ? read / 2 : read));
+		AL_CHECK_ERROR_N("restoring source offset",)
+	}
+	
+	if(status == Playing) {
+		alSourcePlay(source);
+		AL_CHECK_ERROR_N("playing source",)
+	}
+	
+	LogAL("got voice");
+	
+	return true;
+}
+
+void OpenALSource::deactivate() {
+	
+	arx_assert(!streaming && source);
+	
+	if(status != Idle) {
+		
+		// Freeze the source so that the buffer counts and offset are consistent
+		alSourcePause(source);
+		
+		ALint nbuffersQueued = 0, nbuffersProcessed = 0, newRead = 0;
+		alGetSourcei(source, AL_BUFFERS_QUEUED, &nbuffersQueued);
+		alGetSourcei(source, AL_BUFFERS_PROCESSED, &nbuffersProcessed);
+		alGetSourcei(source, AL_BYTE_OFFSET, &newRead);
+		AL_CHECK_ERROR_N("getting source position", freeSource(); return;)
+		
+		if(convertStereoToMono()) {
+			newRead *= 2;
+		}
+		
+		virtualQueued = size_t(nbuffersQueued - nbuffersProcessed);
+		for(ALint c = 0; c < nbuffersProcessed; c++) {
+			time += bufferSizes[0];
+			if(loadCount) {
+				virtualQueued++;
+				markAsLoaded();
+			}
+		}
+		
+		time = time - read + newRead;
+		read = newRead;
+		
+		virtualTime = session_time;
+		
+		LogAL("lost voice");
+	}
+	
+	freeSource();
+}
+
 } // namespace audio
@@ -26,6 +26,7 @@
 
 #include "audio/AudioTypes.h"
 #include "audio/AudioSource.h"
+#include "audio/VoicePool.h"
 #include "math/MathFwd.h"
 
 namespace audio {
@@ -33,7 +34,13 @@ namespace audio {
 class Sample;
 class Stream;
 
-class OpenALSource : public Source {
+/*!
+ * OpenAL implementation of an audio source.
+ *
+ * Static (non-streaming) sources only hold an OpenAL source while the voice pool
+ * allows them to. Without one they are virtual and only advance their play position.
+ */
+class OpenALSource : public Source, public VoicePool::Voice {
 	
 public:
 	
@@ -60,17 +67,36 @@ public:
 	
 	aalError setRolloffFactor(float factor);
 	
+	int getPriority() const;
+	float getAudibility() const;
+	
 protected:
 	
+	bool activate();
+	void deactivate();
+	
 	bool updateCulling();
 	
 	aalError updateBuffers();
 	
+	size_t getBufferedBytes() const;
+	
 private:
 	
 	aalError sourcePlay();
 	aalError sourcePause();
 	
+	/*!
+	 * Get an OpenAL source from the backend and apply all channel properties to it.
+	 */
+	aalError allocSource();
+	
+	//! Return the OpenAL source to the backend.
+	void freeSource();
+	
+	//! Advance the play position of a source without an OpenAL source.
+	aalError updateVirtual();
+	
 	/*!
 	 * Create buffers for all unused entries of the buffers array and fill them.
 	 */
@@ -106,6 +132,10 @@ private:
 	
 	ALuint source;
 	
+	size_t virtualQueued; // Buffers 'queued' while the source is virtual
+	size_t virtualTime; // session_time of the last virtual update
+	float rolloff;
+	
 	enum { NBUFFERS = 2 };
 
 	ALuint buffers[NBUFFERS];
@@ -115,6 +115,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 
 #include "platform/Flags.h"
 #include "platform/Platform.h"
+#include "platform/WorkerPool.h"
 
 #include "scene/ChangeLevel.h"
 #include "scene/Interactive.h"
@@ -1206,7 +1207,7 @@ void ArxGame::Render() {
 			{
 				for(size_t k = 0 ; k < MAX_ASPEECH; k++) {
 					if (aspeech[k].exist)
-						if (aspeech[k].io==entities[main_conversation.actors[j]])
+						if (aspeech[k].io==entities.handle(entities[main_conversation.actors[j]]))
 						{
 							main_conversation.current=k;
 							j=main_conversation.actors_nb+1;
@@ -1314,7 +1315,7 @@ void ArxGame::Render() {
 		if (valid>=0)
 		{
 			CinematicSpeech * acs=&aspeech[valid].cine;
-			Entity * io=aspeech[valid].io;
+			Entity * io=entities.get(aspeech[valid].io);
 			float rtime=(float)(arxtime.get_updated()-aspeech[valid].time_creation)/(float)aspeech[valid].duration;
 
 			if (rtime<0) rtime=0;
@@ -2208,6 +2209,7 @@ bool ArxGame::FinalCleanup() {
 	EERIE_PATHFINDER_Release();
 	ARX_INPUT_Release();
 	ARX_SOUND_Release();
+	WorkerPool::shutdown();
 	
 	return true;
 }
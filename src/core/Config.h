@@ -173,6 +173,8 @@ public:
 		
 		int quicksaveSlots;
 		
+		bool levelCache; //!< Cache prepared level data in the user directory.
+		
 		std::string debug; //!< Logger debug levels.
 		
 	} misc;
@@ -137,6 +137,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #include "scene/Scene.h"
 #include "scene/GameSound.h"
 #include "scene/LoadLevel.h"
+#include "scene/LevelLoader.h"
 #include "scene/Interactive.h"
 #include "scene/Light.h"
 #include "scene/Object.h"
@@ -3442,6 +3443,11 @@ void ShowInfoText() {
 	sprintf(tex,"Velocity %3.0f %3.0f %3.0f Slope %3.3f",player.physics.velocity.x,player.physics.velocity.y,player.physics.velocity.z,slope);
 	mainApp->OutputText( 70, 128, tex );
 
+	EventStackStats stack = ARX_SCRIPT_EventStackGetStats();
+	sprintf(tex, "Event stack %lu (max %lu) dropped %lu posted %lu", (unsigned long)stack.size,
+	        (unsigned long)stack.maxSize, (unsigned long)stack.dropped, (unsigned long)stack.posted);
+	mainApp->OutputText(70, 142, tex);
+
 	sprintf(tex, "nblights %ld - nb %ld", TSU_TEST_NB_LIGHT, TSU_TEST_NB);
 	mainApp->OutputText( 100, 208, tex );
 	TSU_TEST_NB = 0;
@@ -3618,6 +3624,7 @@ void shutdownGame() {
 	//object loaders from beforerun
 	ReleaseDanaeBeforeRun();
 	
+	ARX_LEVELLOADER_Stop();
 	delete resources;
 	
 	ReleaseNode();
@@ -205,7 +205,7 @@ float ARX_DAMAGES_DamagePlayer(float dmg, DamageType type, long source) {
 
 	if (float(arxtime) > entities.player()->ouch_time + 500)
 	{
-		Entity * oes = EVENT_SENDER;
+		EntityHandle oes = entities.handle(EVENT_SENDER);
 
 		if (ValidIONum(source))
 			EVENT_SENDER = entities[source];
@@ -216,7 +216,7 @@ float ARX_DAMAGES_DamagePlayer(float dmg, DamageType type, long source) {
 		char tex[32];
 		sprintf(tex, "%5.2f", entities.player()->dmg_sum);
 		SendIOScriptEvent( entities.player(), SM_OUCH, tex );
-		EVENT_SENDER = oes;
+		EVENT_SENDER = entities.get(oes);
 		float power = entities.player()->dmg_sum / player.maxlife * 220.f;
 		AddQuakeFX(power * 3.5f, 500 + power * 3, rnd() * 100.f + power + 200, 0);
 		entities.player()->dmg_sum = 0.f;
@@ -483,7 +483,7 @@ void ARX_DAMAGES_ForceDeath(Entity * io_dead, Entity * io_killer) {
 		return;
 	}
 
-	Entity * old_sender = EVENT_SENDER;
+	EntityHandle old_sender = entities.handle(EVENT_SENDER);
 	EVENT_SENDER = io_killer;
 
 	if (io_dead == DRAGINTER)
@@ -594,7 +594,7 @@ void ARX_DAMAGES_ForceDeath(Entity * io_dead, Entity * io_killer) {
 		}
 	}
 
-	EVENT_SENDER = old_sender;
+	EVENT_SENDER = entities.get(old_sender);
 }
 
 void ARX_DAMAGES_PushIO(Entity * io_target, long source, float power)
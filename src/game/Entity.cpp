@@ -211,6 +211,10 @@ Entity::~Entity() {
 		FlyingOverIO = NULL;
 	}
 	
+	if(EVENT_SENDER == this) {
+		EVENT_SENDER = NULL;
+	}
+	
 	if((MasterCamera.exist & 1) && MasterCamera.io == this) {
 		MasterCamera.exist = 0;
 	}
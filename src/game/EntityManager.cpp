@@ -69,6 +69,9 @@ void EntityManager::init() {
 	entries.resize(1);
 	entries[0] = NULL;
 	minfree = 0;
+	if(generations.empty()) {
+		generations.push_back(1);
+	}
 }
 
 void EntityManager::clear() {
@@ -105,6 +108,18 @@ long EntityManager::getById(const std::string & name) const {
 	return -1;
 }
 
+EntityHandle EntityManager::handle(const Entity * entity) const {
+	
+	if(!entity) {
+		return EntityHandle();
+	}
+	
+	size_t index = entity->index();
+	arx_assert(index < size() && entries[index] == entity);
+	
+	return EntityHandle(index, generations[index]);
+}
+
 Entity * EntityManager::getById(const std::string & name, Entity * self) const {
 	long index = getById(name);
 	return (index == -1) ? NULL : (index == -2) ? self : entries[index]; 
@@ -122,6 +137,9 @@ size_t EntityManager::add(Entity * entity) {
 	
 	size_t i = size();
 	entries.push_back(entity);
+	if(generations.size() < entries.size()) {
+		generations.push_back(1);
+	}
 	minfree = i + 1;
 	return i;
 }
@@ -137,4 +155,9 @@ void EntityManager::remove(size_t index) {
 	}
 	
 	entries[index] = NULL;
+	
+	// Invalidate all handles to this entity
+	if(++generations[index] == 0) {
+		generations[index] = 1;
+	}
 }
@@ -25,6 +25,46 @@
 #include <vector>
 
 class Entity;
+class EntityManager;
+
+/*!
+ * Weak reference to an entity.
+ *
+ * A handle stores the entity index together with the generation of that index
+ * at the time the handle was created. Each time an index is freed its generation
+ * is incremented, so handles to destroyed entities never resolve to a different
+ * entity that reuses the same index.
+ *
+ * A zero-initialized handle is a null handle.
+ */
+class EntityHandle {
+	
+public:
+	
+	EntityHandle() : index_(0), generation_(0) { }
+	
+	//! @return true if this handle does not reference any entity
+	bool isNull() const { return generation_ == 0; }
+	
+	size_t index() const { return index_; }
+	
+	bool operator==(const EntityHandle & o) const {
+		return index_ == o.index_ && generation_ == o.generation_;
+	}
+	
+	bool operator!=(const EntityHandle & o) const {
+		return !(*this == o);
+	}
+	
+private:
+	
+	EntityHandle(size_t index, unsigned generation) : index_(index), generation_(generation) { }
+	
+	size_t index_;
+	unsigned generation_;
+	
+	friend class EntityManager;
+};
 
 class EntityManager {
 	
@@ -49,6 +89,24 @@ public:
 		return entries[index];
 	}
 	
+	//! @return a handle for the given entity or a null handle if entity is NULL
+	EntityHandle handle(const Entity * entity) const;
+	
+	/*!
+	 * Resolve an entity handle in constant time.
+	 *
+	 * @return the entity or NULL if the handle is null or the entity has been destroyed
+	 */
+	Entity * get(EntityHandle handle) const {
+		if(handle.index_ < entries.size() && generations[handle.index_] == handle.generation_) {
+			return entries[handle.index_];
+		}
+		return NULL;
+	}
+	
+	//! @return true if the entity referenced by the handle still exists
+	bool isValid(EntityHandle handle) const { return get(handle) != NULL; }
+	
 	//! Get the player entity
 	Entity * player() const {
 		return entries[0];
@@ -74,6 +132,12 @@ private:
 	Entries entries;
 	size_t minfree; // first unused index (value == NULL)
 	
+	/*!
+	 * Current generation for each index, never 0.
+	 * This is not shrunk when clearing entities so that old handles stay invalid.
+	 */
+	std::vector<unsigned> generations;
+	
 	size_t add(Entity * entity);
 	
 	void remove(size_t index);
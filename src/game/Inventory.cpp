@@ -51,6 +51,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #include <vector>
 
 #include <boost/foreach.hpp>
+#include <boost/unordered_map.hpp>
 
 #include "ai/Paths.h"
 
@@ -117,6 +118,302 @@ short sInventory = -1;
 short sInventoryX = -1;
 short sInventoryY = -1;
 
+namespace {
+
+/*!
+ * Positions of the items in all inventories.
+ * Every place where an item is put into an inventory adds its top-left slot here.
+ * Entries are not removed when the slots are cleared, but are checked on use.
+ */
+typedef boost::unordered_multimap<const Entity *, InventoryPos> InventoryIndex;
+InventoryIndex inventoryIndex;
+
+//! @return the slot at pos or NULL if there is no such slot
+INVENTORY_SLOT * getInventorySlot(const InventoryPos & pos) {
+	
+	if(pos.io == 0) {
+		if(pos.bag >= 3 || pos.x >= INVENTORY_X || pos.y >= INVENTORY_Y) {
+			return NULL;
+		}
+		return &inventory[pos.bag][pos.x][pos.y];
+	}
+	
+	if(!ValidIONum(pos.io) || !entities[pos.io]->inventory) {
+		return NULL;
+	}
+	
+	INVENTORY_DATA * id = entities[pos.io]->inventory;
+	if(pos.bag != 0 || pos.x >= id->sizex || pos.y >= id->sizey) {
+		return NULL;
+	}
+	
+	return &id->slot[pos.x][pos.y];
+}
+
+//! @return true if item is stored at pos, with pos being its top-left slot
+bool isInventoryItemAt(const Entity * item, const InventoryPos & pos) {
+	
+	INVENTORY_SLOT * slot = getInventorySlot(pos);
+	if(!slot || slot->io != item) {
+		return false;
+	}
+	
+	if(pos.x > 0) {
+		slot = getInventorySlot(InventoryPos(pos.io, pos.bag, pos.x - 1, pos.y));
+		if(slot && slot->io == item) {
+			return false;
+		}
+	}
+	
+	if(pos.y > 0) {
+		slot = getInventorySlot(InventoryPos(pos.io, pos.bag, pos.x, pos.y - 1));
+		if(slot && slot->io == item) {
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+bool isSamePos(const InventoryPos & a, const InventoryPos & b) {
+	return a.io == b.io && a.bag == b.bag && a.x == b.x && a.y == b.y;
+}
+
+//! Order in which inventories used to be searched: player, other entities, bags, columns, rows
+bool isBeforePos(const InventoryPos & a, const InventoryPos & b) {
+	if(a.io != b.io) {
+		return a.io < b.io;
+	} else if(a.bag != b.bag) {
+		return a.bag < b.bag;
+	} else if(a.x != b.x) {
+		return a.x < b.x;
+	}
+	return a.y < b.y;
+}
+
+void indexInventoryItem(const Entity * item, const InventoryPos & pos) {
+	
+	std::pair<InventoryIndex::iterator, InventoryIndex::iterator> range;
+	range = inventoryIndex.equal_range(item);
+	for(InventoryIndex::iterator it = range.first; it != range.second; ++it) {
+		if(isSamePos(it->second, pos)) {
+			return;
+		}
+	}
+	
+	inventoryIndex.insert(std::make_pair(item, pos));
+}
+
+//! @return the index of the entity owning a secondary inventory
+long getInventoryOwner(const INVENTORY_DATA * id) {
+	
+	if(id->io && id->io->inventory == id) {
+		return id->io->index();
+	}
+	
+	for(size_t i = 1; i < entities.size(); i++) {
+		if(entities[i] && entities[i]->inventory == id) {
+			return i;
+		}
+	}
+	
+	return -1;
+}
+
+void indexInventoryItem(const Entity * item, const INVENTORY_DATA * id, long x, long y) {
+	long owner = getInventoryOwner(id);
+	if(owner != -1) {
+		indexInventoryItem(item, InventoryPos(owner, 0, x, y));
+	}
+}
+
+/*!
+ * Remove index entries for an item
+ * @param io only remove entries for this inventory, or all entries if -1
+ */
+void unindexInventoryItem(const Entity * item, long io = -1) {
+	
+	std::pair<InventoryIndex::iterator, InventoryIndex::iterator> range;
+	range = inventoryIndex.equal_range(item);
+	for(InventoryIndex::iterator it = range.first; it != range.second; ) {
+		if(io == -1 || it->second.io == io) {
+			it = inventoryIndex.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+/*!
+ * Get the first position of an item in the inventories
+ * @param io only look in this inventory, or in all inventories if -1
+ * @param bags ignore player bags at or after this index, 0 to skip the player inventory
+ */
+InventoryPos findInventoryItem(const Entity * item, long io = -1, long bags = 3) {
+	
+	InventoryPos result;
+	
+	std::pair<InventoryIndex::iterator, InventoryIndex::iterator> range;
+	range = inventoryIndex.equal_range(item);
+	for(InventoryIndex::iterator it = range.first; it != range.second; ) {
+		
+		const InventoryPos & pos = it->second;
+		
+		if(!isInventoryItemAt(item, pos)) {
+			// The item has been removed from this slot
+			it = inventoryIndex.erase(it);
+			continue;
+		}
+		
+		if((io == -1 || pos.io == io) && (pos.io != 0 || pos.bag < bags)) {
+			if(!result || isBeforePos(pos, result)) {
+				result = pos;
+			}
+		}
+		
+		++it;
+	}
+	
+	return result;
+}
+
+//! Occupied slots of an inventory bag, one bit per slot
+class InventoryBitmap {
+	
+	static const long MaxWidth = 32;
+	static const long MaxHeight = 20;
+	
+	u32 rows[MaxHeight];
+	long width;
+	long height;
+	long freeCount; //!< Number of free slots
+	
+	bool isBlocked(long x, long y) const {
+		if(x < 0 || y < 0 || x >= width || y >= height) {
+			return true;
+		}
+		return (rows[y] >> x) & 1;
+	}
+	
+	//! Count the occupied slots and borders around an area
+	long countContacts(long x, long y, long sx, long sy) const {
+		long contacts = 0;
+		for(long i = x; i < x + sx; i++) {
+			contacts += isBlocked(i, y - 1);
+			contacts += isBlocked(i, y + sy);
+		}
+		for(long j = y; j < y + sy; j++) {
+			contacts += isBlocked(x - 1, j);
+			contacts += isBlocked(x + sx, j);
+		}
+		return contacts;
+	}
+	
+public:
+	
+	InventoryBitmap(long width, long height)
+		: width(width), height(height), freeCount(width * height) {
+		arx_assert(width <= MaxWidth && height <= MaxHeight);
+		std::fill(rows, rows + MaxHeight, u32(0));
+	}
+	
+	void set(long x, long y) {
+		u32 bit = u32(1) << x;
+		if(!(rows[y] & bit)) {
+			rows[y] |= bit;
+			freeCount--;
+		}
+	}
+	
+	bool isFree(long x, long y, long sx, long sy) const {
+		u32 mask = ((u32(1) << sx) - 1) << x;
+		for(long j = y; j < y + sy; j++) {
+			if(rows[j] & mask) {
+				return false;
+			}
+		}
+		return true;
+	}
+	
+	/*!
+	 * Find a free area for an item, preferring areas that touch the most
+	 * occupied slots and borders to keep larger areas free.
+	 * Ties are resolved in column-major order, or row-major if rowMajor is true.
+	 * Bags with fewer free slots than the item needs are not searched.
+	 *
+	 * @return true if a free area was found
+	 */
+	bool findBestFit(long sx, long sy, long & x, long & y, bool rowMajor = false) const {
+		
+		if(sx <= 0 || sy <= 0 || sx > width || sy > height || sx * sy > freeCount) {
+			return false;
+		}
+		
+		long outer = rowMajor ? height - sy : width - sx;
+		long inner = rowMajor ? width - sx : height - sy;
+		long maxContacts = 2 * (sx + sy);
+		
+		long best = -1;
+		for(long a = 0; a <= outer && best < maxContacts; a++) {
+			for(long b = 0; b <= inner && best < maxContacts; b++) {
+				
+				long i = rowMajor ? b : a;
+				long j = rowMajor ? a : b;
+				if(!isFree(i, j, sx, sy)) {
+					continue;
+				}
+				
+				long contacts = countContacts(i, j, sx, sy);
+				if(contacts > best) {
+					best = contacts, x = i, y = j;
+				}
+			}
+		}
+		
+		return (best >= 0);
+	}
+	
+};
+
+} // anonymous namespace
+
+void ARX_INVENTORY_ClearIndex() {
+	inventoryIndex.clear();
+}
+
+void ARX_INVENTORY_IndexInventory(long io) {
+	
+	if(io == 0) {
+		for(size_t bag = 0; bag < 3; bag++) {
+			for(size_t i = 0; i < INVENTORY_X; i++) {
+				for(size_t j = 0; j < INVENTORY_Y; j++) {
+					InventoryPos pos(0, bag, i, j);
+					Entity * item = inventory[bag][i][j].io;
+					if(item && isInventoryItemAt(item, pos)) {
+						indexInventoryItem(item, pos);
+					}
+				}
+			}
+		}
+		return;
+	}
+	
+	if(!ValidIONum(io) || !entities[io]->inventory) {
+		return;
+	}
+	
+	INVENTORY_DATA * id = entities[io]->inventory;
+	for(long i = 0; i < id->sizex; i++) {
+		for(long j = 0; j < id->sizey; j++) {
+			InventoryPos pos(io, 0, i, j);
+			Entity * item = id->slot[i][j].io;
+			if(item && isInventoryItemAt(item, pos)) {
+				indexInventoryItem(item, pos);
+			}
+		}
+	}
+}
+
 /*!
  * Declares an IO as entering into player Inventory
  * Sends appropriate INVENTORYIN Event to player AND concerned io.
@@ -128,6 +425,7 @@ static void ARX_INVENTORY_Declare_InventoryIn(Entity * io) {
 	}
 	
 	io->show = SHOW_FLAG_IN_INVENTORY;
+	TREATZONE_RemoveIO(io);
 	
 	if(io->ignition > 0) {
 		
@@ -168,6 +466,15 @@ void CleanInventory() {
 		}
 	}
 	
+	// Drop the index entries for the player inventory
+	for(InventoryIndex::iterator it = inventoryIndex.begin(); it != inventoryIndex.end(); ) {
+		if(it->second.io == 0) {
+			it = inventoryIndex.erase(it);
+		} else {
+			++it;
+		}
+	}
+	
 	sActiveInventory = 0;
 }
 
@@ -480,6 +787,8 @@ private:
 				index(pos.bag, i, j).show = 0;
 			}
 		}
+		
+		unindexInventoryItem(item, io);
 	}
 	
 	bool insertIntoNewSlotAt(Entity * item, const Pos & pos) {
@@ -517,6 +826,8 @@ private:
 		}
 		index(pos).show = 1;
 		
+		indexInventoryItem(item, Pos(io, pos.bag, pos.x, pos.y));
+		
 		return true;
 	}
 	
@@ -525,20 +836,23 @@ private:
 		arx_assert(item != NULL && (item->ioflags & IO_ITEM));
 		
 		for(index_type bag = 0; bag < bags; bag++) {
-			for(index_type i = 0; i < width + 1 - item->sizex; i++) {
-				for(index_type j = 0; j < height + 1 - item->sizey; j++) {
-					
-					// Ignore already used inventory slots
+			
+			InventoryBitmap bitmap(width, height);
+			for(index_type i = 0; i < width; i++) {
+				for(index_type j = 0; j < height; j++) {
 					if(index(bag, i, j).io != NULL) {
-						continue;
-					}
-					
-					Pos pos(io, bag, i, j);
-					if(insertIntoNewSlotAt(item, pos)) {
-						return pos;
+						bitmap.set(i, j);
 					}
 				}
 			}
+			
+			long x, y;
+			if(bitmap.findBestFit(item->sizex, item->sizey, x, y)) {
+				Pos pos(io, bag, x, y);
+				if(insertIntoNewSlotAt(item, pos)) {
+					return pos;
+				}
+			}
 		}
 		
 		return Pos();
@@ -716,16 +1030,7 @@ public:
 	 * @return the position of the item
 	 */
 	Pos locate(const Entity * item) const {
-		for(size_t bag = 0; bag < bags; bag++) {
-			for(size_t i = 0; i < width; i++) {
-				for(size_t j = 0; j < height; j++) {
-					if(index(bag, i, j).io == item) {
-						return Pos(io, bag, i, j);
-					}
-				}
-			}
-		}
-		return Pos();
+		return findInventoryItem(item, io, bags);
 	}
 	
 	/*!
@@ -751,6 +1056,7 @@ public:
 					}
 				}
 			}
+			unindexInventoryItem(item, io);
 		}
 		return pos;
 	}
@@ -824,20 +1130,14 @@ bool giveToPlayer(Entity * item, const InventoryPos & pos) {
 
 InventoryPos removeFromInventories(Entity * item) {
 	
-	// TODO the item should know the inventory it is in and position
-	
 	InventoryPos oldPos = playerInventory.remove(item);
 	if(oldPos) {
 		return oldPos;
 	}
 	
-	for(size_t i = 1; i < entities.size(); i++) {
-		if(entities[i] && entities[i]->inventory) {
-			oldPos = getIoInventory(entities[i]).remove(item);
-			if(oldPos) {
-				return oldPos;
-			}
-		}
+	oldPos = findInventoryItem(item, -1, 0);
+	if(oldPos) {
+		return getIoInventory(entities[oldPos.io]).remove(item);
 	}
 	
 	return InventoryPos();
@@ -850,16 +1150,7 @@ InventoryPos locateInInventories(const Entity * item) {
 		return pos;
 	}
 	
-	for(size_t i = 1; i < entities.size(); i++) {
-		if(entities[i] && entities[i]->inventory) {
-			pos = getIoInventory(entities[i]).locate(item);
-			if(pos) {
-				return pos;
-			}
-		}
-	}
-	
-	return InventoryPos();
+	return findInventoryItem(item, -1, 0);
 }
 
 bool insertIntoInventory(Entity * item, const InventoryPos & pos) {
@@ -974,6 +1265,7 @@ bool CanBePutInInventory(Entity * io)
 							}
 
 						inventory[iNbBag][i][j].show = 1;
+						indexInventoryItem(io, InventoryPos(0, iNbBag, i, j));
 						ARX_INVENTORY_Declare_InventoryIn(io);
 						sInventory = -1;
 						return true;
@@ -1020,40 +1312,32 @@ bool CanBePutInInventory(Entity * io)
 		}
 	}
 	
-	if(player.bag) {
-		for(int iNbBag = 0; iNbBag < player.bag; iNbBag++) {
-			for(size_t i = 0; i <= INVENTORY_X - sx; i++) {
-				for(size_t j = 0; j <= INVENTORY_Y - sy; j++) {
-					
-					if (inventory[iNbBag][i][j].io == NULL)
-					{
-						bool valid = true;
-
-						if ((sx == 0) || (sy == 0)) valid = false;
-
-						for (size_t k = j; k < j + sy; k++)
-							for (size_t l = i; l < i + sx; l++)
-							{
-								if (inventory[iNbBag][l][k].io != NULL) valid = false;
-							}
-
-						if (valid)
-						{
-							for (size_t k = j; k < j + sy; k++)
-								for (size_t l = i; l < i + sx; l++)
-								{
-									inventory[iNbBag][l][k].io = io;
-									inventory[iNbBag][l][k].show = 0;
-								}
-
-							inventory[iNbBag][i][j].show = 1;
-							ARX_INVENTORY_Declare_InventoryIn(io);
-							return true;
-						}
-					}
+	for(int iNbBag = 0; iNbBag < player.bag; iNbBag++) {
+		
+		InventoryBitmap bitmap(INVENTORY_X, INVENTORY_Y);
+		for(size_t i = 0; i < INVENTORY_X; i++) {
+			for(size_t j = 0; j < INVENTORY_Y; j++) {
+				if(inventory[iNbBag][i][j].io != NULL) {
+					bitmap.set(i, j);
 				}
 			}
 		}
+		
+		if(!bitmap.findBestFit(sx, sy, i, j)) {
+			continue;
+		}
+		
+		for(k = j; k < j + sy; k++) {
+			for(l = i; l < i + sx; l++) {
+				inventory[iNbBag][l][k].io = io;
+				inventory[iNbBag][l][k].show = 0;
+			}
+		}
+		
+		inventory[iNbBag][i][j].show = 1;
+		indexInventoryItem(io, InventoryPos(0, iNbBag, i, j));
+		ARX_INVENTORY_Declare_InventoryIn(io);
+		return true;
 	}
 	
 	return false;
@@ -1149,6 +1433,7 @@ bool CanBePutInSecondaryInventory(INVENTORY_DATA * id, Entity * io, long * xx, l
 					}
 
 				id->slot[i][j].show = 1;
+				indexInventoryItem(io, id, i, j);
 				*xx = i;
 				*yy = j;
 				sInventory = -1;
@@ -1186,44 +1471,31 @@ bool CanBePutInSecondaryInventory(INVENTORY_DATA * id, Entity * io, long * xx, l
 				}
 		}
 
-	for (j = 0; j <= id->sizey - sy; j++)
-		for (i = 0; i <= id->sizex - sx; i++)
-		{
-			Entity * ioo = id->slot[i][j].io;
-
-			if (!ioo)
-			{
-				long valid = 1;
-
-				if ((sx == 0) || (sy == 0)) valid = 0;
-
-				for (k = j; k < j + sy; k++)
-					for (l = i; l < i + sx; l++)
-					{
-						if (id->slot[l][k].io != NULL)
-						{
-							valid = 0;
-							break;
-						}
-					}
-
-				if (valid)
-				{
-					for (k = j; k < j + sy; k++)
-						for (l = i; l < i + sx; l++)
-						{
-							id->slot[l][k].io = io;
-							id->slot[l][k].show = 0;
-						}
-
-					id->slot[i][j].show = 1;
-					*xx = i;
-					*yy = j;
-					return true;
-				}
+	InventoryBitmap bitmap(id->sizex, id->sizey);
+	for(j = 0; j < id->sizey; j++) {
+		for(i = 0; i < id->sizex; i++) {
+			if(id->slot[i][j].io != NULL) {
+				bitmap.set(i, j);
 			}
 		}
-
+	}
+	
+	if(bitmap.findBestFit(sx, sy, i, j, true)) {
+		
+		for(k = j; k < j + sy; k++) {
+			for(l = i; l < i + sx; l++) {
+				id->slot[l][k].io = io;
+				id->slot[l][k].show = 0;
+			}
+		}
+		
+		id->slot[i][j].show = 1;
+		indexInventoryItem(io, id, i, j);
+		*xx = i;
+		*yy = j;
+		return true;
+	}
+	
 	*xx = -1;
 	*yy = -1;
 
@@ -1398,6 +1670,7 @@ bool PutInInventory()
 			}
 
 			SecondaryInventory->slot[tx][ty].show = 1;
+			indexInventoryItem(DRAGINTER, SecondaryInventory, tx, ty);
 			DRAGINTER->show = SHOW_FLAG_IN_INVENTORY;
 			ARX_SOUND_PlayInterface(SND_INVSTD);
 			Set_DragInter(NULL);
@@ -1531,6 +1804,7 @@ bool PutInInventory()
 		}
 
 	inventory[iBag][tx][ty].show = 1;
+	indexInventoryItem(DRAGINTER, InventoryPos(0, iBag, tx, ty));
 
 	ARX_INVENTORY_Declare_InventoryIn(DRAGINTER);
 	ARX_SOUND_PlayInterface(SND_INVSTD);
@@ -1873,20 +2147,19 @@ void RemoveFromAllInventories(const Entity * io) {
 	playerInventory.remove(io);
 	
 	// Seek IO in Other IO's Inventories
-	for(size_t i = 0; i < entities.size(); i++) {
-		if(entities[i] != NULL) {
-			if(entities[i]->inventory != NULL) {
-				INVENTORY_DATA * id = entities[i]->inventory;
-				for(long j = 0; j < id->sizey; j++) {
-					for(long k = 0; k < id->sizex; k++) {
-						if(id->slot[k][j].io == io) {
-							id->slot[k][j].io = NULL;
-							id->slot[k][j].show = 1;
-						}
-					}
+	for(InventoryPos pos; (pos = findInventoryItem(io, -1, 0)); ) {
+		
+		INVENTORY_DATA * id = entities[pos.io]->inventory;
+		for(long j = 0; j < id->sizey; j++) {
+			for(long k = 0; k < id->sizex; k++) {
+				if(id->slot[k][j].io == io) {
+					id->slot[k][j].io = NULL;
+					id->slot[k][j].show = 1;
 				}
 			}
 		}
+		
+		unindexInventoryItem(io, pos.io);
 	}
 }
 
@@ -2080,30 +2353,14 @@ bool TakeFromInventory(Vec2s * pos)
 }
 
 bool IsInPlayerInventory(Entity * io) {
-	
-	for(long iNbBag = 0; iNbBag < player.bag; iNbBag ++) {
-		for(size_t j = 0; j < INVENTORY_Y; j++) {
-			for(size_t i = 0; i < INVENTORY_X; i++) {
-				if(inventory[iNbBag][i][j].io == io) {
-					return true;
-				}
-			}
-		}
-	}
-	
-	return false;
+	return findInventoryItem(io, 0, player.bag);
 }
 
 bool IsInSecondaryInventory(Entity * io) {
 	
 	if(SecondaryInventory) {
-		for(long j = 0; j < SecondaryInventory->sizey; j++) {
-			for(long i = 0; i < SecondaryInventory->sizex; i++) {
-				if(SecondaryInventory->slot[i][j].io == io) {
-					return true;
-				}
-			}
-		}
+		long owner = getInventoryOwner(SecondaryInventory);
+		return owner != -1 && findInventoryItem(io, owner);
 	}
 	
 	return false;
@@ -248,6 +248,16 @@ bool IsInPlayerInventory(Entity * io);
 bool IsInSecondaryInventory(Entity * io);
 bool InInventoryPos(Vec2s * pos);
 void RemoveFromAllInventories(const Entity * io);
+
+/*!
+ * Register the items of an inventory after its slots have been set directly
+ * @param io the entity owning the inventory, or 0 for the player
+ */
+void ARX_INVENTORY_IndexInventory(long io);
+
+//! Forget the positions of all items, used when all entities are released
+void ARX_INVENTORY_ClearIndex();
+
 Entity * ARX_INVENTORY_GetTorchLowestDurability();
 void ARX_INVENTORY_IdentifyAll();
 void ARX_INVENTORY_OpenClose(Entity * io);
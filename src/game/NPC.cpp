@@ -59,6 +59,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 
 #include "ai/Paths.h"
 #include "ai/PathFinderManager.h"
+#include "ai/Perception.h"
 
 #include "core/GameTime.h"
 #include "core/Core.h"
@@ -99,6 +100,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 
 #include "platform/Flags.h"
 #include "platform/Platform.h"
+#include "platform/WorkerPool.h"
 
 #include "scene/Object.h"
 #include "scene/Interactive.h"
@@ -113,7 +115,7 @@ using std::min;
 using std::max;
 using std::string;
 
-void CheckNPCEx(Entity * io);
+static bool CheckNPCEx(Entity * io);
 
 static const float ARX_NPC_ON_HEAR_MAX_DISTANCE_STEP(600.0F);
 static const float ARX_NPC_ON_HEAR_MAX_DISTANCE_ITEM(800.0F);
@@ -224,10 +226,11 @@ void ARX_NPC_Kill_Spell_Launch(Entity * io)
 	{
 		if (io->flarecount)
 		{
+			EntityHandle handle = entities.handle(io);
 			for (long i = 0; i < MAX_FLARES; i++)
 			{
-				if ((flare[i].exist)  && (flare[i].io == io))
-					flare[i].io = NULL;
+				if ((flare[i].exist)  && (flare[i].io == handle))
+					flare[i].io = EntityHandle();
 			}
 		}
 
@@ -550,27 +553,7 @@ long ARX_NPC_GetNextAttainableNodeIncrement(Entity * io)
 // Checks for nearest VALID anchor for a cylinder from a position
 //*****************************************************************************
 static long AnchorData_GetNearest(Vec3f * pos, EERIE_CYLINDER * cyl) {
-	long returnvalue = -1;
-	float distmax = std::numeric_limits<float>::max();
-	EERIE_BACKGROUND * eb = ACTIVEBKG;
-
-	for (long i = 0; i < eb->nbanchors; i++)
-	{
-		if (eb->anchors[i].nblinked)
-		{
-			float d = distSqr(eb->anchors[i].pos, *pos);
-
-			if ((d < distmax) && (eb->anchors[i].height <= cyl->height)
-			        && (eb->anchors[i].radius >= cyl->radius)
-			        && (!(eb->anchors[i].flags & ANCHOR_FLAG_BLOCKED)))
-			{
-				returnvalue = i;
-				distmax = d;
-			}
-		}
-	}
-
-	return returnvalue;
+	return AnchorData_GetNearest(ACTIVEBKG, *pos, *cyl);
 }
 
 static long AnchorData_GetNearest_2(float beta, Vec3f * pos, EERIE_CYLINDER * cyl) {
@@ -587,30 +570,7 @@ static long AnchorData_GetNearest_2(float beta, Vec3f * pos, EERIE_CYLINDER * cy
 }
 
 static long AnchorData_GetNearest_Except(Vec3f * pos, EERIE_CYLINDER * cyl, long except) {
-	
-	long returnvalue = -1;
-	float distmax = std::numeric_limits<float>::max();
-	EERIE_BACKGROUND * eb = ACTIVEBKG;
-
-	for (long i = 0; i < eb->nbanchors; i++)
-	{
-		if (i == except) continue;
-
-		if (eb->anchors[i].nblinked)
-		{
-			float d = distSqr(eb->anchors[i].pos, *pos);
-
-			if ((d < distmax) && (eb->anchors[i].height <= cyl->height)
-			        && (eb->anchors[i].radius >= cyl->radius)
-			        && (!(eb->anchors[i].flags & ANCHOR_FLAG_BLOCKED)))
-			{
-				returnvalue = i;
-				distmax = d;
-			}
-		}
-	}
-
-	return returnvalue;
+	return AnchorData_GetNearest(ACTIVEBKG, *pos, *cyl, except);
 }
 
 bool ARX_NPC_LaunchPathfind(Entity * io, long target)
@@ -784,6 +744,7 @@ wander:
 			tpr.returnlist = &io->_npcdata->pathfind.list;
 			tpr.returnnumber = &io->_npcdata->pathfind.listnb;
 			tpr.ioid = io;
+			tpr.handle = entities.handle(io);
 			tpr.isvalid = true;
 
 			if (EERIE_PATHFINDER_Add_To_Queue(&tpr))
@@ -1027,14 +988,58 @@ static void ManageNPCMovement(Entity * io);
 
 extern float MAX_ALLOWED_PER_SECOND;
 
-void ARX_PHYSICS_Apply()
-{
+namespace {
 
-	static long CURRENT_DETECT = 0;
+//! Finds the portal rooms of entities, see UpdateIORoom()
+class UpdateRoomsTask : public WorkerTask {
+	
+	const std::vector<Entity *> & list;
+	
+public:
+	
+	explicit UpdateRoomsTask(const std::vector<Entity *> & _list) : list(_list) { }
+	
+	void process(size_t item) {
+		UpdateIORoom(list[item]);
+	}
+	
+};
 
-	CURRENT_DETECT++;
+} // anonymous namespace
 
-	if (CURRENT_DETECT > TREATZONE_CUR) CURRENT_DETECT = 1;
+/*!
+ * Update the rooms of all treat zone entities that moved.
+ * Room lookups only read the level geometry and each entity only writes its
+ * own room, so the entities can be processed in parallel.
+ */
+static void ARX_PHYSICS_UpdateRooms() {
+	
+	if(!portals) {
+		return;
+	}
+	
+	static std::vector<Entity *> moved;
+	moved.clear();
+	
+	for(long i = 0; i < TREATZONE_CUR; i++) {
+		Entity * io = treatio[i].io;
+		if(io && (io->room_flags & 1)) {
+			moved.push_back(io);
+		}
+	}
+	
+	UpdateRoomsTask task(moved);
+	WorkerPool::run(task, moved.size());
+}
+
+void ARX_PHYSICS_Apply()
+{
+
+	ARX_PERCEPTION_BeginFrame();
+	
+	// Treat zone indices of the NPCs that should check if they can see the player
+	static std::vector<long> detectQueue;
+	detectQueue.clear();
 
 	for (long i = 1; i < TREATZONE_CUR; i++) // We don't manage Player(0) this way
 	{
@@ -1172,9 +1177,9 @@ void ARX_PHYSICS_Apply()
 				if ((ValidIONum(LastSelectedIONum)) &&
 				        (io == entities[LastSelectedIONum])) ShowIOPath(io);
 #endif
+				// The pathfinder thread posts the success or failure event
 				if (io->_npcdata->pathfind.listnb == 0) // Not Found
 				{
-					SendIOScriptEvent(io, SM_PATHFINDER_FAILURE);
 					io->_npcdata->pathfind.pathwait = 0;
 
 					if (io->_npcdata->pathfind.list)
@@ -1184,7 +1189,6 @@ void ARX_PHYSICS_Apply()
 				}
 				else if (io->_npcdata->pathfind.listnb > 0) // Found
 				{
-					SendIOScriptEvent(io, SM_PATHFINDER_SUCCESS);
 					io->_npcdata->pathfind.pathwait = 0;
 					io->_npcdata->pathfind.listpos += (unsigned short)ARX_NPC_GetNextAttainableNodeIncrement(io);
 
@@ -1196,7 +1200,27 @@ void ARX_PHYSICS_Apply()
 			ManageNPCMovement(io);
 			CheckNPC(io);
 
-			if (CURRENT_DETECT == i) CheckNPCEx(io);
+			detectQueue.push_back(i);
+		}
+	}
+	
+	// Sync point: all entities have moved for this frame and the detection
+	// checks below send script events, so find the new rooms now.
+	ARX_PHYSICS_UpdateRooms();
+	
+	// Only a limited number of visibility tests are done each frame, so start
+	// with the first NPC that had its test deferred in the last frame.
+	static size_t detectStart = 0;
+	if(!detectQueue.empty()) {
+		size_t deferred = detectQueue.size();
+		for(size_t k = 0; k < detectQueue.size(); k++) {
+			Entity * io = treatio[detectQueue[(detectStart + k) % detectQueue.size()]].io;
+			if(io && (io->ioflags & IO_NPC) && !CheckNPCEx(io) && deferred == detectQueue.size()) {
+				deferred = k;
+			}
+		}
+		if(deferred != detectQueue.size()) {
+			detectStart = (detectStart + deferred) % detectQueue.size();
 		}
 	}
 }
@@ -3718,20 +3742,7 @@ Entity * ARX_NPC_GetFirstNPCInSight(Entity * ioo)
 
 			if (grnd_color > 0) 
 			{
-				Vec3f ppos;
-				EERIEPOLY * epp = NULL;
-
-				if (IO_Visible(&orgn, &dest, epp, &ppos))
-				{
-					if (found_dist > dist_io)
-					{
-						found_io = io;
-						found_dist = dist_io;
-					}
-
-					continue;
-				}
-				else if (distSqr(ppos, dest) < square(25.f))
+				if (ARX_PERCEPTION_LineOfSight(ioo, io, orgn, dest, true) == VISIBILITY_VISIBLE)
 				{
 					if (found_dist > dist_io)
 					{
@@ -3780,9 +3791,10 @@ extern long GLOBAL_Player_Room;
 //   Uses Invisibility/Confuse/Torch infos.
 // RESULT:
 //   Sends appropriate Detectplayer/Undetectplayer events to the IO
+//   Returns false if the line of sight test had to be deferred to a later frame
 // WARNINGS:
 //   io and io->obj must be valid (no check !)
-void CheckNPCEx(Entity * io) {
+static bool CheckNPCEx(Entity * io) {
 	
 	// Distance Between Player and IO
 	float ds = distSqr(io->pos, player.basePosition());
@@ -3826,10 +3838,12 @@ void CheckNPCEx(Entity * io) {
 				// Check for Darkness/Stealth
 				if(CURRENT_PLAYER_COLOR > GetPlayerStealth() || SHOW_TORCH
 				   || ds < square(200.f)) {
-					Vec3f ppos;
 					// Check for Geometrical Visibility
-					if(IO_Visible(&orgn, &dest, NULL, &ppos)
-					   || distSqr(ppos, dest) < square(25.f)) {
+					Visibility los = ARX_PERCEPTION_LineOfSight(io, entities.player(), orgn, dest);
+					if(los == VISIBILITY_UNKNOWN) {
+						// Keep the current state until the test can be done
+						return false;
+					} else if(los == VISIBILITY_VISIBLE) {
 						Visible = 1;
 					}
 				}
@@ -3850,6 +3864,8 @@ void CheckNPCEx(Entity * io) {
 		SendIOScriptEvent(io, SM_UNDETECTPLAYER);
 		io->_npcdata->detect = 0;
 	}
+	
+	return true;
 }
 
 void ARX_NPC_NeedStepSound(Entity * io, Vec3f * pos, const float volume, const float power) {
@@ -3905,9 +3921,9 @@ void ARX_NPC_SpawnAudibleSound(Vec3f * pos, Entity * source, const float factor,
 
 	EVENT_SENDER = source;
 
-
-	long Source_Room = ARX_PORTALS_GetRoomNumForPosition(pos, 1);
-
+	// Only look up the source room once an NPC is in hearing range
+	long Source_Room = -1;
+	bool Source_Room_Valid = false;
 
 	for (size_t i = 0; i < entities.size(); i++)
 		if ((entities[i])
@@ -3926,6 +3942,12 @@ void ARX_NPC_SpawnAudibleSound(Vec3f * pos, Entity * source, const float factor,
 				if (entities[i]->room_flags & 1)
 					UpdateIORoom(entities[i]);
 
+				if (!Source_Room_Valid)
+				{
+					Source_Room = ARX_PORTALS_GetRoomNumForPosition(pos, 1);
+					Source_Room_Valid = true;
+				}
+
 				if ((Source_Room > -1) && (entities[i]->room > -1))
 				{
 					float fdist = SP_GetRoomDist(pos, &entities[i]->pos, Source_Room, entities[i]->room);
@@ -4045,7 +4067,7 @@ void ManageIgnition(Entity * io)
 			// Need To Kill timers
 			ARX_SCRIPT_Timer_Clear_By_IO(io);
 			io->show = SHOW_FLAG_KILLED;
-			io->gameFlags &= ~GFLAG_ISINTREATZONE;
+			TREATZONE_RemoveIO(io);
 			RemoveFromAllInventories(io);
 			ARX_INTERACTIVE_DestroyDynamicInfo(io);
 			ARX_SOUND_PlaySFX(SND_TORCH_END, &io->pos);
@@ -54,6 +54,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 
 #include "ai/PathFinderManager.h"
 #include "ai/Paths.h"
+#include "ai/Perception.h"
 
 #include "core/Application.h"
 #include "core/Localisation.h"
@@ -387,7 +388,7 @@ static void ARX_PLAYER_ManageTorch() {
 			// Need To Kill timers
 			ARX_SCRIPT_Timer_Clear_By_IO(CURRENT_TORCH);
 			CURRENT_TORCH->show = SHOW_FLAG_KILLED;
-			CURRENT_TORCH->gameFlags &= ~GFLAG_ISINTREATZONE;
+			TREATZONE_RemoveIO(CURRENT_TORCH);
 			RemoveFromAllInventories(CURRENT_TORCH);
 			ARX_INTERACTIVE_DestroyDynamicInfo(CURRENT_TORCH);
 			ARX_SOUND_PlaySFX(SND_TORCH_END);
@@ -1370,7 +1371,7 @@ void ARX_PLAYER_FrameCheck(float Framedelay)
 					bool bOk = true;
 
 					for(size_t i = 0; i < MAX_ASPEECH; i++) {
-						if(aspeech[i].exist && (aspeech[i].io == entities.player())) {
+						if(aspeech[i].exist && (aspeech[i].io == entities.handle(entities.player()))) {
 							bOk = false;
 						}
 					}
@@ -2038,7 +2039,7 @@ void ARX_PLAYER_Manage_Visual() {
 						pd->scale = Vec3f::repeat(0.2f);
 						pd->tc = TC_smoke;
 						pd->special = FADE_IN_AND_OUT | ROTATING | MODULATE_ROTATION | DISSIPATING;
-						pd->sourceionum = 0;
+						pd->sourceio = entities.handle(entities.player());
 						pd->source = &eobj->vertexlist3[id].v;
 						pd->fparam = 0.0000001f;
 						if(FistParticles & 2) {
@@ -3092,7 +3093,7 @@ void ARX_PLAYER_AddGold(Entity * gold) {
 	
 	ARX_SOUND_PlayInterface(SND_GOLD);
 	
-	gold->gameFlags &= ~GFLAG_ISINTREATZONE;
+	TREATZONE_RemoveIO(gold);
 	
 	gold->destroy();
 }
@@ -3299,6 +3300,9 @@ void ARX_GAME_Reset(long type) {
 	// Anchors
 	ANCHOR_BLOCK_Clear();
 
+	// Perception
+	ARX_PERCEPTION_Reset();
+
 	// Attractors
 	ARX_SPECIAL_ATTRACTORS_Reset();
 
@@ -62,6 +62,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #include "Configure.h"
 
 struct EERIE_3DOBJ;
+class SkinData;
 class TextureContainer;
 class Entity;
 
@@ -181,6 +182,23 @@ struct EERIEPOLY {
 	unsigned short	uslInd[4];
 };
 
+/*!
+ * Compact copy of the EERIEPOLY fields read by collision and anchor queries.
+ * Background tiles keep these in arrays parallel to their polygon lists so
+ * that collision scans do not have to pull the render data into the cache.
+ */
+struct EERIE_COLLISION_POLY {
+	Vec3f		v[4];
+	Vec3f		min;
+	Vec3f		max;
+	Vec3f		center;
+	float		area;
+	float		normy; //!< norm.y
+	float		norm2y; //!< norm2.y
+	PolyType	type;
+	EERIEPOLY *	poly; //!< Polygon this data was created from
+};
+
 #define IOPOLYVERT 3
 struct EERIE_FACE {
 	
@@ -464,6 +482,7 @@ struct EERIE_3DOBJ
 		fastaccess.padding_ = 0;
 
 		c_data = NULL;
+		skin = NULL;
 	}
 	
 	void clear();
@@ -503,6 +522,7 @@ struct EERIE_3DOBJ
 	COLLISION_SPHERES_DATA * sdata;
 	EERIE_FASTACCESS fastaccess;
 	EERIE_C_DATA * c_data;
+	SkinData * skin;
 	
 };
 
@@ -570,6 +590,7 @@ struct EERIE_ANIM
 	EERIE_FRAME *	frames;
 	EERIE_GROUP  *  groups;
 	unsigned char *	voidgroups;
+	long		nb_ordered_frames; //!< Leading key frames with strictly increasing times
 };
 
 //-------------------------------------------------------------------------
@@ -53,9 +53,12 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 
 #include <cstdlib>
 #include <cstring>
+#include <list>
 
 #include <boost/algorithm/string/case_conv.hpp>
+#include <boost/functional/hash.hpp>
 #include <boost/static_assert.hpp>
+#include <boost/unordered_map.hpp>
 
 #include "graphics/data/FTLFormat.h"
 #include "graphics/data/TextureContainer.h"
@@ -361,61 +364,107 @@ bool ARX_FTL_Save(const fs::path & file, const EERIE_3DOBJ * obj) {
 #endif // BUILD_EDIT_LOADSAVE
 
 // MESH cache structure definition & Globals
-struct MCACHE_DATA {
-	res::path name;
+namespace {
+
+struct MeshCacheEntry {
+	
+	//! Decompressed FTL file data
 	char * data;
 	size_t size;
+	
+	//! Position in the LRU list
+	std::list<res::path>::iterator lru;
+	
+};
+
+struct PathHash {
+	size_t operator()(const res::path & path) const {
+		return boost::hash<std::string>()(path.string());
+	}
 };
-static vector<MCACHE_DATA> meshCache;
 
-// Checks for Mesh file existence in cache
-static long MCache_Get(const res::path & file) {
+typedef boost::unordered_map<res::path, MeshCacheEntry, PathHash> MeshCache;
+
+//! Cached FTL files, indexed by resource path
+MeshCache meshCache;
+
+//! Cached FTL files, most recently used first
+std::list<res::path> meshCacheLRU;
+
+//! Total size of the data in meshCache
+size_t meshCacheSize = 0;
+
+//! Maximum total size of decompressed FTL data to keep in the cache
+const size_t MESH_CACHE_BUDGET = 32 * 1024 * 1024;
+
+} // anonymous namespace
+
+// Retreives a Mesh File pointer from cache and marks it as recently used
+static char * MCache_Get(const res::path & file, size_t & size) {
 	
-	for(size_t i = 0; i < meshCache.size(); i++) {
-		if(meshCache[i].name == file) {
-			return i;
-		}
+	MeshCache::iterator it = meshCache.find(file);
+	if(it == meshCache.end()) {
+		return NULL;
 	}
 	
-	return -1;
+	meshCacheLRU.splice(meshCacheLRU.begin(), meshCacheLRU, it->second.lru);
+	
+	size = it->second.size;
+	return it->second.data;
 }
 
-// Pushes a Mesh In Mesh Cache
+// Removes the least recently used meshes until there is enough space for size bytes
+static void MCache_Evict(size_t size) {
+	
+	while(!meshCacheLRU.empty() && meshCacheSize + size > MESH_CACHE_BUDGET) {
+		
+		MeshCache::iterator it = meshCache.find(meshCacheLRU.back());
+		arx_assert(it != meshCache.end());
+		
+		LogDebug("evicting " << it->first << " from mesh cache");
+		
+		meshCacheSize -= it->second.size;
+		free(it->second.data);
+		meshCache.erase(it);
+		meshCacheLRU.pop_back();
+	}
+}
+
+/*!
+ * Pushes a Mesh In Mesh Cache
+ * @return true if the cache took ownership of the data
+ */
 static bool MCache_Push(const res::path & file, char * data, size_t size) {
 	
-	if(MCache_Get(file) != -1) {
-		return false; // already cached
+	if(size > MESH_CACHE_BUDGET || meshCache.find(file) != meshCache.end()) {
+		return false;
 	}
 	
-	LogDebug(file << " #" << meshCache.size());
+	MCache_Evict(size);
+	
+	LogDebug(file << " #" << meshCache.size() << " (" << meshCacheSize << " + " << size
+	         << " bytes)");
+	
+	meshCacheLRU.push_front(file);
 	
-	MCACHE_DATA newMesh;
-	newMesh.size = size;
-	newMesh.data = data;
-	newMesh.name = file;
-	meshCache.push_back(newMesh);
+	MeshCacheEntry & entry = meshCache[file];
+	entry.data = data;
+	entry.size = size;
+	entry.lru = meshCacheLRU.begin();
+	meshCacheSize += size;
 	
 	return true;
 }
 
-void MCache_ClearAll(){
-	for(vector<MCACHE_DATA>::iterator it = meshCache.begin(); it != meshCache.end(); ++it) {
-		free(it->data);
-	}
-
-	meshCache.clear();
-}
-
-// Retreives a Mesh File pointer from cache...
-static char * MCache_Pop(const res::path & file, size_t & size) {
+void MCache_ClearAll() {
 	
-	long num = MCache_Get(file);
-	if(num == -1) {
-		return NULL;
+	for(MeshCache::iterator it = meshCache.begin(); it != meshCache.end(); ++it) {
+		free(it->second.data);
 	}
 	
-	size = meshCache[num].size;
-	return meshCache[num].data;
+	meshCache.clear();
+	meshCacheLRU.clear();
+	meshCacheSize = 0;
 }
 
 EERIE_3DOBJ * ARX_FTL_Load(const res::path & file) {
@@ -423,69 +472,74 @@ EERIE_3DOBJ * ARX_FTL_Load(const res::path & file) {
 	// Creates FTL file name
 	res::path filename = (res::path("game") / file).set_ext("ftl");
 	
-	// Checks for FTL file existence
-	PakFile * pf = resources->getFile(filename);
-	if(!pf) {
-		return NULL;
-	}
-	
-	size_t compressedSize = 0;
-	char * compressedData = MCache_Pop(filename, compressedSize);
 	LogDebug("File name check " << filename);
 	
-	bool NOrelease = true;
-	if(!compressedData) {
-		compressedData = pf->readAlloc();
-		compressedSize = pf->size();
-		NOrelease = MCache_Push(filename, compressedData, compressedSize) ? 1 : 0;
-	}
-	
-	if(!compressedData) {
-		LogError << "ARX_FTL_Load: error loading from PAK/cache " << filename;
-		return NULL;
-	}
+	// The decompressed file data, owned by the mesh cache if cached is true
+	size_t allocsize = 0;
+	char * dat = MCache_Get(filename, allocsize);
+	bool cached = (dat != NULL);
 	
-	size_t allocsize; // The size of the data TODO size ignored
-	char * dat = blastMemAlloc(compressedData, compressedSize, allocsize);
 	if(!dat) {
-		LogError << "ARX_FTL_Load: error decompressing " << filename;
-		return NULL;
-	}
-	
-	if(!NOrelease) {
+		
+		// Checks for FTL file existence
+		PakFile * pf = resources->getFile(filename);
+		if(!pf) {
+			return NULL;
+		}
+		
+		char * compressedData = pf->readAlloc();
+		if(!compressedData) {
+			LogError << "ARX_FTL_Load: error loading from PAK " << filename;
+			return NULL;
+		}
+		
+		dat = blastMemAlloc(compressedData, pf->size(), allocsize);
 		free(compressedData);
+		if(!dat) {
+			LogError << "ARX_FTL_Load: error decompressing " << filename;
+			return NULL;
+		}
+		
+		if(allocsize < sizeof(ARX_FTL_PRIMARY_HEADER) + 512 + sizeof(ARX_FTL_SECONDARY_HEADER)) {
+			LogError << "ARX_FTL_Load: truncated file " << filename;
+			free(dat);
+			return NULL;
+		}
+		
+		// Pointer to Primary Header
+		const ARX_FTL_PRIMARY_HEADER * afph;
+		afph = reinterpret_cast<const ARX_FTL_PRIMARY_HEADER *>(dat);
+		
+		// Verify FTL file Signature
+		if(afph->ident[0] != 'F' || afph->ident[1] != 'T' || afph->ident[2] != 'L') {
+			LogError << "ARX_FTL_Load: wrong magic number in " << filename;
+			free(dat);
+			return NULL;
+		}
+		
+		// Verify FTL file version
+		if(afph->version != CURRENT_FTL_VERSION) {
+			LogError << "ARX_FTL_Load: wring version " << afph->version << ", expected "
+			         << CURRENT_FTL_VERSION << " in " << filename;
+			free(dat);
+			return NULL;
+		}
+		
+		// Only valid files are cached
+		cached = MCache_Push(filename, dat, allocsize);
 	}
 	
-	size_t pos = 0; // The position within the data
-	
-	// Pointer to Primary Header
-	const ARX_FTL_PRIMARY_HEADER * afph = reinterpret_cast<const ARX_FTL_PRIMARY_HEADER *>(dat + pos);
-	pos += sizeof(ARX_FTL_PRIMARY_HEADER);
-	
-	// Verify FTL file Signature
-	if(afph->ident[0] != 'F' || afph->ident[1] != 'T' || afph->ident[2] != 'L') {
-		LogError << "ARX_FTL_Load: wrong magic number in " << filename;
-		free(dat);
-		return NULL;
-	}
-	
-	// Verify FTL file version
-	if(afph->version != CURRENT_FTL_VERSION) {
-		LogError << "ARX_FTL_Load: wring version " << afph->version << ", expected "
-		         << CURRENT_FTL_VERSION << " in " << filename;
-		free(dat);
-		return NULL;
-	}
-	
-	// Increases offset by checksum size
-	pos += 512;
+	// Skip the primary header and checksum
+	size_t pos = sizeof(ARX_FTL_PRIMARY_HEADER) + 512;
 	
 	// Pointer to Secondary Header
 	const ARX_FTL_SECONDARY_HEADER * afsh;
 	afsh = reinterpret_cast<const ARX_FTL_SECONDARY_HEADER *>(dat + pos);
 	if(afsh->offset_3Ddata == -1) {
 		LogError << "ARX_FTL_Load: error loading data from " << filename;
-		free(dat);
+		if(!cached) {
+			free(dat);
+		}
 		return NULL;
 	}
 	pos = afsh->offset_3Ddata;
@@ -680,8 +734,10 @@ EERIE_3DOBJ * ARX_FTL_Load(const res::path & file) {
 		std::copy(begin, end, obj->cdata->springs.begin());
 	}
 	
-	// Free the loaded file memory
-	free(dat);
+	// Free the loaded file memory unless it is kept in the mesh cache
+	if(!cached) {
+		free(dat);
+	}
 	
 	EERIE_OBJECT_CenterObjectCoordinates(obj);
 	EERIE_CreateCedricData(obj);
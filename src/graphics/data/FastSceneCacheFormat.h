@@ -0,0 +1,120 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ARX_GRAPHICS_DATA_FASTSCENECACHEFORMAT_H
+#define ARX_GRAPHICS_DATA_FASTSCENECACHEFORMAT_H
+
+#include "graphics/GraphicsFormat.h"
+#include "platform/Platform.h"
+
+/*!
+ * Level cache files store the fully prepared scene from a fast.fts file
+ * (polygons with their bounding data, per-tile polygon lists, anchors, rooms
+ * with their portal lists and room distances) so that it can be loaded
+ * without decompressing and preprocessing the original file again.
+ *
+ * Cache files are not portable: structures are stored in their in-memory
+ * layout, with pointers replaced by indices. The header records the sizes of
+ * the stored structures and the cache is ignored if they do not match.
+ *
+ * Layout:
+ *  SCENE_CACHE_HEADER
+ *  nb_textures * SCENE_CACHE_TEXTURE
+ *  for each tile (x major):
+ *   SCENE_CACHE_TILE
+ *   nbpoly * EERIEPOLY (tex set to NULL)
+ *   nbpoly * s32 (texture index or -1)
+ *   nbianchors * s32
+ *   nbpolyin * SCENE_CACHE_POLY_REF
+ *  for each anchor:
+ *   SCENE_CACHE_ANCHOR
+ *   nb_linked * s32
+ *  nb_portals * EERIE_PORTALS (poly.tex set to NULL)
+ *  for each room (nb_rooms + 1):
+ *   SCENE_CACHE_ROOM
+ *   nb_portals * s32
+ *   nb_polys * EP_DATA
+ *  nb_room_distances^2 * ROOM_DIST_DATA
+ */
+
+const char SCENE_CACHE_MAGIC[4] = { 'A', 'X', 'S', 'C' };
+const u32 SCENE_CACHE_VERSION = 1;
+
+#pragma pack(push,1)
+
+struct SCENE_CACHE_HEADER {
+	char magic[4];
+	u32 version;
+	u32 source_hash; //!< CRC32 of the fast.fts file
+	u32 source_size; //!< Size of the fast.fts file
+	u32 poly_size; //!< sizeof(EERIEPOLY)
+	u32 portal_size; //!< sizeof(EERIE_PORTALS)
+	u32 pointer_size; //!< sizeof(void *)
+	s32 sizex;
+	s32 sizez;
+	SavedVec3 playerpos;
+	SavedVec3 Mscenepos;
+	s32 nb_textures;
+	s32 nb_anchors;
+	s32 nb_rooms; //!< -1 if the scene has no portals
+	s32 nb_portals;
+	s32 nb_room_distances;
+};
+
+struct SCENE_CACHE_TEXTURE {
+	char name[256];
+};
+
+struct SCENE_CACHE_TILE {
+	s8 treat;
+	s8 nothing;
+	s16 nbpoly;
+	s16 nbianchors;
+	s16 nbpolyin;
+	f32 frustrum_miny;
+	f32 frustrum_maxy;
+	f32 tile_miny;
+	f32 tile_maxy;
+	s32 flags;
+};
+
+//! Reference to a polygon in the polydata of another tile
+struct SCENE_CACHE_POLY_REF {
+	s16 tilex;
+	s16 tilez;
+	s32 poly;
+};
+
+struct SCENE_CACHE_ANCHOR {
+	SavedVec3 pos;
+	f32 radius;
+	f32 height;
+	s16 nb_linked;
+	s16 padding;
+	u32 flags;
+};
+
+struct SCENE_CACHE_ROOM {
+	s32 nb_portals;
+	s32 nb_polys;
+};
+
+#pragma pack(pop)
+
+#endif // ARX_GRAPHICS_DATA_FASTSCENECACHEFORMAT_H
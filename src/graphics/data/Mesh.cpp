@@ -46,10 +46,12 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 
 #include "graphics/data/Mesh.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstdio>
 #include <map>
 
+#include <boost/crc.hpp>
 #include <boost/scoped_array.hpp>
 #include <boost/unordered_map.hpp>
 
@@ -70,6 +72,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #include "graphics/Math.h"
 #include "graphics/VertexBuffer.h"
 #include "graphics/data/TextureContainer.h"
+#include "graphics/data/FastSceneCacheFormat.h"
 #include "graphics/data/FastSceneFormat.h"
 #include "graphics/particle/ParticleEffects.h"
 
@@ -77,6 +80,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #include "io/fs/FileStream.h"
 #include "io/resource/PakReader.h"
 #include "io/fs/Filesystem.h"
+#include "io/fs/SystemPaths.h"
 #include "io/Blast.h"
 #include "io/Implode.h"
 #include "io/IO.h"
@@ -87,6 +91,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #include "scene/Scene.h"
 #include "scene/Light.h"
 #include "scene/Interactive.h"
+#include "scene/LevelLoader.h"
 
 #include "util/String.h"
 
@@ -323,7 +328,7 @@ EERIEPOLY * CheckInPoly(float x, float y, float z, float * needY)
 	rx = poss.x - ((float)px * ACTIVEBKG->Xdiv);
 	rz = poss.z - ((float)pz * ACTIVEBKG->Zdiv);
 
-	EERIEPOLY * ep;
+	const EERIE_COLLISION_POLY * ep;
 	FAST_BKG_DATA * feg;
 	EERIEPOLY * found = NULL;
 
@@ -390,14 +395,14 @@ EERIEPOLY * CheckInPoly(float x, float y, float z, float * needY)
 
 			for (k = 0; k < feg->nbpolyin; k++)
 			{
-				ep = feg->polyin[k];
+				ep = feg->collin[k];
 
 				if (
 					(poss.x >= ep->min.x) && (poss.x <= ep->max.x)
 					&&	(poss.z >= ep->min.z) && (poss.z <= ep->max.z)
 					&& !(ep->type & (POLY_WATER | POLY_TRANS | POLY_NOCOL))
 					&& (ep->max.y >= poss.y)
-					&&	(ep != found)
+					&&	(ep->poly != found)
 					&&	(PointIn2DPolyXZ(ep, poss.x, poss.z))
 				)
 				{
@@ -406,7 +411,7 @@ EERIEPOLY * CheckInPoly(float x, float y, float z, float * needY)
 							&&	((found == NULL) || ((found != NULL) && (rz <= foundY)))
 					   )
 					{
-						found = ep;
+						found = ep->poly;
 						foundY = rz;
 					}
 				}
@@ -435,7 +440,7 @@ EERIEPOLY * CheckInPolyPrecis(float x, float y, float z, float * needY)
 	rx = poss.x - ((float)px * ACTIVEBKG->Xdiv);
 	rz = poss.z - ((float)pz * ACTIVEBKG->Zdiv);
 
-	EERIEPOLY * ep;
+	const EERIE_COLLISION_POLY * ep;
 	FAST_BKG_DATA * feg;
 	EERIEPOLY * found = NULL;
 
@@ -501,14 +506,14 @@ EERIEPOLY * CheckInPolyPrecis(float x, float y, float z, float * needY)
 
 			for (k = 0; k < feg->nbpolyin; k++)
 			{
-				ep = feg->polyin[k];
+				ep = feg->collin[k];
 
 				if (
 					(poss.x >= ep->min.x) && (poss.x <= ep->max.x)
 					&&	(poss.z >= ep->min.z) && (poss.z <= ep->max.z)
 					&& !(ep->type & (POLY_WATER | POLY_TRANS | POLY_NOCOL))
 					&& (ep->max.y >= poss.y)
-					&&	(ep != found)
+					&&	(ep->poly != found)
 					&&	(PointIn2DPolyXZ(ep, poss.x, poss.z))
 				)
 				{
@@ -517,7 +522,7 @@ EERIEPOLY * CheckInPolyPrecis(float x, float y, float z, float * needY)
 							&&	((found == NULL) || ((found != NULL) && (rz <= foundY)))
 					   )
 					{
-						found = ep;
+						found = ep->poly;
 						foundY = rz;
 					}
 				}
@@ -555,10 +560,10 @@ EERIEPOLY * CheckTopPoly(float x, float y, float z) {
 		return NULL;
 	}
 	
-	EERIEPOLY * found = NULL;
+	const EERIE_COLLISION_POLY * found = NULL;
 	for (long k = 0; k < feg->nbpolyin; k++) {
 		
-		EERIEPOLY * ep = feg->polyin[k];
+		const EERIE_COLLISION_POLY * ep = feg->collin[k];
 		
 		if((!(ep->type & (POLY_WATER | POLY_TRANS | POLY_NOCOL)))
 		   && (ep->min.y < y)
@@ -570,7 +575,7 @@ EERIEPOLY * CheckTopPoly(float x, float y, float z) {
 				continue;
 			}
 			
-			if(ep->tex != NULL) {
+			if(ep->poly->tex != NULL) {
 				if(found == NULL || ep->min.y > found->min.y) {
 					found = ep;
 				}
@@ -578,7 +583,7 @@ EERIEPOLY * CheckTopPoly(float x, float y, float z) {
 		}
 	}
 	
-	return found;
+	return found ? found->poly : NULL;
 }
 
 bool IsAnyPolyThere(float x, float z) {
@@ -590,7 +595,7 @@ bool IsAnyPolyThere(float x, float z) {
 	
 	for(long k = 0; k < feg->nbpolyin; k++) {
 		
-		EERIEPOLY * ep = feg->polyin[k];
+		const EERIE_COLLISION_POLY * ep = feg->collin[k];
 		
 		if(PointIn2DPolyXZ(ep, x, z)) {
 			return true;
@@ -622,7 +627,7 @@ EERIEPOLY * GetMinPoly(float x, float y, float z) {
 	float foundy = 0.0f;
 	for (long k = 0; k < feg->nbpolyin; k++) {
 		
-		EERIEPOLY * ep = feg->polyin[k];
+		const EERIE_COLLISION_POLY * ep = feg->collin[k];
 		
 		if(ep->type & POLY_WATER) continue;
 		
@@ -634,7 +639,7 @@ EERIEPOLY * GetMinPoly(float x, float y, float z) {
 			float ret;
 			if(GetTruePolyY(ep, &pos, &ret)) {
 				if(!found || ret > foundy) {
-					found = ep;
+					found = ep->poly;
 					foundy = ret;
 				}
 			}
@@ -657,7 +662,7 @@ EERIEPOLY * GetMaxPoly(float x, float y, float z) {
 	float foundy = 0.0f;
 	for(long k = 0; k < feg->nbpolyin; k++) {
 		
-		EERIEPOLY * ep = feg->polyin[k];
+		const EERIE_COLLISION_POLY * ep = feg->collin[k];
 		
 		if(ep->type & POLY_WATER) continue;
 		
@@ -669,7 +674,7 @@ EERIEPOLY * GetMaxPoly(float x, float y, float z) {
 			float ret;
 			if(GetTruePolyY(ep, &pos, &ret)) {
 				if(!found || ret < foundy) {
-					found = ep;
+					found = ep->poly;
 					foundy = ret;
 				}
 			}
@@ -686,10 +691,10 @@ EERIEPOLY * EEIsUnderWater(const Vec3f * pos) {
 		return NULL;
 	}
 	
-	EERIEPOLY * found = NULL;
+	const EERIE_COLLISION_POLY * found = NULL;
 	for(short k = 0; k < feg->nbpolyin; k++) {
 		
-		EERIEPOLY * ep = feg->polyin[k];
+		const EERIE_COLLISION_POLY * ep = feg->collin[k];
 		
 		if(ep->type & POLY_WATER) {
 			if(ep->max.y < pos->y && PointIn2DPolyXZ(ep, pos->x, pos->z)) {
@@ -699,14 +704,24 @@ EERIEPOLY * EEIsUnderWater(const Vec3f * pos) {
 			}
 		}
 	}
-	return found;
+	return found ? found->poly : NULL;
 }
 
-bool GetTruePolyY(const EERIEPOLY * ep, const Vec3f * pos, float * ret) {
+static inline const Vec3f & getPolyVertex(const EERIEPOLY * ep, long i) {
+	return ep->v[i].p;
+}
+
+static inline const Vec3f & getPolyVertex(const EERIE_COLLISION_POLY * ep, long i) {
+	return ep->v[i];
+}
+
+template <class Poly>
+static bool getTruePolyY(const Poly * ep, const Vec3f * pos, float * ret) {
 	
+	const Vec3f & v0 = getPolyVertex(ep, 0);
 	
-	Vec3f s21 = ep->v[1].p - ep->v[0].p;
-	Vec3f s31 = ep->v[2].p - ep->v[0].p;
+	Vec3f s21 = getPolyVertex(ep, 1) - v0;
+	Vec3f s31 = getPolyVertex(ep, 2) - v0;
 	
 	Vec3f n;
 	n.y = (s21.z * s31.x) - (s21.x * s31.z);
@@ -715,7 +730,7 @@ bool GetTruePolyY(const EERIEPOLY * ep, const Vec3f * pos, float * ret) {
 	n.z = (s21.x * s31.y) - (s21.y * s31.x);
 	
 	// uses s21.x instead of d
-	s21.x = ep->v[0].p.x * n.x + ep->v[0].p.y * n.y + ep->v[0].p.z * n.z;
+	s21.x = v0.x * n.x + v0.y * n.y + v0.z * n.z;
 	
 	s21.x = (s21.x - (n.x * pos->x) - (n.z * pos->z)) / n.y;
 	
@@ -727,6 +742,14 @@ bool GetTruePolyY(const EERIEPOLY * ep, const Vec3f * pos, float * ret) {
 	return true;
 }
 
+bool GetTruePolyY(const EERIEPOLY * ep, const Vec3f * pos, float * ret) {
+	return getTruePolyY(ep, pos, ret);
+}
+
+bool GetTruePolyY(const EERIE_COLLISION_POLY * ep, const Vec3f * pos, float * ret) {
+	return getTruePolyY(ep, pos, ret);
+}
+
 //*************************************************************************************
 //*************************************************************************************
 EERIE_BACKGROUND * ACTIVEBKG = NULL;
@@ -1149,30 +1172,43 @@ float CEDRIC_PtIn2DPolyProjV2(EERIE_3DOBJ * obj, EERIE_FACE * ef, float x, float
 	else return 0.f;
 }
 
-int PointIn2DPolyXZ(const EERIEPOLY * ep, float x, float z) {
+template <class Poly>
+static int pointIn2DPolyXZ(const Poly * ep, float x, float z) {
 	
 	int i, j, c = 0, d = 0;
 
 	for (i = 0, j = 2; i < 3; j = i++)
 	{
-		if ((((ep->v[i].p.z <= z) && (z < ep->v[j].p.z)) ||
-				((ep->v[j].p.z <= z) && (z < ep->v[i].p.z))) &&
-				(x < (ep->v[j].p.x - ep->v[i].p.x) *(z - ep->v[i].p.z) / (ep->v[j].p.z - ep->v[i].p.z) + ep->v[i].p.x))
+		const Vec3f & vi = getPolyVertex(ep, i);
+		const Vec3f & vj = getPolyVertex(ep, j);
+		if ((((vi.z <= z) && (z < vj.z)) ||
+				((vj.z <= z) && (z < vi.z))) &&
+				(x < (vj.x - vi.x) *(z - vi.z) / (vj.z - vi.z) + vi.x))
 			c = !c;
 	}
 
 	if (ep->type & POLY_QUAD)
 		for (i = 1, j = 3; i < 4; j = i++)
 		{
-			if ((((ep->v[i].p.z <= z) && (z < ep->v[j].p.z)) ||
-					((ep->v[j].p.z <= z) && (z < ep->v[i].p.z))) &&
-					(x < (ep->v[j].p.x - ep->v[i].p.x) *(z - ep->v[i].p.z) / (ep->v[j].p.z - ep->v[i].p.z) + ep->v[i].p.x))
+			const Vec3f & vi = getPolyVertex(ep, i);
+			const Vec3f & vj = getPolyVertex(ep, j);
+			if ((((vi.z <= z) && (z < vj.z)) ||
+					((vj.z <= z) && (z < vi.z))) &&
+					(x < (vj.x - vi.x) *(z - vi.z) / (vj.z - vi.z) + vi.x))
 				d = !d;
 		}
 
 	return c + d;
 }
 
+int PointIn2DPolyXZ(const EERIEPOLY * ep, float x, float z) {
+	return pointIn2DPolyXZ(ep, x, z);
+}
+
+int PointIn2DPolyXZ(const EERIE_COLLISION_POLY * ep, float x, float z) {
+	return pointIn2DPolyXZ(ep, x, z);
+}
+
 //*************************************************************************************
 // Sets the target of a camera...
 //*************************************************************************************
@@ -1544,6 +1580,8 @@ long BKG_CountIgnoredPolys(EERIE_BACKGROUND * eb)
 void ReleaseBKG_INFO(EERIE_BKG_INFO * eg) {
 	free(eg->polydata), eg->polydata = NULL;
 	free(eg->polyin), eg->polyin = NULL;
+	free(eg->colldata), eg->colldata = NULL;
+	free(eg->collin), eg->collin = NULL;
 	eg->nbpolyin = 0;
 	memset(eg, 0, sizeof(EERIE_BKG_INFO));
 }
@@ -1710,6 +1748,7 @@ int InitBkg(EERIE_BACKGROUND * eb, short sx, short sz, short Xdiv, short Zdiv) {
 
 	eb->exist = 1;
 	eb->anchors = NULL;
+	eb->anchorTree = NULL;
 	eb->nbanchors = 0;
 	eb->Xsize = sx;
 	eb->Zsize = sz;
@@ -1885,10 +1924,71 @@ void EERIEPOLY_Compute_PolyIn()
 			else eg->nothing = 1;
 		}
 
-	for (int j = 0; j < ACTIVEBKG->Zsize; j++)
-		for (long i = 0; i < ACTIVEBKG->Xsize; i++)
-		{
-			eg = &ACTIVEBKG->Backg[i+j*ACTIVEBKG->Xsize];
+	ComputeFastBkgData(ACTIVEBKG);
+}
+
+static void ComputeCollisionData(EERIE_BACKGROUND * eb) {
+	
+	typedef boost::unordered_map<const EERIEPOLY *, EERIE_COLLISION_POLY *> CollisionMap;
+	CollisionMap polys;
+	
+	for(long i = 0; i < eb->Xsize * eb->Zsize; i++) {
+		
+		EERIE_BKG_INFO * eg = &eb->Backg[i];
+		
+		free(eg->colldata), eg->colldata = NULL;
+		if(eg->nbpoly <= 0) {
+			continue;
+		}
+		
+		eg->colldata = (EERIE_COLLISION_POLY *)malloc(sizeof(EERIE_COLLISION_POLY) * eg->nbpoly);
+		for(long k = 0; k < eg->nbpoly; k++) {
+			
+			EERIEPOLY * ep = &eg->polydata[k];
+			EERIE_COLLISION_POLY * cp = &eg->colldata[k];
+			
+			for(size_t n = 0; n < 4; n++) {
+				cp->v[n] = ep->v[n].p;
+			}
+			cp->min = ep->min;
+			cp->max = ep->max;
+			cp->center = ep->center;
+			cp->area = ep->area;
+			cp->normy = ep->norm.y;
+			cp->norm2y = ep->norm2.y;
+			cp->type = ep->type;
+			cp->poly = ep;
+			
+			polys[ep] = cp;
+		}
+	}
+	
+	for(long i = 0; i < eb->Xsize * eb->Zsize; i++) {
+		
+		EERIE_BKG_INFO * eg = &eb->Backg[i];
+		
+		free(eg->collin), eg->collin = NULL;
+		if(eg->nbpolyin <= 0) {
+			continue;
+		}
+		
+		eg->collin = (EERIE_COLLISION_POLY **)malloc(sizeof(EERIE_COLLISION_POLY *) * eg->nbpolyin);
+		for(long k = 0; k < eg->nbpolyin; k++) {
+			CollisionMap::const_iterator it = polys.find(eg->polyin[k]);
+			arx_assert(it != polys.end());
+			eg->collin[k] = it->second;
+		}
+	}
+}
+
+void ComputeFastBkgData(EERIE_BACKGROUND * eb) {
+	
+	ComputeCollisionData(eb);
+	
+	for(long j = 0; j < eb->Zsize; j++) {
+		for(long i = 0; i < eb->Xsize; i++) {
+			
+			EERIE_BKG_INFO * eg = &eb->Backg[i + j * eb->Xsize];
 			eg->tile_miny = 999999999.f;
 			eg->tile_maxy = -999999999.f;
 
@@ -1899,7 +1999,7 @@ void EERIEPOLY_Compute_PolyIn()
 				eg->tile_maxy = max(eg->tile_maxy, ep->max.y);
 			}
 
-			FAST_BKG_DATA * fbd = &ACTIVEBKG->fastdata[i][j];
+			FAST_BKG_DATA * fbd = &eb->fastdata[i][j];
 			fbd->treat = eg->treat;
 			fbd->nothing = eg->nothing;
 			fbd->nbpoly = eg->nbpoly;
@@ -1910,7 +2010,10 @@ void EERIEPOLY_Compute_PolyIn()
 			fbd->polydata = eg->polydata;
 			fbd->polyin = eg->polyin;
 			fbd->ianchors = eg->ianchors;
+			fbd->colldata = eg->colldata;
+			fbd->collin = eg->collin;
 		}
+	}
 }
 
 float GetTileMinY(long i, long j)
@@ -2496,19 +2599,506 @@ public:
 	
 };
 
+fs::path getSceneCacheFile(const res::path & partial_path) {
+	
+	if(fs::paths.user.empty()) {
+		return fs::path();
+	}
+	
+	std::string name = partial_path.string();
+	std::replace(name.begin(), name.end(), '/', '_');
+	
+	return fs::paths.user / "cache" / "levels" / (name + ".scene");
+}
+
+namespace {
+
+size_t getTextureIndex(std::vector<TextureContainer *> & textures, TextureContainer * tex) {
+	
+	std::vector<TextureContainer *>::const_iterator it;
+	it = std::find(textures.begin(), textures.end(), tex);
+	if(it != textures.end()) {
+		return it - textures.begin();
+	}
+	
+	textures.push_back(tex);
+	return textures.size() - 1;
+}
+
+/*!
+ * Store the prepared scene data so that loadSceneCache() can restore it
+ * without going through loadFastScene() again.
+ */
+void saveSceneCache(const fs::path & file, u32 hash, u32 size) {
+	
+	const EERIE_BACKGROUND * eb = ACTIVEBKG;
+	
+	SCENE_CACHE_HEADER header;
+	std::copy(SCENE_CACHE_MAGIC, SCENE_CACHE_MAGIC + 4, header.magic);
+	header.version = SCENE_CACHE_VERSION;
+	header.source_hash = hash;
+	header.source_size = size;
+	header.poly_size = sizeof(EERIEPOLY);
+	header.portal_size = sizeof(EERIE_PORTALS);
+	header.pointer_size = sizeof(void *);
+	header.sizex = eb->Xsize;
+	header.sizez = eb->Zsize;
+	header.playerpos = player.pos;
+	header.Mscenepos = Mscenepos;
+	header.nb_anchors = eb->nbanchors;
+	header.nb_rooms = portals ? portals->nb_rooms : -1;
+	header.nb_portals = portals ? portals->nb_total : 0;
+	header.nb_room_distances = NbRoomDistance;
+	
+	// Collect textures and polygon locations
+	std::vector<TextureContainer *> textures;
+	typedef boost::unordered_map<const EERIEPOLY *, SCENE_CACHE_POLY_REF> PolyRefs;
+	PolyRefs polyRefs;
+	for(long j = 0; j < eb->Zsize; j++) {
+		for(long i = 0; i < eb->Xsize; i++) {
+			const EERIE_BKG_INFO & bkg = eb->Backg[i + j * eb->Xsize];
+			for(long k = 0; k < bkg.nbpoly; k++) {
+				if(bkg.polydata[k].tex) {
+					getTextureIndex(textures, bkg.polydata[k].tex);
+				}
+				SCENE_CACHE_POLY_REF & ref = polyRefs[&bkg.polydata[k]];
+				ref.tilex = s16(i), ref.tilez = s16(j), ref.poly = s32(k);
+			}
+		}
+	}
+	header.nb_textures = textures.size();
+	
+	std::vector<char> buffer;
+	buffer.reserve(polyRefs.size() * (sizeof(EERIEPOLY) + sizeof(s32)));
+	
+	#define SCENE_CACHE_WRITE(ptr, n) \
+		buffer.insert(buffer.end(), reinterpret_cast<const char *>(ptr), \
+		              reinterpret_cast<const char *>(ptr) + sizeof(*(ptr)) * (n))
+	
+	SCENE_CACHE_WRITE(&header, 1);
+	
+	for(size_t k = 0; k < textures.size(); k++) {
+		const std::string & name = textures[k]->m_texName.string();
+		SCENE_CACHE_TEXTURE texture;
+		if(name.length() >= sizeof(texture.name)) {
+			LogWarning << "Not caching level: texture name too long: " << name;
+			return;
+		}
+		memset(texture.name, 0, sizeof(texture.name));
+		std::copy(name.begin(), name.end(), texture.name);
+		SCENE_CACHE_WRITE(&texture, 1);
+	}
+	
+	for(long j = 0; j < eb->Zsize; j++) {
+		for(long i = 0; i < eb->Xsize; i++) {
+			
+			const EERIE_BKG_INFO & bkg = eb->Backg[i + j * eb->Xsize];
+			
+			SCENE_CACHE_TILE tile;
+			tile.treat = bkg.treat;
+			tile.nothing = bkg.nothing;
+			tile.nbpoly = bkg.nbpoly;
+			tile.nbianchors = bkg.nbianchors;
+			tile.nbpolyin = bkg.nbpolyin;
+			tile.frustrum_miny = bkg.frustrum_miny;
+			tile.frustrum_maxy = bkg.frustrum_maxy;
+			tile.tile_miny = bkg.tile_miny;
+			tile.tile_maxy = bkg.tile_maxy;
+			tile.flags = bkg.flags;
+			SCENE_CACHE_WRITE(&tile, 1);
+			
+			for(long k = 0; k < bkg.nbpoly; k++) {
+				EERIEPOLY ep = bkg.polydata[k];
+				ep.tex = NULL;
+				SCENE_CACHE_WRITE(&ep, 1);
+			}
+			for(long k = 0; k < bkg.nbpoly; k++) {
+				TextureContainer * tex = bkg.polydata[k].tex;
+				s32 index = tex ? s32(getTextureIndex(textures, tex)) : -1;
+				SCENE_CACHE_WRITE(&index, 1);
+			}
+			
+			for(long k = 0; k < bkg.nbianchors; k++) {
+				s32 anchor = bkg.ianchors[k];
+				SCENE_CACHE_WRITE(&anchor, 1);
+			}
+			
+			for(long k = 0; k < bkg.nbpolyin; k++) {
+				PolyRefs::const_iterator it = polyRefs.find(bkg.polyin[k]);
+				if(it == polyRefs.end()) {
+					LogWarning << "Not caching level: polygon not in any tile";
+					return;
+				}
+				SCENE_CACHE_WRITE(&it->second, 1);
+			}
+		}
+	}
+	
+	for(long i = 0; i < eb->nbanchors; i++) {
+		
+		const ANCHOR_DATA & anchor = eb->anchors[i];
+		
+		SCENE_CACHE_ANCHOR sca;
+		sca.pos = anchor.pos;
+		sca.radius = anchor.radius;
+		sca.height = anchor.height;
+		sca.nb_linked = anchor.nblinked;
+		sca.padding = 0;
+		sca.flags = anchor.flags;
+		SCENE_CACHE_WRITE(&sca, 1);
+		
+		for(long k = 0; k < anchor.nblinked; k++) {
+			s32 link = anchor.linked[k];
+			SCENE_CACHE_WRITE(&link, 1);
+		}
+	}
+	
+	if(portals) {
+		
+		for(long i = 0; i < portals->nb_total; i++) {
+			EERIE_PORTALS portal = portals->portals[i];
+			portal.poly.tex = NULL;
+			SCENE_CACHE_WRITE(&portal, 1);
+		}
+		
+		for(long i = 0; i < portals->nb_rooms + 1; i++) {
+			
+			const EERIE_ROOM_DATA & room = portals->room[i];
+			
+			SCENE_CACHE_ROOM scr;
+			scr.nb_portals = room.nb_portals;
+			scr.nb_polys = room.nb_polys;
+			SCENE_CACHE_WRITE(&scr, 1);
+			
+			for(long k = 0; k < room.nb_portals; k++) {
+				s32 portal = room.portals[k];
+				SCENE_CACHE_WRITE(&portal, 1);
+			}
+			SCENE_CACHE_WRITE(room.epdata, room.nb_polys);
+		}
+	}
+	
+	SCENE_CACHE_WRITE(RoomDistance, NbRoomDistance * NbRoomDistance);
+	
+	#undef SCENE_CACHE_WRITE
+	
+	if(!fs::create_directories(file.parent())) {
+		LogWarning << "Could not create level cache directory " << file.parent();
+		return;
+	}
+	
+	fs::ofstream ofs(file, fs::fstream::out | fs::fstream::binary | fs::fstream::trunc);
+	if(!ofs.is_open() || !ofs.write(&buffer[0], buffer.size())) {
+		LogWarning << "Could not write level cache " << file;
+		ofs.close();
+		fs::remove(file);
+		return;
+	}
+	
+	LogDebug("FTS: cached scene data in " << file << " (" << buffer.size() << " bytes)");
+}
+
+bool loadSceneCacheData(const SCENE_CACHE_HEADER * header, const char * data,
+                        const char * end) {
+	
+	EERIE_BACKGROUND * eb = ACTIVEBKG;
+	
+	player.pos = header->playerpos;
+	Mscenepos = header->Mscenepos;
+	
+	// Load textures
+	std::vector<TextureContainer *> textures(header->nb_textures);
+	const SCENE_CACHE_TEXTURE * sct;
+	sct = fts_read<SCENE_CACHE_TEXTURE>(data, end, header->nb_textures);
+	for(long k = 0; k < header->nb_textures; k++) {
+		res::path file = res::path::load(util::loadString(sct[k].name));
+		textures[k] = TextureContainer::Load(file, TextureContainer::Level);
+	}
+	
+	// Load tiles, references to polygons in other tiles are resolved afterwards
+	std::vector<const SCENE_CACHE_POLY_REF *> polyRefs(eb->Xsize * eb->Zsize);
+	for(long j = 0; j < eb->Zsize; j++) {
+		for(long i = 0; i < eb->Xsize; i++) {
+			
+			const SCENE_CACHE_TILE * tile = fts_read<SCENE_CACHE_TILE>(data, end);
+			
+			EERIE_BKG_INFO & bkg = eb->Backg[i + j * eb->Xsize];
+			bkg.treat = tile->treat;
+			bkg.nothing = tile->nothing;
+			bkg.frustrum_miny = tile->frustrum_miny;
+			bkg.frustrum_maxy = tile->frustrum_maxy;
+			bkg.tile_miny = tile->tile_miny;
+			bkg.tile_maxy = tile->tile_maxy;
+			bkg.flags = tile->flags;
+			
+			if(tile->nbpoly > 0) {
+				const char * polys = data;
+				(void)fts_read<EERIEPOLY>(data, end, tile->nbpoly);
+				bkg.polydata = (EERIEPOLY *)malloc(sizeof(EERIEPOLY) * tile->nbpoly);
+				memcpy((void *)bkg.polydata, polys, sizeof(EERIEPOLY) * tile->nbpoly);
+				bkg.nbpoly = tile->nbpoly;
+				const s32 * tex = fts_read<s32>(data, end, tile->nbpoly);
+				for(long k = 0; k < tile->nbpoly; k++) {
+					bool valid = (tex[k] >= 0 && tex[k] < header->nb_textures);
+					bkg.polydata[k].tex = valid ? textures[tex[k]] : NULL;
+				}
+			}
+			
+			if(tile->nbianchors > 0) {
+				const s32 * anchors = fts_read<s32>(data, end, tile->nbianchors);
+				for(long k = 0; k < tile->nbianchors; k++) {
+					if(anchors[k] < 0 || anchors[k] >= header->nb_anchors) {
+						return false;
+					}
+				}
+				bkg.ianchors = (long *)malloc(sizeof(long) * tile->nbianchors);
+				std::copy(anchors, anchors + tile->nbianchors, bkg.ianchors);
+				bkg.nbianchors = tile->nbianchors;
+			}
+			
+			if(tile->nbpolyin > 0) {
+				polyRefs[i + j * eb->Xsize] = fts_read<SCENE_CACHE_POLY_REF>(data, end,
+				                                                              tile->nbpolyin);
+				bkg.polyin = (EERIEPOLY **)malloc(sizeof(EERIEPOLY *) * tile->nbpolyin);
+				bkg.nbpolyin = tile->nbpolyin;
+			}
+		}
+	}
+	for(long i = 0; i < eb->Xsize * eb->Zsize; i++) {
+		EERIE_BKG_INFO & bkg = eb->Backg[i];
+		for(long k = 0; k < bkg.nbpolyin; k++) {
+			const SCENE_CACHE_POLY_REF & ref = polyRefs[i][k];
+			if(ref.tilex < 0 || ref.tilex >= eb->Xsize || ref.tilez < 0 || ref.tilez >= eb->Zsize) {
+				return false;
+			}
+			EERIE_BKG_INFO & other = eb->Backg[ref.tilex + ref.tilez * eb->Xsize];
+			if(ref.poly < 0 || ref.poly >= other.nbpoly) {
+				return false;
+			}
+			bkg.polyin[k] = &other.polydata[ref.poly];
+		}
+	}
+	
+	// Load anchors
+	if(header->nb_anchors > 0) {
+		size_t anchorsize = sizeof(ANCHOR_DATA) * header->nb_anchors;
+		eb->anchors = (ANCHOR_DATA *)malloc(anchorsize);
+		memset((void *)eb->anchors, 0, anchorsize);
+		eb->nbanchors = header->nb_anchors;
+	}
+	for(long i = 0; i < header->nb_anchors; i++) {
+		
+		const SCENE_CACHE_ANCHOR * sca = fts_read<SCENE_CACHE_ANCHOR>(data, end);
+		
+		ANCHOR_DATA & anchor = eb->anchors[i];
+		anchor.flags = AnchorFlags::load(sca->flags);
+		anchor.pos = sca->pos;
+		anchor.height = sca->height;
+		anchor.radius = sca->radius;
+		
+		if(sca->nb_linked > 0) {
+			const s32 * links = fts_read<s32>(data, end, sca->nb_linked);
+			for(long k = 0; k < sca->nb_linked; k++) {
+				if(links[k] < 0 || links[k] >= header->nb_anchors) {
+					return false;
+				}
+			}
+			anchor.linked = (long *)malloc(sizeof(long) * sca->nb_linked);
+			std::copy(links, links + sca->nb_linked, anchor.linked);
+			anchor.nblinked = sca->nb_linked;
+		}
+	}
+	AnchorData_CreateTree(eb);
+	
+	// Load rooms and portals
+	if(header->nb_rooms < 0) {
+		USE_PORTALS = 0;
+	} else {
+		
+		if(header->nb_portals < 0) {
+			return false;
+		}
+		
+		EERIE_PORTAL_Release();
+		
+		portals = (EERIE_PORTAL_DATA *)malloc(sizeof(EERIE_PORTAL_DATA));
+		portals->nb_rooms = header->nb_rooms;
+		size_t roomsize = sizeof(EERIE_ROOM_DATA) * (portals->nb_rooms + 1);
+		portals->room = (EERIE_ROOM_DATA *)malloc(roomsize);
+		memset((void *)portals->room, 0, roomsize);
+		portals->nb_total = 0;
+		portals->portals = (EERIE_PORTALS *)malloc(sizeof(EERIE_PORTALS) * header->nb_portals);
+		
+		const char * portaldata = data;
+		(void)fts_read<EERIE_PORTALS>(data, end, header->nb_portals);
+		memcpy((void *)portals->portals, portaldata, sizeof(EERIE_PORTALS) * header->nb_portals);
+		portals->nb_total = header->nb_portals;
+		for(long i = 0; i < portals->nb_total; i++) {
+			const EERIE_PORTALS & portal = portals->portals[i];
+			if(portal.room_1 < 0 || portal.room_1 > portals->nb_rooms
+			   || portal.room_2 < 0 || portal.room_2 > portals->nb_rooms) {
+				return false;
+			}
+		}
+		
+		for(long i = 0; i < portals->nb_rooms + 1; i++) {
+			
+			const SCENE_CACHE_ROOM * scr = fts_read<SCENE_CACHE_ROOM>(data, end);
+			
+			EERIE_ROOM_DATA & room = portals->room[i];
+			
+			if(scr->nb_portals > 0) {
+				const s32 * start = fts_read<s32>(data, end, scr->nb_portals);
+				for(long k = 0; k < scr->nb_portals; k++) {
+					if(start[k] < 0 || start[k] >= portals->nb_total) {
+						return false;
+					}
+				}
+				room.portals = (long *)malloc(sizeof(long) * scr->nb_portals);
+				std::copy(start, start + scr->nb_portals, room.portals);
+				room.nb_portals = scr->nb_portals;
+			}
+			
+			if(scr->nb_polys > 0) {
+				const EP_DATA * epdata = fts_read<EP_DATA>(data, end, scr->nb_polys);
+				for(long k = 0; k < scr->nb_polys; k++) {
+					const EP_DATA & ep = epdata[k];
+					if(ep.px < 0 || ep.px >= eb->Xsize || ep.py < 0 || ep.py >= eb->Zsize
+					   || ep.idx < 0 || ep.idx >= eb->Backg[ep.px + ep.py * eb->Xsize].nbpoly) {
+						return false;
+					}
+				}
+				room.epdata = (EP_DATA *)malloc(sizeof(EP_DATA) * scr->nb_polys);
+				std::copy(epdata, epdata + scr->nb_polys, room.epdata);
+				room.nb_polys = scr->nb_polys;
+			}
+		}
+		
+		USE_PORTALS = 4;
+	}
+	
+	// Load distances between rooms
+	free(RoomDistance), RoomDistance = NULL;
+	NbRoomDistance = 0;
+	if(header->nb_room_distances > 0) {
+		if(header->nb_room_distances != header->nb_rooms + 1) {
+			return false;
+		}
+		size_t count = size_t(header->nb_room_distances) * header->nb_room_distances;
+		const char * distances = data;
+		(void)fts_read<ROOM_DIST_DATA>(data, end, count);
+		RoomDistance = (ROOM_DIST_DATA *)malloc(sizeof(ROOM_DIST_DATA) * count);
+		memcpy((void *)RoomDistance, distances, sizeof(ROOM_DIST_DATA) * count);
+		NbRoomDistance = header->nb_room_distances;
+	}
+	
+	if(data != end) {
+		return false;
+	}
+	
+	// Rebuild the data that can't be cached
+	
+	ComputeFastBkgData(eb);
+	EERIE_PATHFINDER_Create();
+	ComputePortalVertexBuffer();
+	
+	return true;
+}
+
+//! Release everything allocated by an incomplete loadSceneCacheData() call
+void releaseSceneCacheData() {
+	
+	EERIE_BACKGROUND * eb = ACTIVEBKG;
+	
+	EERIE_PORTAL_Release();
+	USE_PORTALS = 0;
+	
+	AnchorData_ClearAll(eb);
+	
+	for(long i = 0; i < eb->Xsize * eb->Zsize; i++) {
+		ReleaseBKG_INFO(&eb->Backg[i]);
+	}
+	
+	free(RoomDistance), RoomDistance = NULL;
+	NbRoomDistance = 0;
+}
+
+/*!
+ * Restore the scene from a cache file written by saveSceneCache().
+ * The background must already be initialized using InitBkg().
+ * \param bytes contents of the cache file if it has already been read, or NULL
+ * \return false if there is no up-to-date cache. The background is then
+ *         reset, ready to be loaded from the original file.
+ */
+bool loadSceneCache(const fs::path & file, u32 hash, u32 size,
+                    boost::scoped_array<char> & bytes, size_t cacheSize) {
+	
+	if(!bytes) {
+		if(!fs::is_regular_file(file)) {
+			return false;
+		}
+		bytes.reset(fs::read_file(file, cacheSize));
+		if(!bytes) {
+			return false;
+		}
+	}
+	const char * data = bytes.get(), * end = bytes.get() + cacheSize;
+	
+	bool loaded = false;
+	try {
+		
+		const SCENE_CACHE_HEADER * header = fts_read<SCENE_CACHE_HEADER>(data, end);
+		if(!std::equal(SCENE_CACHE_MAGIC, SCENE_CACHE_MAGIC + 4, header->magic)
+		   || header->version != SCENE_CACHE_VERSION
+		   || header->source_hash != hash || header->source_size != size
+		   || header->poly_size != sizeof(EERIEPOLY)
+		   || header->portal_size != sizeof(EERIE_PORTALS)
+		   || header->pointer_size != sizeof(void *)
+		   || header->sizex != ACTIVEBKG->Xsize || header->sizez != ACTIVEBKG->Zsize) {
+			LogDebug("FTS: ignoring outdated level cache " << file);
+			return false;
+		}
+		
+		loaded = loadSceneCacheData(header, data, end);
+		
+	} catch(file_truncated_exception) {
+		loaded = false;
+	}
+	
+	if(!loaded) {
+		LogWarning << "Ignoring invalid level cache " << file;
+		releaseSceneCacheData();
+		InitBkg(ACTIVEBKG, MAX_BKGX, MAX_BKGZ, BKG_SIZX, BKG_SIZZ);
+		return false;
+	}
+	
+	LogDebug("FTS: loaded scene data from " << file);
+	return true;
+}
+
+} // anonymous namespace
+
 bool FastSceneLoad(const res::path & partial_path) {
 	
 	res::path file = "game" / partial_path / "fast.fts";
 	
 	const char * data = NULL, * end = NULL;
 	boost::scoped_array<char> bytes;
+	fs::path cacheFile;
+	u32 hash = 0, fileSize = 0;
+	
+	// Use the data read by the level loader thread if available
+	LevelFileData loaded;
+	bool isLoaded = ARX_LEVELLOADER_Take(file, loaded);
+	scoped_malloc<char> unpacked(loaded.unpacked);
+	boost::scoped_array<char> cache(loaded.cache);
 	
 	try {
 		
 		// Load the whole file
 		LogDebug("Loading " << file);
-		size_t size;
-		scoped_malloc<char> dat(resources->readAlloc(file, size));
+		size_t size = loaded.size;
+		scoped_malloc<char> dat(isLoaded ? loaded.data : resources->readAlloc(file, size));
 		data = dat.get(), end = dat.get() + size;
 		// TODO use new[] instead of malloc so we can use (boost::)unique_ptr
 		LogDebug("FTS: read " << size << " bytes");
@@ -2534,17 +3124,41 @@ bool FastSceneLoad(const res::path & partial_path) {
 		PROGRESS_BAR_COUNT += 1.f, LoadLevelScreen();
 		
 		
+		// Use the prepared scene data from a previous load if it is still valid
+		if(config.misc.levelCache) {
+			if(isLoaded) {
+				hash = loaded.crc;
+			} else {
+				boost::crc_32_type crc;
+				crc.process_bytes(dat.get(), size);
+				hash = crc.checksum();
+			}
+			fileSize = u32(size);
+			cacheFile = getSceneCacheFile(partial_path);
+			if(!cacheFile.empty()
+			   && loadSceneCache(cacheFile, hash, fileSize, cache, loaded.cacheSize)) {
+				PROGRESS_BAR_COUNT += 18.f, LoadLevelScreen();
+				return true;
+			}
+		}
+		
+		
 		// Decompress the actual scene data
-		size_t input_size = end - data;
-		LogDebug("FTS: decompressing " << input_size << " -> "
-		                               << uh->uncompressedsize);
-		bytes.reset(new char[uh->uncompressedsize]);
-		if(!bytes) {
-			LogError << "FTS: can't allocate buffer for uncompressed data";
-			return false;
+		if(unpacked.get()) {
+			size = loaded.unpackedSize;
+			data = unpacked.get(), end = unpacked.get() + size;
+		} else {
+			size_t input_size = end - data;
+			LogDebug("FTS: decompressing " << input_size << " -> "
+			                               << uh->uncompressedsize);
+			bytes.reset(new char[uh->uncompressedsize]);
+			if(!bytes) {
+				LogError << "FTS: can't allocate buffer for uncompressed data";
+				return false;
+			}
+			size = blastMem(data, input_size, bytes.get(), uh->uncompressedsize);
+			data = bytes.get(), end = bytes.get() + size;
 		}
-		size = blastMem(data, input_size, bytes.get(), uh->uncompressedsize);
-		data = bytes.get(), end = bytes.get() + size;
 		if(!size) {
 			LogError << "FTS: error decompressing scene data in " << file;
 			return false;
@@ -2561,11 +3175,19 @@ bool FastSceneLoad(const res::path & partial_path) {
 	}
 	
 	try {
-		return loadFastScene(file, data, end);
+		if(!loadFastScene(file, data, end)) {
+			return false;
+		}
 	} catch(file_truncated_exception) {
 		LogError << "FTS: truncated compressed data in " << file;
 		return false;
 	}
+	
+	if(!cacheFile.empty()) {
+		saveSceneCache(cacheFile, hash, fileSize);
+	}
+	
+	return true;
 }
 
 
@@ -2753,6 +3375,7 @@ static bool loadFastScene(const res::path & file, const char * data,
 			std::copy(links, links + fad->nb_linked, anchor.linked);
 		}
 	}
+	AnchorData_CreateTree(ACTIVEBKG);
 	PROGRESS_BAR_COUNT += 1.f, LoadLevelScreen();
 	
 	
@@ -142,6 +142,8 @@ struct EERIE_BKG_INFO
 	long				flags;
 	float				tile_miny;
 	float				tile_maxy;
+	EERIE_COLLISION_POLY * colldata; // parallel to polydata
+	EERIE_COLLISION_POLY ** collin; // parallel to polyin
 };
 
 struct EERIE_SMINMAX
@@ -166,6 +168,8 @@ struct FAST_BKG_DATA
 	EERIEPOLY *			polydata;
 	EERIEPOLY **		polyin;
 	long *				ianchors; // index on anchors list
+	EERIE_COLLISION_POLY * colldata; // parallel to polydata
+	EERIE_COLLISION_POLY ** collin; // parallel to polyin
 };
 #define MAX_BKGX	160
 #define MAX_BKGZ	160
@@ -173,6 +177,7 @@ struct FAST_BKG_DATA
 #define BKG_SIZZ	100
 
 struct ANCHOR_DATA;
+class AnchorTree;
 
 struct EERIE_BACKGROUND
 {
@@ -190,6 +195,7 @@ struct EERIE_BACKGROUND
 	EERIE_SMINMAX *	minmax;
 	long		  nbanchors;
 	ANCHOR_DATA * anchors;
+	AnchorTree * anchorTree;
 	char		name[256];
 };
 
@@ -241,6 +247,7 @@ EERIEPOLY * EEIsUnderWater(const Vec3f * pos);
 EERIEPOLY * EEIsUnderWaterFast(const Vec3f * pos);
 
 bool GetTruePolyY(const EERIEPOLY * ep, const Vec3f * pos,float * ret);
+bool GetTruePolyY(const EERIE_COLLISION_POLY * ep, const Vec3f * pos, float * ret);
 bool IsAnyPolyThere(float x, float z);
 bool IsVertexIdxInGroup(EERIE_3DOBJ * eobj,long idx,long grs);
 EERIEPOLY * GetMinPoly(float x, float y, float z);
@@ -248,6 +255,7 @@ EERIEPOLY * GetMaxPoly(float x, float y, float z);
  
 float GetColorz(float x, float y, float z);
 int PointIn2DPolyXZ(const EERIEPOLY * ep, float x, float z);
+int PointIn2DPolyXZ(const EERIE_COLLISION_POLY * ep, float x, float z);
 
 int EERIELaunchRay2(Vec3f * orgn, Vec3f * dest,  Vec3f * hit, EERIEPOLY * tp, long flag);
 int EERIELaunchRay3(Vec3f * orgn, Vec3f * dest,  Vec3f * hit, EERIEPOLY * tp, long flag);
@@ -270,6 +278,11 @@ long PhysicalDrawBkgVLine(Vec3f * orgn,Vec3f * dest);
 // FAST SAVE LOAD
 bool FastSceneLoad(const res::path & path);
 
+namespace fs { class path; }
+
+//! @return the file used to cache the prepared scene data of a level, or an empty path
+fs::path getSceneCacheFile(const res::path & path);
+
 //****************************************************************************
 // DRAWING FUNCTIONS START
 
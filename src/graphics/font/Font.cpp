@@ -23,6 +23,8 @@
 #include <iomanip>
 #include <iostream>
 #include <iterator>
+#include <algorithm>
+#include <limits>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -33,18 +35,70 @@
 #include "graphics/texture/TextureStage.h"
 
 #include "io/fs/FilePath.h"
+#include "io/fs/Filesystem.h"
+#include "io/fs/FileStream.h"
 #include "io/resource/ResourcePath.h"
 #include "io/log/Logger.h"
 
+#include "platform/Platform.h"
+
 #include "util/Unicode.h"
 
 using std::string;
+using std::vector;
+
+namespace {
+
+//! Fonts with queued glyphs
+vector<Font *> batchFonts;
+
+//! Nesting depth of Font::beginBatch() calls
+size_t batchDepth = 0;
+
+//! Shared index list for drawing glyph quads as triangle lists
+vector<unsigned short> quadIndices;
+
+//! Maximum number of quads that can be addressed with 16-bit indices
+const size_t MAX_BATCH_QUADS = (size_t(std::numeric_limits<unsigned short>::max()) + 1) / 4;
+
+const char GLYPH_CACHE_MAGIC[4] = { 'A', 'X', 'G', 'C' };
+const u32 GLYPH_CACHE_VERSION = 1;
+
+#pragma pack(push,1)
+
+struct GLYPH_CACHE_HEADER {
+	char magic[4];
+	u32 version;
+	u32 fontSize;
+	u32 nglyphs;
+};
+
+//! Followed by size_x * size_y bytes of A8 image data
+struct GLYPH_CACHE_ENTRY {
+	u32 character;
+	u32 index;
+	s32 size_x;
+	s32 size_y;
+	s32 draw_offset_x;
+	s32 draw_offset_y;
+	f32 advance_x;
+	f32 advance_y;
+	s32 lsb_delta;
+	s32 rsb_delta;
+};
 
-Font::Font(const res::path & fontFile, unsigned int fontSize, FT_Face face) 
+#pragma pack(pop)
+
+} // anonymous namespace
+
+Font::Font(const res::path & fontFile, unsigned int fontSize, FT_Face face,
+           const fs::path & cacheFile)
 	: info(fontFile, fontSize)
 	, referenceCount(0)
 	, face(face)
-	, textures(0) {
+	, textures(0)
+	, cacheFile(cacheFile)
+	, cacheDirty(false) {
 	
 	// TODO-font: Compute optimal size using m_FTFace->bbox
 	const unsigned int TEXTURE_SIZE = 512;
@@ -52,13 +106,20 @@ Font::Font(const res::path & fontFile, unsigned int fontSize, FT_Face face)
 	// Insert all the glyphs into texture pages
 	textures = new PackedTexture(TEXTURE_SIZE, Image::Format_A8);
 	
+	// Glyphs used in previous sessions, including any non-ASCII ones
+	loadGlyphCache();
+	
 	// Insert the replacement characters first as they may be needed if others are missing
-	insertGlyph('?');
-	insertGlyph(util::REPLACEMENT_CHAR);
+	if(glyphs.find('?') == glyphs.end()) {
+		insertGlyph('?');
+	}
+	if(glyphs.find(util::REPLACEMENT_CHAR) == glyphs.end()) {
+		insertGlyph(util::REPLACEMENT_CHAR);
+	}
 	
 	// Pre-load glyphs for displayable ASCII characters
 	for(Char chr = 32; chr < 127; ++chr) {
-		if(chr != '?') {
+		if(glyphs.find(chr) == glyphs.end()) {
 			insertGlyph(chr);
 		}
 	}
@@ -68,6 +129,11 @@ Font::Font(const res::path & fontFile, unsigned int fontSize, FT_Face face)
 
 Font::~Font() {
 	
+	vector<Font *>::iterator it = std::find(batchFonts.begin(), batchFonts.end(), this);
+	if(it != batchFonts.end()) {
+		batchFonts.erase(it);
+	}
+	
 	delete textures;
 	
 	// Release FreeType face object.
@@ -158,8 +224,7 @@ bool Font::insertGlyph(Char character) {
 		unsigned char * dst = imgGlyph.GetData();
 		memcpy(dst, src, glyph.size.x * glyph.size.y);
 		
-		Vec2i offset;
-		if(!textures->insertImage(imgGlyph, glyph.texture, offset)) {
+		if(!insertGlyphImage(glyph, imgGlyph)) {
 			std::ostringstream oss;
 			util::writeUTF8(std::ostream_iterator<char>(oss), character);
 			LogWarning << "Could not upload glyph for character U+" << std::hex << character
@@ -167,13 +232,189 @@ bool Font::insertGlyph(Char character) {
 			insertPlaceholderGlyph(character);
 			return false;
 		}
+	}
+	
+	cacheDirty = true;
+	
+	return true;
+}
+
+bool Font::insertGlyphImage(Glyph & glyph, const Image & image) {
+	
+	Vec2i offset;
+	if(!textures->insertImage(image, glyph.texture, offset)) {
+		return false;
+	}
+	
+	// Compute UV mapping for each glyph.
+	const float textureSize = textures->getTextureSize();
+	glyph.uv_start = offset.to<float>() / textureSize;
+	glyph.uv_end = (offset + glyph.size).to<float>() / textureSize;
+	
+	return true;
+}
+
+bool Font::loadGlyphCache() {
+	
+	if(cacheFile.empty() || !fs::exists(cacheFile)) {
+		return false;
+	}
+	
+	size_t size;
+	char * data = fs::read_file(cacheFile, size);
+	if(!data) {
+		return false;
+	}
+	
+	const char * pos = data;
+	const char * end = data + size;
+	bool ok = false;
+	
+	const GLYPH_CACHE_HEADER * header = reinterpret_cast<const GLYPH_CACHE_HEADER *>(pos);
+	if(size >= sizeof(GLYPH_CACHE_HEADER)
+	   && std::equal(GLYPH_CACHE_MAGIC, GLYPH_CACHE_MAGIC + 4, header->magic)
+	   && header->version == GLYPH_CACHE_VERSION && header->fontSize == info.size) {
+		
+		pos += sizeof(GLYPH_CACHE_HEADER);
+		
+		const s32 maxSize = s32(textures->getTextureSize());
+		
+		u32 i = 0;
+		for(; i < header->nglyphs; i++) {
+			
+			if(size_t(end - pos) < sizeof(GLYPH_CACHE_ENTRY)) {
+				break;
+			}
+			const GLYPH_CACHE_ENTRY * entry = reinterpret_cast<const GLYPH_CACHE_ENTRY *>(pos);
+			pos += sizeof(GLYPH_CACHE_ENTRY);
+			
+			if(entry->size_x < 0 || entry->size_x > maxSize
+			   || entry->size_y < 0 || entry->size_y > maxSize) {
+				break;
+			}
+			size_t imageSize = size_t(entry->size_x) * size_t(entry->size_y);
+			if(size_t(end - pos) < imageSize) {
+				break;
+			}
+			
+			Glyph glyph;
+			glyph.index = entry->index;
+			glyph.size = Vec2i(entry->size_x, entry->size_y);
+			glyph.draw_offset = Vec2i(entry->draw_offset_x, entry->draw_offset_y);
+			glyph.advance = Vec2f(entry->advance_x, entry->advance_y);
+			glyph.lsb_delta = entry->lsb_delta;
+			glyph.rsb_delta = entry->rsb_delta;
+			glyph.uv_start = Vec2f::ZERO;
+			glyph.uv_end = Vec2f::ZERO;
+			glyph.texture = 0;
+			
+			if(imageSize != 0) {
+				Image image;
+				image.Create(glyph.size.x, glyph.size.y, Image::Format_A8);
+				memcpy(image.GetData(), pos, imageSize);
+				pos += imageSize;
+				if(!insertGlyphImage(glyph, image)) {
+					break;
+				}
+			}
+			
+			glyphs[entry->character] = glyph;
+		}
+		
+		ok = (i == header->nglyphs && pos == end);
+	}
+	
+	free(data);
+	
+	if(!ok) {
+		LogWarning << "Ignoring invalid glyph cache " << cacheFile;
+		glyphs.clear();
+		textures->clear();
+		cacheDirty = true;
+		return false;
+	}
+	
+	LogDebug("loaded " << glyphs.size() << " glyphs from " << cacheFile);
+	
+	cacheDirty = false;
+	return true;
+}
+
+bool Font::saveGlyphCache() {
+	
+	if(cacheFile.empty() || !cacheDirty) {
+		return true;
+	}
+	
+	// Only store glyphs that were actually rendered, not placeholder mappings
+	std::vector<std::pair<Char, const Glyph *> > rendered;
+	for(glyph_iterator it = glyphs.begin(); it != glyphs.end(); ++it) {
+		if(it->second.index != 0 && FT_Get_Char_Index(face, it->first) == it->second.index) {
+			rendered.push_back(std::make_pair(it->first, &it->second));
+		}
+	}
+	
+	if(!fs::create_directories(cacheFile.parent())) {
+		LogWarning << "Could not create directory for glyph cache " << cacheFile;
+		return false;
+	}
+	
+	fs::ofstream ofs(cacheFile, fs::fstream::out | fs::fstream::binary | fs::fstream::trunc);
+	if(!ofs.is_open()) {
+		LogWarning << "Could not write glyph cache " << cacheFile;
+		return false;
+	}
+	
+	GLYPH_CACHE_HEADER header;
+	std::copy(GLYPH_CACHE_MAGIC, GLYPH_CACHE_MAGIC + 4, header.magic);
+	header.version = GLYPH_CACHE_VERSION;
+	header.fontSize = info.size;
+	header.nglyphs = rendered.size();
+	fs::write(ofs, header);
+	
+	const float textureSize = textures->getTextureSize();
+	
+	for(size_t i = 0; i < rendered.size(); i++) {
+		
+		const Glyph & glyph = *rendered[i].second;
+		
+		GLYPH_CACHE_ENTRY entry;
+		entry.character = rendered[i].first;
+		entry.index = glyph.index;
+		entry.size_x = glyph.size.x;
+		entry.size_y = glyph.size.y;
+		entry.draw_offset_x = glyph.draw_offset.x;
+		entry.draw_offset_y = glyph.draw_offset.y;
+		entry.advance_x = glyph.advance.x;
+		entry.advance_y = glyph.advance.y;
+		entry.lsb_delta = glyph.lsb_delta;
+		entry.rsb_delta = glyph.rsb_delta;
+		fs::write(ofs, entry);
+		
+		if(glyph.size.x == 0 || glyph.size.y == 0) {
+			continue;
+		}
 		
-		// Compute UV mapping for each glyph.
-		const float textureSize = textures->getTextureSize();
-		glyph.uv_start = offset.to<float>() / textureSize;
-		glyph.uv_end = (offset + glyph.size).to<float>() / textureSize;
+		// Read the glyph image back from its texture page
+		const Image & page = textures->getTexture(glyph.texture).GetImage();
+		size_t x = size_t(glyph.uv_start.x * textureSize + .5f);
+		size_t y = size_t(glyph.uv_start.y * textureSize + .5f);
+		const unsigned char * src = page.GetData() + y * page.GetWidth() + x;
+		for(s32 row = 0; row < glyph.size.y; row++, src += page.GetWidth()) {
+			fs::write(ofs, src, glyph.size.x);
+		}
+	}
+	
+	if(ofs.fail()) {
+		LogWarning << "Error writing glyph cache " << cacheFile;
+		ofs.close();
+		fs::remove(cacheFile);
+		return false;
 	}
 	
+	LogDebug("saved " << rendered.size() << " glyphs to " << cacheFile);
+	
+	cacheDirty = false;
 	return true;
 }
 
@@ -251,41 +492,34 @@ Font::glyph_iterator Font::getNextGlyph(text_iterator & it, text_iterator end) {
 	return glyphs.find(chr); // the newly inserted glyph
 }
 
-template <bool DoDraw>
-Vec2i Font::process(int x, int y, text_iterator start, text_iterator end, Color color) {
+int Font::getKerning(unsigned int left, unsigned int right) {
 	
-	if(DoDraw) {
-		
-		GRenderer->SetRenderState(Renderer::Lighting, false);
-		GRenderer->SetRenderState(Renderer::AlphaBlending, true);
-		GRenderer->SetBlendFunc(Renderer::BlendSrcAlpha, Renderer::BlendInvSrcAlpha);
-		
-		GRenderer->SetRenderState(Renderer::DepthTest, false);
-		GRenderer->SetRenderState(Renderer::DepthWrite, false);
-		GRenderer->SetCulling(Renderer::CullNone);
-		
-		// 2D projection setup... Put origin (0,0) in the top left corner like GDI...
-		Rect viewport = GRenderer->GetViewport();
-		GRenderer->Begin2DProjection(viewport.left, viewport.right,
-		                             viewport.bottom, viewport.top, -1.f, 1.f);
-		
-		// Fixed pipeline texture stage operation
-		GRenderer->GetTextureStage(0)->SetColorOp(TextureStage::ArgDiffuse);
-		GRenderer->GetTextureStage(0)->SetAlphaOp(TextureStage::ArgTexture);
-		
-		GRenderer->GetTextureStage(0)->SetWrapMode(TextureStage::WrapClamp);
-		GRenderer->GetTextureStage(0)->SetMinFilter(TextureStage::FilterNearest);
-		GRenderer->GetTextureStage(0)->SetMagFilter(TextureStage::FilterNearest);
-		
+	std::pair<unsigned int, unsigned int> key(left, right);
+	
+	KerningCache::const_iterator it = kerning.find(key);
+	if(it != kerning.end()) {
+		return it->second;
 	}
 	
+	FT_Vector delta;
+	FT_Get_Kerning(face, left, right, FT_KERNING_DEFAULT, &delta);
+	
+	int offset = delta.x >> 6;
+	kerning[key] = offset;
+	
+	return offset;
+}
+
+template <bool DoLayout>
+Vec2i Font::process(int x, int y, text_iterator start, text_iterator end, GlyphQuads * quads) {
+	
 	float penX = x;
 	float penY = y;
 	
 	int startX = 0;
 	int endX = 0;
 	
-	if(DoDraw) {
+	if(DoLayout) {
 		// Substract one line height (since we flipped the Y origin to be like GDI)
 		penY += face->size->metrics.ascender >> 6;
 	}
@@ -293,6 +527,8 @@ Vec2i Font::process(int x, int y, text_iterator start, text_iterator end, Color
 	FT_UInt prevGlyphIndex = 0;
 	FT_Pos prevRsbDelta = 0;
 	
+	bool hasKerning = FT_HAS_KERNING(face);
+	
 	for(text_iterator it = start; it != end; ) {
 		
 		// Get glyph in glyph map
@@ -303,11 +539,9 @@ Vec2i Font::process(int x, int y, text_iterator start, text_iterator end, Color
 		const Glyph & glyph = itGlyph->second;
 		
 		// Kerning
-		if(FT_HAS_KERNING(face)) {
+		if(hasKerning) {
 			if(prevGlyphIndex != 0) {
-				FT_Vector delta;
-				FT_Get_Kerning(face, prevGlyphIndex, glyph.index, FT_KERNING_DEFAULT, &delta);
-				penX += delta.x >> 6;
+				penX += getKerning(prevGlyphIndex, glyph.index);
 			}
 			prevGlyphIndex = glyph.index;
 		}
@@ -320,16 +554,19 @@ Vec2i Font::process(int x, int y, text_iterator start, text_iterator end, Color
 		}
 		prevRsbDelta = glyph.rsb_delta;
 		
-		// Draw
-		if(DoDraw && glyph.size.x != 0 && glyph.size.y != 0) {
-			GRenderer->SetTexture(0, &textures->getTexture(glyph.texture));
-			GRenderer->DrawTexturedRect(
-				((int)penX) + glyph.draw_offset.x, ((int)penY) - glyph.draw_offset.y,
-				glyph.size.x, -glyph.size.y, glyph.uv_start.x, glyph.uv_end.y, glyph.uv_end.x,
-				glyph.uv_start.y, color
-			);
+		// Position
+		if(DoLayout && glyph.size.x != 0 && glyph.size.y != 0) {
+			GlyphQuad quad;
+			quad.pos.x = float(((int)penX) + glyph.draw_offset.x);
+			quad.pos.y = float(((int)penY) - glyph.draw_offset.y);
+			quad.size.x = float(glyph.size.x);
+			quad.size.y = float(-glyph.size.y);
+			quad.uv_start = glyph.uv_start;
+			quad.uv_end = glyph.uv_end;
+			quad.texture = glyph.texture;
+			quads->push_back(quad);
 		} else {
-			ARX_UNUSED(penY), ARX_UNUSED(color);
+			ARX_UNUSED(penY), ARX_UNUSED(quads);
 		}
 		
 		// If this is the first drawn char, note the start position
@@ -342,36 +579,163 @@ Vec2i Font::process(int x, int y, text_iterator start, text_iterator end, Color
 		penX += glyph.advance.x;
 	}
 	
-	if(DoDraw) {
+	int sizeX = endX - startX;
+	int sizeY = face->size->metrics.height >> 6;
+	
+	return Vec2i(sizeX, sizeY);
+}
+
+void Font::queue(int x, int y, const GlyphQuads & quads, Color color) {
+	
+	if(quads.empty()) {
+		return;
+	}
+	
+	if(pending.size() < textures->getTextureCount()) {
+		pending.resize(textures->getTextureCount());
+	}
+	
+	if(std::find(batchFonts.begin(), batchFonts.end(), this) == batchFonts.end()) {
+		batchFonts.push_back(this);
+	}
+	
+	ColorBGRA col = color.toBGRA();
+	
+	for(GlyphQuads::const_iterator it = quads.begin(); it != quads.end(); ++it) {
 		
-		GRenderer->ResetTexture(0);
-		TextureStage * stage = GRenderer->GetTextureStage(0);
-		stage->SetColorOp(TextureStage::OpModulate,
-		                  TextureStage::ArgTexture, TextureStage::ArgCurrent);
-		stage->SetAlphaOp(TextureStage::ArgTexture);
-		stage->SetWrapMode(TextureStage::WrapRepeat);
-		stage->SetMinFilter(TextureStage::FilterLinear);
-		stage->SetMagFilter(TextureStage::FilterLinear);
+		// Match pixel and texel origins.
+		float x0 = float(x) + it->pos.x - .5f, x1 = x0 + it->size.x;
+		float y0 = float(y) + it->pos.y - .5f, y1 = y0 + it->size.y;
 		
-		GRenderer->End2DProjection();
-		GRenderer->SetRenderState(Renderer::AlphaBlending, false);
-		GRenderer->SetRenderState(Renderer::DepthWrite, true);
-		GRenderer->SetCulling(Renderer::CullCCW);
+		vector<TexturedVertex> & vertices = pending[it->texture];
+		vertices.push_back(TexturedVertex(Vec3f(x0, y0, 0.f), 1.f, col, 0xff000000,
+		                                  Vec2f(it->uv_start.x, it->uv_end.y)));
+		vertices.push_back(TexturedVertex(Vec3f(x1, y0, 0.f), 1.f, col, 0xff000000,
+		                                  Vec2f(it->uv_end.x, it->uv_end.y)));
+		vertices.push_back(TexturedVertex(Vec3f(x1, y1, 0.f), 1.f, col, 0xff000000,
+		                                  Vec2f(it->uv_end.x, it->uv_start.y)));
+		vertices.push_back(TexturedVertex(Vec3f(x0, y1, 0.f), 1.f, col, 0xff000000,
+		                                  Vec2f(it->uv_start.x, it->uv_start.y)));
+	}
+}
+
+void Font::flush() {
+	
+	for(size_t page = 0; page < pending.size(); page++) {
+		
+		vector<TexturedVertex> & vertices = pending[page];
+		if(vertices.empty()) {
+			continue;
+		}
+		
+		GRenderer->SetTexture(0, &textures->getTexture(page));
 		
+		size_t nquads = vertices.size() / 4;
+		for(size_t start = 0; start < nquads; start += MAX_BATCH_QUADS) {
+			size_t count = std::min(nquads - start, MAX_BATCH_QUADS);
+			GRenderer->drawIndexed(Renderer::TriangleList, &vertices[start * 4], count * 4,
+			                       &quadIndices[0], count * 6);
+		}
+		
+		vertices.clear();
 	}
+}
+
+void Font::beginBatch() {
+	batchDepth++;
+}
+
+void Font::endBatch() {
 	
-	int sizeX = endX - startX;
-	int sizeY = face->size->metrics.height >> 6;
+	arx_assert(batchDepth > 0);
 	
-	return Vec2i(sizeX, sizeY);
+	batchDepth--;
+	
+	if(batchDepth == 0) {
+		flushBatch();
+	}
+}
+
+void Font::flushBatch() {
+	
+	if(batchFonts.empty()) {
+		return;
+	}
+	
+	// Grow the shared index list to cover the largest page
+	size_t maxQuads = 0;
+	for(vector<Font *>::const_iterator it = batchFonts.begin(); it != batchFonts.end(); ++it) {
+		for(size_t page = 0; page < (*it)->pending.size(); page++) {
+			maxQuads = std::max(maxQuads, (*it)->pending[page].size() / 4);
+		}
+	}
+	maxQuads = std::min(maxQuads, MAX_BATCH_QUADS);
+	for(size_t i = quadIndices.size() / 6; i < maxQuads; i++) {
+		unsigned short base = (unsigned short)(i * 4);
+		quadIndices.push_back(base + 0);
+		quadIndices.push_back(base + 1);
+		quadIndices.push_back(base + 2);
+		quadIndices.push_back(base + 0);
+		quadIndices.push_back(base + 2);
+		quadIndices.push_back(base + 3);
+	}
+	
+	GRenderer->SetRenderState(Renderer::Lighting, false);
+	GRenderer->SetRenderState(Renderer::AlphaBlending, true);
+	GRenderer->SetBlendFunc(Renderer::BlendSrcAlpha, Renderer::BlendInvSrcAlpha);
+	
+	GRenderer->SetRenderState(Renderer::DepthTest, false);
+	GRenderer->SetRenderState(Renderer::DepthWrite, false);
+	GRenderer->SetCulling(Renderer::CullNone);
+	
+	// Fixed pipeline texture stage operation
+	GRenderer->GetTextureStage(0)->SetColorOp(TextureStage::ArgDiffuse);
+	GRenderer->GetTextureStage(0)->SetAlphaOp(TextureStage::ArgTexture);
+	
+	GRenderer->GetTextureStage(0)->SetWrapMode(TextureStage::WrapClamp);
+	GRenderer->GetTextureStage(0)->SetMinFilter(TextureStage::FilterNearest);
+	GRenderer->GetTextureStage(0)->SetMagFilter(TextureStage::FilterNearest);
+	
+	for(vector<Font *>::const_iterator it = batchFonts.begin(); it != batchFonts.end(); ++it) {
+		(*it)->flush();
+	}
+	batchFonts.clear();
+	
+	GRenderer->ResetTexture(0);
+	TextureStage * stage = GRenderer->GetTextureStage(0);
+	stage->SetColorOp(TextureStage::OpModulate,
+	                  TextureStage::ArgTexture, TextureStage::ArgCurrent);
+	stage->SetAlphaOp(TextureStage::ArgTexture);
+	stage->SetWrapMode(TextureStage::WrapRepeat);
+	stage->SetMinFilter(TextureStage::FilterLinear);
+	stage->SetMagFilter(TextureStage::FilterLinear);
+	
+	GRenderer->SetRenderState(Renderer::AlphaBlending, false);
+	GRenderer->SetRenderState(Renderer::DepthWrite, true);
+	GRenderer->SetCulling(Renderer::CullCCW);
 }
 
 void Font::draw(int x, int y, text_iterator start, text_iterator end, Color color) {
-	process<true>(x, y, start, end, color);
+	GlyphQuads quads;
+	process<true>(x, y, start, end, &quads);
+	draw(0, 0, quads, color);
+}
+
+void Font::draw(int x, int y, const GlyphQuads & quads, Color color) {
+	
+	queue(x, y, quads, color);
+	
+	if(batchDepth == 0) {
+		flushBatch();
+	}
+}
+
+Vec2i Font::layout(int x, int y, text_iterator start, text_iterator end, GlyphQuads & quads) {
+	return process<true>(x, y, start, end, &quads);
 }
 
 Vec2i Font::getTextSize(text_iterator start, text_iterator end) {
-	return process<false>(0, 0, start, end, Color::none);
+	return process<false>(0, 0, start, end, NULL);
 }
 
 int Font::getLineHeight() const {
@@ -22,14 +22,19 @@
 
 #include <string>
 #include <map>
+#include <vector>
 
 #include <boost/noncopyable.hpp>
 
 #include "graphics/Color.h"
+#include "graphics/Vertex.h"
 #include "math/Vector2.h"
 
+#include "io/fs/FilePath.h"
 #include "io/resource/ResourcePath.h"
 
+class Image;
+
 class Font : private boost::noncopyable {
 	
 	friend class FontCache;
@@ -92,6 +97,25 @@ public:
 		
 	};
 	
+	//! A glyph that has been positioned by layout()
+	struct GlyphQuad {
+		
+		//! Top-left corner of the glyph, relative to the layout origin
+		Vec2f pos;
+		
+		//! Size of the glyph in pixels (negative height, as for DrawTexturedRect)
+		Vec2f size;
+		
+		Vec2f uv_start;
+		Vec2f uv_end;
+		
+		//!< Texture page on which the glyph can be found
+		unsigned int texture;
+		
+	};
+	
+	typedef std::vector<GlyphQuad> GlyphQuads;
+	
 public:
 	
 	typedef u32 Char;
@@ -112,6 +136,38 @@ public:
 	
 	void draw(int x, int y, text_iterator start, text_iterator end, Color color);
 	
+	/*!
+	 * Draw glyphs that have previously been positioned using layout().
+	 * The glyphs are submitted with one draw call per texture page, or queued
+	 * until endBatch() if a batch is active.
+	 */
+	void draw(int x, int y, const GlyphQuads & quads, Color color);
+	
+	/*!
+	 * Position the glyphs for the text [start, end) and append them to quads.
+	 * The result can be cached and drawn repeatedly with draw().
+	 * @return the size of the text, as returned by getTextSize()
+	 */
+	Vec2i layout(int x, int y, text_iterator start, text_iterator end, GlyphQuads & quads);
+	
+	/*!
+	 * Start collecting the glyphs drawn by all fonts instead of drawing them
+	 * immediately. Batches can be nested.
+	 */
+	static void beginBatch();
+	
+	/*!
+	 * Draw all glyphs collected since the outermost beginBatch().
+	 */
+	static void endBatch();
+	
+	/*!
+	 * Draw all glyphs collected so far without ending the current batch.
+	 * Must be called before changing render state that affects queued text,
+	 * such as the viewport.
+	 */
+	static void flushBatch();
+	
 	Vec2i getTextSize(const std::string & str) {
 		return getTextSize(str.begin(), str.end());
 	}
@@ -129,7 +185,8 @@ public:
 private:
 	
 	// Construction/destruction handled by FontCache only
-	Font(const res::path & fontFile, unsigned int fontSize, struct FT_FaceRec_ * face);
+	Font(const res::path & fontFile, unsigned int fontSize, struct FT_FaceRec_ * face,
+	     const fs::path & cacheFile);
 	~Font();
 	
 	//! Maps the given character to a placeholder glyph
@@ -143,16 +200,44 @@ private:
 	 */
 	bool insertGlyph(Char character);
 	
+	/*!
+	 * Copies the rendered glyph image into the texture pages
+	 * and sets the UV coordinates of the glyph.
+	 */
+	bool insertGlyphImage(Glyph & glyph, const Image & image);
+	
 	/*!
 	 * Inserts any missing glyphs for the characters in the UTF-8 string [begin, end)
 	 * @return true if the glyph textures were changed
 	 */
 	bool insertMissingGlyphs(text_iterator begin, text_iterator end);
 	
+	/*!
+	 * Inserts the pre-rendered glyphs stored in the glyph cache file
+	 * @return true if the cache was valid and the glyphs were loaded
+	 */
+	bool loadGlyphCache();
+	
+	/*!
+	 * Writes all glyphs rendered so far to the glyph cache file, so that
+	 * they can be loaded without FreeType the next time the font is created.
+	 * Does nothing if no new glyphs have been rendered since the cache was loaded.
+	 */
+	bool saveGlyphCache();
+	
 private:
 	
-	template <bool Draw>
-	Vec2i process(int pX, int pY, text_iterator start, text_iterator end, Color color);
+	template <bool DoLayout>
+	Vec2i process(int pX, int pY, text_iterator start, text_iterator end, GlyphQuads * quads);
+	
+	//! Get the kerning offset between two glyphs, caching FreeType results
+	int getKerning(unsigned int left, unsigned int right);
+	
+	//! Queue the vertices for the given glyphs
+	void queue(int x, int y, const GlyphQuads & quads, Color color);
+	
+	//! Draw the queued glyphs of this font
+	void flush();
 	
 	Info info;
 	unsigned int referenceCount;
@@ -170,6 +255,18 @@ private:
 	
 	class PackedTexture * textures;
 	
+	//! File used to store rendered glyphs between sessions, empty if disabled
+	fs::path cacheFile;
+	
+	//! Glyphs have been rendered that are not in the cache file
+	bool cacheDirty;
+	
+	typedef std::map<std::pair<unsigned int, unsigned int>, int> KerningCache;
+	KerningCache kerning;
+	
+	//! Glyph vertices waiting to be drawn, one list per texture page
+	std::vector< std::vector<TexturedVertex> > pending;
+	
 };
 
 #endif // ARX_GRAPHICS_FONT_FONT_H
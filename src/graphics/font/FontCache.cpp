@@ -20,11 +20,15 @@
 #include "graphics/font/FontCache.h"
 
 #include <sstream>
+#include <iomanip>
+
+#include <boost/crc.hpp>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
 #include "io/fs/FilePath.h"
+#include "io/fs/SystemPaths.h"
 #include "io/log/Logger.h"
 #include "io/resource/PakReader.h"
 #include "platform/CrashHandler.h"
@@ -95,6 +99,14 @@ Font * FontCache::create(const res::path & font, FontFile & file, unsigned int s
 		if(!file.data) {
 			return NULL;
 		}
+		
+		// Rendered glyphs depend on both the font data and the FreeType version
+		FT_Int ftVersion[3];
+		FT_Library_Version(g_FTLibrary, &ftVersion[0], &ftVersion[1], &ftVersion[2]);
+		boost::crc_32_type crc;
+		crc.process_bytes(file.data, file.size);
+		crc.process_bytes(ftVersion, sizeof(ftVersion));
+		file.hash = crc.checksum();
 	}
 	
 	LogDebug("creating font " << font << " @ " << size);
@@ -119,7 +131,20 @@ Font * FontCache::create(const res::path & font, FontFile & file, unsigned int s
 		return NULL;
 	}
 	
-	return new Font(font, size, face);
+	return new Font(font, size, face, getCacheFile(file, size));
+}
+
+fs::path FontCache::getCacheFile(const FontFile & file, unsigned int size) {
+	
+	if(fs::paths.user.empty()) {
+		return fs::path();
+	}
+	
+	std::ostringstream oss;
+	oss << std::hex << std::setfill('0') << std::setw(8) << file.hash;
+	oss << std::dec << '_' << size << ".glyphs";
+	
+	return fs::paths.user / "cache" / "fonts" / oss.str();
 }
 
 void FontCache::releaseFont(Font * font) {
@@ -135,6 +160,7 @@ void FontCache::releaseFont(Font * font) {
 		FontFile & file = instance->files[font->getName()];
 		
 		file.sizes.erase(font->getSize());
+		font->saveGlyphCache();
 		LogDebug("destroying font " << font->getName() << " @ " << font->getSize());
 		
 		if(file.sizes.empty()) {
@@ -27,6 +27,7 @@
 
 #include "graphics/font/Font.h"
 #include "io/resource/ResourcePath.h"
+#include "platform/Platform.h"
 
 class FontCache {
 	
@@ -37,7 +38,10 @@ class FontCache {
 		size_t size;
 		char * data;
 		
-		FontFile() : size(0), data(NULL) { }
+		//! Checksum of the font data, used to identify glyph cache files
+		u32 hash;
+		
+		FontFile() : size(0), data(NULL), hash(0) { }
 		
 		FontMap sizes;
 		
@@ -59,6 +63,9 @@ private:
 	
 	Font * create(const res::path & fontFile, FontFile & file, unsigned int fontSize);
 	
+	//! Get the glyph cache file for the given font and size, or an empty path if disabled
+	fs::path getCacheFile(const FontFile & file, unsigned int fontSize);
+	
 	
 	typedef std::map<res::path, FontFile> FontFiles;
 	FontFiles files;
@@ -572,7 +572,7 @@ void ARX_PARTICLES_Spawn_Blood(Vec3f * pos, float dmgs, long source) {
 		pd->scale = Vec3f::repeat(float(spawn_nb));
 		pd->special = GRAVITY | ROTATING | MODULATE_ROTATION | DELAY_FOLLOW_SOURCE;
 		pd->source = &entities[source]->obj->vertexlist3[nearest].v;
-		pd->sourceionum = source;
+		pd->sourceio = entities.handle(entities[source]);
 		pd->tolive = 1200 + spawn_nb * 5;
 		totdelay += 45 + Random::get(0, 150 - spawn_nb);
 		pd->delay = totdelay;
@@ -813,8 +813,9 @@ void ARX_MAGICAL_FLARES_Draw(long FRAMETICKS) {
 			
 			if(flare[i].tolive <= 0.f || flare[i].y < -64.f || s < 3.f) {
 				
-				if(flare[i].io && ValidIOAddress(flare[i].io)) {
-					flare[i].io->flarecount--;
+				Entity * io = entities.get(flare[i].io);
+				if(io) {
+					io->flarecount--;
 				}
 				
 				if(ValidDynLight(flare[i].dynlight)) {
@@ -844,7 +845,7 @@ void ARX_MAGICAL_FLARES_Draw(long FRAMETICKS) {
 				el->rgb = c;
 			}
 			
-			if(!flare[i].io) {
+			if(!entities.isValid(flare[i].io)) {
 				GRenderer->SetRenderState(Renderer::DepthTest, false);
 			} else {
 				GRenderer->SetRenderState(Renderer::DepthTest, true);
@@ -1160,6 +1161,7 @@ PARTICLE_DEF * createParticle(bool allocateWhilePaused) {
 		pd->tc = NULL;
 		pd->special = 0;
 		pd->source = NULL;
+		pd->sourceio = EntityHandle();
 		pd->delay = 0;
 		pd->zdec = false;
 		pd->move = Vec3f::ZERO;
@@ -1408,10 +1410,9 @@ void ARX_PARTICLES_Render(EERIE_CAMERA * cam)  {
 		if(part->delay > 0) {
 			part->timcreation += part->delay;
 			part->delay=0;
-			if((part->special & DELAY_FOLLOW_SOURCE) && part->sourceionum >= 0
-					&& entities[part->sourceionum]) {
+			Entity * target = entities.get(part->sourceio);
+			if((part->special & DELAY_FOLLOW_SOURCE) && target) {
 				part->ov = *part->source;
-				Entity * target = entities[part->sourceionum];
 				Vec3f vector = (part->ov - target->pos) * Vec3f(1.f, 0.5f, 1.f);
 				vector.normalize();
 				part->move = vector * Vec3f(18.f, 5.f, 18.f) + randomVec(-0.5f, 0.5f);
@@ -1500,11 +1501,9 @@ void ARX_PARTICLES_Render(EERIE_CAMERA * cam)  {
 		
 		float val = (part->tolive - framediff) * 0.01f;
 		
-		if((part->special & FOLLOW_SOURCE) && part->sourceionum >= 0
-				&& entities[part->sourceionum]) {
+		if((part->special & FOLLOW_SOURCE) && entities.isValid(part->sourceio)) {
 			inn.p = in.p = *part->source;
-		} else if((part->special & FOLLOW_SOURCE2) && part->sourceionum >= 0
-							&& entities[part->sourceionum]) {
+		} else if((part->special & FOLLOW_SOURCE2) && entities.isValid(part->sourceio)) {
 			inn.p = in.p = *part->source + part->move * val;
 		} else {
 			inn.p = in.p = part->ov + part->move * val;
@@ -1864,9 +1863,10 @@ void ARX_MAGICAL_FLARES_KillAll()
 	{
 		if (flare[i].exist)
 		{
-			if (flare[i].io)
+			Entity * io = entities.get(flare[i].io);
+			if (io)
 			{
-				flare[i].io->flarecount--;
+				io->flarecount--;
 			}
 
 			flare[i].exist=0;
@@ -1900,7 +1900,7 @@ void AddFlare(Vec2s * pos, float sm, short typ, Entity * io) {
 	flarenum++;
 	
 	fl->bDrawBitmap = 0;
-	fl->io = io;
+	fl->io = entities.handle(io);
 	if(io) {
 		fl->flags = 1;
 		io->flarecount++;
@@ -2031,7 +2031,7 @@ void AddFlare2(Vec2s * pos, float sm, short typ, Entity * io) {
 	flarenum++;
 	
 	fl->bDrawBitmap = 1;
-	fl->io = io;
+	fl->io = entities.handle(io);
 	if(io) {
 		fl->flags = 1;
 		io->flarecount++;
@@ -49,6 +49,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 
 #include <stddef.h>
 
+#include "game/EntityManager.h"
 #include "graphics/Color.h"
 #include "graphics/Vertex.h"
 #include "math/MathFwd.h"
@@ -74,7 +75,7 @@ struct FLARES {
 	float size;
 	long dynlight;
 	long move;
-	Entity * io;
+	EntityHandle io;
 	bool bDrawBitmap;
 };
 
@@ -111,7 +112,7 @@ struct PARTICLE_DEF {
 	float fparam;
 	long mask;
 	Vec3f * source;
-	long sourceionum;
+	EntityHandle sourceio; //!< Entity owning source
 	short sval;
 	char cval1;
 	char cval2;
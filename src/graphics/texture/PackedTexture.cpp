@@ -91,6 +91,9 @@ bool PackedTexture::insertImage(const Image & image, unsigned int & textureIndex
 	for(size_t i = 0; i < textures.size(); i++) {
 		node = textures[i]->insertImage(image);
 		nodeTree = i;
+		if(node) {
+			break;
+		}
 	}
 	
 	// No space found, create a new texture
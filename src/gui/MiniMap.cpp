@@ -46,7 +46,10 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 
 #include "gui/MiniMap.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdio>
+#include <cstring>
 
 #include "core/Core.h"
 #include "core/Localisation.h"
@@ -81,6 +84,55 @@ static float mapmaxy[32];
 
 static TextureContainer * pTexDetect = NULL;
 
+/*!
+ * Fog of war quads for the last minimap that was shown.
+ * The quads are kept in map space and only recreated when the map layout changes.
+ * Otherwise, only the quads around cells whose revealed value changed are updated.
+ * The scroll offset and border fading are applied when building the batch.
+ */
+struct MiniMapFog {
+	
+	struct Quad {
+		long i;
+		long j;
+		TexturedVertex v[4]; //!< Positions relative to the map origin
+		float revealed[4];
+		bool visible; //!< At least one corner is revealed
+	};
+	
+	long level;
+	long flag;
+	long fl2;
+	TextureContainer * tc;
+	float xratio;
+	float yratio;
+	float casex;
+	float casey;
+	
+	//! Map origin the batch was last built for
+	float startx;
+	float starty;
+	
+	//! Revealed values the quads were last updated for
+	unsigned char revealed[MINIMAP_MAX_X][MINIMAP_MAX_Z];
+	
+	//! One quad for each cell including the two cell border, see quadIndex()
+	std::vector<Quad> quads;
+	
+	//! Triangles for all visible quads
+	std::vector<TexturedVertex> batch;
+	
+	MiniMapFog() : level(-1), flag(0), fl2(0), tc(NULL), xratio(0.f), yratio(0.f),
+	               casex(0.f), casey(0.f), startx(0.f), starty(0.f) { }
+	
+	static size_t quadIndex(long i, long j) {
+		return size_t((i + 2) + (j + 2) * (MINIMAP_MAX_X + 4));
+	}
+	
+};
+
+static MiniMapFog minimapFog;
+
 std::vector<MAPMARKER_DATA> Mapmarkers;
 
 void ARX_MINIMAP_GetData(long SHOWLEVEL) {
@@ -143,6 +195,73 @@ void ARX_MINIMAP_GetData(long SHOWLEVEL) {
 	}
 }
 extern long Book_MapPage;
+
+//! Reveals the cells around the player, in the map layout of the book
+static void ARX_MINIMAP_RevealPlayerPos(long SHOWLEVEL) {
+	
+	const float startx = 140.f;
+	const float starty = 120.f;
+	const float casex = 250.f / float(MINIMAP_MAX_X);
+	const float casey = 250.f / float(MINIMAP_MAX_Z);
+	const float mod_x = float(MAX_BKGX) / float(MINIMAP_MAX_X);
+	const float mod_z = float(MAX_BKGZ) / float(MINIMAP_MAX_Z);
+	const float radius = 6.f;
+	
+	float ofx = mini_offset_x[CURRENTLEVEL];
+	float ofx2 = minimap[SHOWLEVEL].xratio;
+	float ofy = mini_offset_y[CURRENTLEVEL];
+	float ofy2 = minimap[SHOWLEVEL].yratio;
+	
+	float px = startx + ((player.pos.x + ofx - ofx2) * ( 1.0f / 100 ) * casex
+	                     + mini_offset_x[CURRENTLEVEL] * mod_x) / mod_x;
+	float py = starty + ((mapmaxy[SHOWLEVEL] - ofy - ofy2) * ( 1.0f / 100 ) * casey
+	                     - (player.pos.z + ofy - ofy2) * ( 1.0f / 100 ) * casey
+	                     + mini_offset_y[CURRENTLEVEL] * mod_z) / mod_z;
+	
+	// Only the cells close to the player can be revealed
+	float mini = (px - radius - startx) / casex - 1.5f;
+	float maxi = (px + radius - startx) / casex + 1.f;
+	float minj = (py - radius - starty) / casey - 1.f;
+	float maxj = (py + radius - starty) / casey + 1.f;
+	if(!(maxi >= 0.f && mini < float(MINIMAP_MAX_X) && maxj >= 0.f && minj < float(MINIMAP_MAX_Z))) {
+		return;
+	}
+	long i0 = std::max(long(mini), 0L), i1 = std::min(long(maxi), long(MINIMAP_MAX_X - 1));
+	long j0 = std::max(long(minj), 0L), j1 = std::min(long(maxj), long(MINIMAP_MAX_Z - 1));
+	
+	float divXratio = 1.f / Xratio;
+	float divYratio = 1.f / Yratio;
+	
+	for(long j = j0; j <= j1; j++) {
+		for(long i = i0; i <= i1; i++) {
+			
+			float posx = (startx + i * casex) * Xratio;
+			float posy = (starty + j * casey) * Yratio;
+			if(posx > 345 * Xratio || posy > 290 * Yratio) {
+				continue;
+			}
+			
+			float d = fdist(Vec2f(posx * divXratio + casex * ( 1.0f / 2 ), posy * divYratio), Vec2f(px, py));
+			if(d > radius) {
+				continue;
+			}
+			
+			float vv = (radius - d) * (1.f / radius);
+			if(vv >= 0.5f) {
+				vv = 1.f;
+			} else if(vv > 0.f) {
+				vv = vv * 2.f;
+			} else {
+				vv = 0.f;
+			}
+			
+			long r = vv * 255.f;
+			long ucLevel = max(r, (long)minimap[SHOWLEVEL].revealed[i][j]);
+			minimap[SHOWLEVEL].revealed[i][j] = checked_range_cast<unsigned char>(ucLevel);
+		}
+	}
+}
+
 //-----------------------------------------------------------------------------
 void ARX_MINIMAP_ValidatePos() {
 	
@@ -162,7 +281,7 @@ void ARX_MINIMAP_ValidatePos() {
 
 		if (minimap[SHOWLEVEL].tc)
 		{
-			ARX_MINIMAP_Show( ARX_LEVELS_GetRealNum(CURRENTLEVEL), 2);
+			ARX_MINIMAP_RevealPlayerPos(SHOWLEVEL);
 		}
 	}
 }
@@ -269,22 +388,275 @@ void ARX_MINIMAP_PurgeTC() {
 	for(size_t i = 0; i < MAX_MINIMAPS; i++) {
 		delete minimap[i].tc, minimap[i].tc = NULL;
 	}
+	minimapFog.level = -1;
 }
 
 TextureContainer * MapMarkerTc = NULL;
 
-void ARX_MINIMAP_Show(long SHOWLEVEL, long flag, long fl2) {
+// Nuky - centralized some constants and dezoomed ingame minimap
+static const int FL2_SIZE = 300;
+static const int FL2_LEFT = 390;
+static const int FL2_RIGHT = 590;
+static const int FL2_TOP = 135;
+static const int FL2_BOTTOM = 295;
+static const float FL2_PLAYERSIZE = 4.f;
+
+static const float DECALY = -150;
+static const float DECALX = +40;
+
+static float ARX_MINIMAP_GetRevealed(long SHOWLEVEL, long i, long j) {
+	
+	if(i < 0 || i >= MINIMAP_MAX_X || j < 0 || j >= MINIMAP_MAX_Z) {
+		return 0.f;
+	}
+	
+	return float(minimap[SHOWLEVEL].revealed[i][j]) * ( 1.0f / 255 );
+}
+
+static void ARX_MINIMAP_UpdateFogQuad(long SHOWLEVEL, MiniMapFog::Quad & quad) {
 	
-	// Nuky - centralized some constants and dezoomed ingame minimap
-	const int FL2_SIZE = 300;
-	const int FL2_LEFT = 390;
-	const int FL2_RIGHT = 590;
-	const int FL2_TOP = 135;
-	const int FL2_BOTTOM = 295;
-	const float FL2_PLAYERSIZE = 4.f;
+	static const long cornerx[4] = { 0, 1, 1, 0 };
+	static const long cornery[4] = { 0, 0, 1, 1 };
 	
-	const float DECALY = -150;
-	const float DECALX = +40;
+	quad.visible = false;
+	
+	for(long k = 0; k < 4; k++) {
+		quad.revealed[k] = ARX_MINIMAP_GetRevealed(SHOWLEVEL, quad.i + cornerx[k], quad.j + cornery[k]);
+		if(quad.revealed[k] > 0.f) {
+			quad.visible = true;
+		}
+	}
+}
+
+static float ARX_MINIMAP_GetBorderFade(float dist, float size, float invSize) {
+	
+	if(dist < 0.f) {
+		return 0.f;
+	} else if(dist < size) {
+		return dist * invSize;
+	}
+	
+	return 1.f;
+}
+
+static void ARX_MINIMAP_CreateFogQuads(long SHOWLEVEL) {
+	
+	float casex = minimapFog.casex;
+	float casey = minimapFog.casey;
+	
+	float mod_x = (float)MAX_BKGX / (float)MINIMAP_MAX_X;
+	float mod_z = (float)MAX_BKGZ / (float)MINIMAP_MAX_Z;
+	
+	float div = ( 1.0f / 25 );
+	TextureContainer * tc = minimap[SHOWLEVEL].tc;
+	float dw = 1.f / tc->m_pTexture->getStoredSize().x; 
+	float dh = 1.f / tc->m_pTexture->getStoredSize().y;
+	
+	float vx2 = 4.f * dw * mod_x;
+	float vy2 = 4.f * dh * mod_z;
+	
+	minimapFog.quads.resize(MiniMapFog::quadIndex(MINIMAP_MAX_X + 2, MINIMAP_MAX_Z + 1));
+	
+	for(long j = -2; j < MINIMAP_MAX_Z + 2; j++) {
+		for(long i = -2; i < MINIMAP_MAX_X + 2; i++) {
+			
+			float vx, vy, vxx, vyy;
+			vxx = ((float)i * (float)ACTIVEBKG->Xdiv * mod_x);
+			vyy = ((float)j * (float)ACTIVEBKG->Zdiv * mod_z);
+			vx = (vxx * div) * dw;
+			vy = (vyy * div) * dh;
+			
+			float posx = (i * casex) * Xratio;
+			float posy = (j * casey) * Yratio;
+			
+			MiniMapFog::Quad & quad = minimapFog.quads[MiniMapFog::quadIndex(i, j)];
+			quad.i = i;
+			quad.j = j;
+			
+			TexturedVertex * verts = quad.v;
+			
+			for(long k = 0; k < 4; k++) {
+				verts[k].color = 0xFFFFFFFF;
+				verts[k].rhw = 1;
+				verts[k].p.z = 0.00001f;
+			}
+			
+			verts[3].p.x = verts[0].p.x = (posx);
+			verts[1].p.y = verts[0].p.y = (posy);
+			verts[2].p.x = verts[1].p.x = posx + (casex * Xratio);
+			verts[3].p.y = verts[2].p.y = posy + (casey * Yratio);
+			
+			verts[3].uv.x = verts[0].uv.x = vx;
+			verts[1].uv.y = verts[0].uv.y = vy;
+			verts[2].uv.x = verts[1].uv.x = vx + vx2;
+			verts[3].uv.y = verts[2].uv.y = vy + vy2;
+			
+			ARX_MINIMAP_UpdateFogQuad(SHOWLEVEL, quad);
+		}
+	}
+}
+
+//! Positions the fog of war quads at the map origin and fades them at the borders
+static void ARX_MINIMAP_BuildFogBatch(float startx, float starty) {
+	
+	MiniMapFog & fog = minimapFog;
+	long flag = fog.flag;
+	long fl2 = fog.fl2;
+	
+	Rect boundaries;
+	float MOD20, MOD20DIV;
+	
+	boundaries.bottom = boundaries.left = boundaries.right = boundaries.top = 0;
+	MOD20 = MOD20DIV = 0.f;
+	
+	// Area in which the top left corner of a quad must be to be drawn
+	float left = -1e10f, right = 345.f, top = -1e10f, bottom = 290.f;
+	
+	if(flag == 1) {
+		
+		MOD20 = 20.f * Xratio;
+		MOD20DIV = 1.f / (MOD20);
+		
+		boundaries.left = checked_range_cast<Rect::Num>((360 + MOD20) * Xratio);
+		boundaries.right = checked_range_cast<Rect::Num>((555 - MOD20) * Xratio);
+		boundaries.top = checked_range_cast<Rect::Num>((85 + MOD20) * Yratio);
+		boundaries.bottom = checked_range_cast<Rect::Num>((355 - MOD20) * Yratio);
+		left = 360.f, right = 555.f, top = 85.f, bottom = 355.f;
+		
+		if(fl2) {
+			boundaries.left = checked_range_cast<Rect::Num>((FL2_LEFT + MOD20) * Xratio);
+			boundaries.right = checked_range_cast<Rect::Num>((FL2_RIGHT - MOD20) * Xratio);
+			boundaries.top = checked_range_cast<Rect::Num>((FL2_TOP + MOD20) * Yratio);
+			boundaries.bottom = checked_range_cast<Rect::Num>((FL2_BOTTOM - MOD20) * Yratio);
+			left = FL2_LEFT, right = FL2_RIGHT, top = FL2_TOP, bottom = FL2_BOTTOM;
+		}
+	}
+	
+	// Only visit the cells that can be in that area, with one cell of margin
+	long mini = std::max(long(std::floor((left - startx) / fog.casex)) - 1, -2l);
+	long maxi = std::min(long(std::floor((right - startx) / fog.casex)) + 1, long(MINIMAP_MAX_X + 1));
+	long minj = std::max(long(std::floor((top - starty) / fog.casey)) - 1, -2l);
+	long maxj = std::min(long(std::floor((bottom - starty) / fog.casey)) + 1, long(MINIMAP_MAX_Z + 1));
+	
+	float offsetx = startx * Xratio;
+	float offsety = starty * Yratio;
+	
+	fog.batch.clear();
+	
+	for(long j = minj; j <= maxj; j++) {
+		for(long i = mini; i <= maxi; i++) {
+			
+			const MiniMapFog::Quad & quad = fog.quads[MiniMapFog::quadIndex(i, j)];
+			if(!quad.visible) {
+				continue;
+			}
+			
+			float posx = (startx + i * fog.casex) * Xratio;
+			float posy = (starty + j * fog.casey) * Yratio;
+			if(posx < left * Xratio || posx > right * Xratio
+			   || posy < top * Yratio || posy > bottom * Yratio) {
+				continue;
+			}
+			
+			TexturedVertex verts[4];
+			float oo = 0.f;
+			
+			for(long k = 0; k < 4; k++) {
+				
+				verts[k] = quad.v[k];
+				verts[k].p.x += offsetx;
+				verts[k].p.y += offsety;
+				
+				float v = quad.revealed[k];
+				
+				if(flag == 1) {
+					v *= ARX_MINIMAP_GetBorderFade(verts[k].p.x - boundaries.left, MOD20, MOD20DIV);
+					v *= ARX_MINIMAP_GetBorderFade(boundaries.right - verts[k].p.x, MOD20, MOD20DIV);
+					v *= ARX_MINIMAP_GetBorderFade(verts[k].p.y - boundaries.top, MOD20, MOD20DIV);
+					v *= ARX_MINIMAP_GetBorderFade(boundaries.bottom - verts[k].p.y, MOD20, MOD20DIV);
+				}
+				
+				verts[k].color = Color::gray(fl2 ? v * ( 1.0f / 2 ) : v).toBGR();
+				oo += v;
+				
+				if(fl2) {
+					verts[k].p.x += DECALX * Xratio;
+					verts[k].p.y += DECALY * Yratio;
+				}
+			}
+			
+			if(oo > 0.f) {
+				fog.batch.push_back(verts[0]);
+				fog.batch.push_back(verts[1]);
+				fog.batch.push_back(verts[2]);
+				fog.batch.push_back(verts[0]);
+				fog.batch.push_back(verts[2]);
+				fog.batch.push_back(verts[3]);
+			}
+		}
+	}
+	
+	fog.startx = startx;
+	fog.starty = starty;
+}
+
+//! Updates the fog of war quads and returns the triangles to draw
+static const std::vector<TexturedVertex> & ARX_MINIMAP_UpdateFog(long SHOWLEVEL, long flag, long fl2,
+                                                                 float startx, float starty,
+                                                                 float casex, float casey) {
+	
+	MiniMapFog & fog = minimapFog;
+	
+	if(fog.level == SHOWLEVEL && fog.flag == flag && fog.fl2 == fl2
+	   && fog.tc == minimap[SHOWLEVEL].tc && fog.xratio == Xratio && fog.yratio == Yratio) {
+		
+		bool moved = (fog.startx != startx || fog.starty != starty);
+		
+		if(!memcmp(fog.revealed, minimap[SHOWLEVEL].revealed, sizeof(fog.revealed))) {
+			if(moved) {
+				ARX_MINIMAP_BuildFogBatch(startx, starty);
+			}
+			return fog.batch;
+		}
+		
+		// Each cell is a corner of the quads left of and above it
+		for(long j = 0; j < MINIMAP_MAX_Z; j++) {
+			for(long i = 0; i < MINIMAP_MAX_X; i++) {
+				
+				if(fog.revealed[i][j] == minimap[SHOWLEVEL].revealed[i][j]) {
+					continue;
+				}
+				
+				for(long y = j - 1; y <= j; y++) {
+					for(long x = i - 1; x <= i; x++) {
+						ARX_MINIMAP_UpdateFogQuad(SHOWLEVEL, fog.quads[MiniMapFog::quadIndex(x, y)]);
+					}
+				}
+			}
+		}
+		
+	} else {
+		
+		fog.level = SHOWLEVEL;
+		fog.flag = flag;
+		fog.fl2 = fl2;
+		fog.tc = minimap[SHOWLEVEL].tc;
+		fog.xratio = Xratio;
+		fog.yratio = Yratio;
+		fog.casex = casex;
+		fog.casey = casey;
+		
+		ARX_MINIMAP_CreateFogQuads(SHOWLEVEL);
+	}
+	
+	memcpy(fog.revealed, minimap[SHOWLEVEL].revealed, sizeof(fog.revealed));
+	
+	ARX_MINIMAP_BuildFogBatch(startx, starty);
+	
+	return fog.batch;
+}
+
+void ARX_MINIMAP_Show(long SHOWLEVEL, long flag, long fl2) {
 	
 	if (!pTexDetect)
 		pTexDetect = TextureContainer::Load("graph/particles/flare");
@@ -345,7 +717,7 @@ void ARX_MINIMAP_Show(long SHOWLEVEL, long flag, long fl2) {
 		ofy		= mini_offset_y[CURRENTLEVEL];
 		ofy2	= minimap[SHOWLEVEL].yratio;
 
-		if ((SHOWLEVEL == ARX_LEVELS_GetRealNum(CURRENTLEVEL)) || (flag == 2))
+		if (SHOWLEVEL == ARX_LEVELS_GetRealNum(CURRENTLEVEL))
 		{
 			// Computes playerpos
 			ofx = mini_offset_x[CURRENTLEVEL];
@@ -381,345 +753,71 @@ void ARX_MINIMAP_Show(long SHOWLEVEL, long flag, long fl2) {
 			verts[k].p.z = 0.00001f;
 		}
 
-		float div = ( 1.0f / 25 );
-		TextureContainer * tc = minimap[SHOWLEVEL].tc;
-		float dw = 1.f / tc->m_pTexture->getStoredSize().x; 
-		float dh = 1.f / tc->m_pTexture->getStoredSize().y;
-		
-		float vx2 = 4.f * dw * mod_x;
-		float vy2 = 4.f * dh * mod_z;
-
-		float _px;
-		Rect boundaries;
-		float MOD20, MOD20DIV, divXratio, divYratio;
-
-		boundaries.bottom = boundaries.left = boundaries.right = boundaries.top = 0;
-		MOD20 = MOD20DIV = divXratio = divYratio = 0.f;
+		GRenderer->SetRenderState(Renderer::AlphaBlending, true);
+		GRenderer->SetBlendFunc(Renderer::BlendZero, Renderer::BlendInvSrcColor);
+		GRenderer->GetTextureStage(0)->SetWrapMode(TextureStage::WrapClamp);
 
-		if (flag != 2)
+		if (fl2)
 		{
-
-			if (flag == 1)
-			{
-				MOD20 = 20.f * Xratio;
-				MOD20DIV = 1.f / (MOD20);
-				//@PERF do if(fl2){}else{} to make 4 and not 8 flot op if fl2.
-
-				boundaries.left = checked_range_cast<Rect::Num>((360 + MOD20) * Xratio);
-				boundaries.right = checked_range_cast<Rect::Num>((555 - MOD20) * Xratio);
-				boundaries.top = checked_range_cast<Rect::Num>((85 + MOD20) * Yratio);
-				boundaries.bottom = checked_range_cast<Rect::Num>((355 - MOD20) * Yratio);
-
-				if(fl2) {
-					boundaries.left = checked_range_cast<Rect::Num>((FL2_LEFT + MOD20) * Xratio);
-					boundaries.right = checked_range_cast<Rect::Num>((FL2_RIGHT - MOD20) * Xratio);
-					boundaries.top = checked_range_cast<Rect::Num>((FL2_TOP + MOD20) * Yratio);
-					boundaries.bottom = checked_range_cast<Rect::Num>((FL2_BOTTOM - MOD20) * Yratio);
-				}
-			}
-
-			GRenderer->SetRenderState(Renderer::AlphaBlending, true);
-			GRenderer->SetBlendFunc(Renderer::BlendZero, Renderer::BlendInvSrcColor);
-			GRenderer->GetTextureStage(0)->SetWrapMode(TextureStage::WrapClamp);
-
-			if (fl2)
-			{
-				GRenderer->SetBlendFunc(Renderer::BlendOne, Renderer::BlendInvSrcColor);
-			}
+			GRenderer->SetBlendFunc(Renderer::BlendOne, Renderer::BlendInvSrcColor);
 		}
-		else
-		{
-			divXratio = 1.f / Xratio;
-			divYratio = 1.f / Yratio;
-		}
-
-		for (long j = -2; j < MINIMAP_MAX_Z + 2; j++)
-		{
-			for (long i = -2; i < MINIMAP_MAX_X + 2; i++)
-			{
-				float vx, vy, vxx, vyy;
-				vxx = ((float)i * (float)ACTIVEBKG->Xdiv * mod_x);
-				vyy = ((float)j * (float)ACTIVEBKG->Zdiv * mod_z);
-				vx = (vxx * div) * dw;
-				vy = (vyy * div) * dh;
-
-				long okay = 1;
-				float posx = (startx + i * casex) * Xratio;
-				float posy = (starty + j * casey) * Yratio;
-
-				if (flag == 1)
-				{
-
-					if	((posx < 360 * Xratio)
-							||	(posx > 555 * Xratio)
-							||	(posy < 85 * Yratio)
-							||	(posy > 355 * Yratio))
-						okay = 0;
-
-					if (fl2)
-					{
-						okay = 1;
-
-						if	((posx < FL2_LEFT * Xratio)
-						        ||	(posx > FL2_RIGHT * Xratio)
-						        ||	(posy < FL2_TOP * Yratio)
-						        ||	(posy > FL2_BOTTOM * Yratio))
-							okay = 0;
-					}
-
-				}
-				else
-				{
-					if ((posx > 345 * Xratio)
-							||	(posy > 290 * Yratio))
-						okay = 0;
-				}
-
-				if (okay)
-				{
-					if ((flag == 2)
-							&& (i >= 0) && (i < MINIMAP_MAX_X)
-							&& (j >= 0) && (j < MINIMAP_MAX_Z))
-					{
-						float d = fdist(Vec2f(posx * divXratio + casex * ( 1.0f / 2 ), posy * divYratio), Vec2f(px, py));
-
-						if (d <= 6.f)
-						{
-							long r;
-							float vv = (6 - d) * ( 1.0f / 6 );
-
-							if (vv >= 0.5f)
-								vv = 1.f;
-							else if (vv > 0.f)
-								vv = vv * 2.f;
-							else
-								vv = 0.f;
-
-							r = vv * 255.f;
-
-
-							long ucLevel =  max(r, (long)minimap[SHOWLEVEL].revealed[i][j]);
-
-							minimap[SHOWLEVEL].revealed[i][j] = checked_range_cast<unsigned char>(ucLevel);
-
-
-						}
-					}
-
-					verts[3].p.x = verts[0].p.x = (posx);
-					verts[1].p.y = verts[0].p.y = (posy);
-					verts[2].p.x = verts[1].p.x = posx + (casex * Xratio);
-					verts[3].p.y = verts[2].p.y = posy + (casey * Yratio);
-
-					verts[3].uv.x = verts[0].uv.x = vx;
-					verts[1].uv.y = verts[0].uv.y = vy;
-					verts[2].uv.x = verts[1].uv.x = vx + vx2;
-					verts[3].uv.y = verts[2].uv.y = vy + vy2;
-
-					if (flag != 2)
-					{
-						float v;
-						float oo = 0.f;
-
-						if ((i < 0) || (i >= MINIMAP_MAX_X) || (j < 0) || (j >= MINIMAP_MAX_Z)) v = 0;
-						else v = ((float)minimap[SHOWLEVEL].revealed[i][j]) * ( 1.0f / 255 );
 
-						if (flag == 1)
-						{
-							long vert = 0;
-							_px = verts[vert].p.x - boundaries.left;
-
-							if (_px < 0.f) v = 0.f;
-							else if (_px < MOD20) v *= _px * MOD20DIV;
-
-							_px = boundaries.right - verts[vert].p.x;
-
-							if (_px < 0.f) v = 0.f;
-							else if (_px < MOD20) v *= _px * MOD20DIV;
-
-							_px = verts[vert].p.y - boundaries.top;
-
-							if (_px < 0.f) v = 0.f;
-							else if (_px < MOD20) v *= _px * MOD20DIV;
-
-							_px = boundaries.bottom - verts[vert].p.y;
-
-							if (_px < 0.f) v = 0.f;
-							else if (_px < MOD20) v *= _px * MOD20DIV;
-						}
-
-						verts[0].color = Color::gray(fl2 ? v * (1.f/2) : v).toBGR();
-
-						oo += v;
-
-						if ((i + 1 < 0) || (i + 1 >= MINIMAP_MAX_X) || (j < 0) || (j >= MINIMAP_MAX_Z)) v = 0;
-						else v = ((float)minimap[SHOWLEVEL].revealed[min((int)i+1, MINIMAP_MAX_X-1)][j]) * ( 1.0f / 255 );
-
-						if (flag == 1)
-						{
-							long vert = 1;
-							_px = verts[vert].p.x - boundaries.left;
-
-							if (_px < 0.f) v = 0.f;
-							else if (_px < MOD20) v *= _px * MOD20DIV;
-
-							_px = boundaries.right - verts[vert].p.x;
-
-							if (_px < 0.f) v = 0.f;
-							else if (_px < MOD20) v *= _px * MOD20DIV;
-
-							_px = verts[vert].p.y - boundaries.top;
-
-							if (_px < 0.f) v = 0.f;
-							else if (_px < MOD20) v *= _px * MOD20DIV;
-
-							_px = boundaries.bottom - verts[vert].p.y;
-
-							if (_px < 0.f) v = 0.f;
-							else if (_px < MOD20) v *= _px * MOD20DIV;
-						}
-
-						verts[1].color = Color::gray(fl2 ? v * ( 1.0f / 2 ) : v).toBGR();
-
-						oo += v;
-
-						if ((i + 1 < 0) || (i + 1 >= MINIMAP_MAX_X) || (j + 1 < 0) || (j + 1 >= MINIMAP_MAX_Z)) v = 0;
-						else v = ((float)minimap[SHOWLEVEL].revealed[min((int)i+1, MINIMAP_MAX_X-1)][min((int)j+1, MINIMAP_MAX_Z-1)]) * ( 1.0f / 255 );
-
-						if (flag == 1)
-						{
-							long vert = 2;
-							_px = verts[vert].p.x - boundaries.left;
-
-							if (_px < 0.f) v = 0.f;
-							else if (_px < MOD20) v *= _px * MOD20DIV;
-
-							_px = boundaries.right - verts[vert].p.x;
-
-							if (_px < 0.f) v = 0.f;
-							else if (_px < MOD20) v *= _px * MOD20DIV;
-
-							_px = verts[vert].p.y - boundaries.top;
-
-							if (_px < 0.f) v = 0.f;
-							else if (_px < MOD20) v *= _px * MOD20DIV;
-
-							_px = boundaries.bottom - verts[vert].p.y;
-
-							if (_px < 0.f) v = 0.f;
-							else if (_px < MOD20) v *= _px * MOD20DIV;
-						}
-						
-
-						verts[2].color = Color::gray(fl2 ? v * (1.f/2) : v).toBGR();
-
-						oo += v;
-
-						if ((i < 0) || (i >= MINIMAP_MAX_X) || (j + 1 < 0) || (j + 1 >= MINIMAP_MAX_Z)) v = 0;
-						else v = ((float)minimap[SHOWLEVEL].revealed[i][min((int)j+1, MINIMAP_MAX_Z-1)]) * ( 1.0f / 255 );
-
-						if (flag == 1)
-						{
-							long vert = 3;
-							_px = verts[vert].p.x - boundaries.left;
-
-							if (_px < 0.f) v = 0.f;
-							else if (_px < MOD20) v *= _px * MOD20DIV;
-
-							_px = boundaries.right - verts[vert].p.x;
+		const std::vector<TexturedVertex> & fog = ARX_MINIMAP_UpdateFog(SHOWLEVEL, flag, fl2,
+		                                                                startx, starty, casex, casey);
+		if(!fog.empty()) {
+			EERIEDRAWPRIM(Renderer::TriangleList, &fog[0], fog.size());
+		}
 
-							if (_px < 0.f) v = 0.f;
-							else if (_px < MOD20) v *= _px * MOD20DIV;
+		GRenderer->GetTextureStage(0)->SetWrapMode(TextureStage::WrapRepeat);
+		GRenderer->SetRenderState(Renderer::AlphaBlending, false);
 
-							_px = verts[vert].p.y - boundaries.top;
+		if(SHOWLEVEL == ARX_LEVELS_GetRealNum(CURRENTLEVEL)) {
+			
+			// Now Draws Playerpos/angle
+			verts[0].color = 0xFFFF0000;
+			verts[1].color = 0xFFFF0000;
+			verts[2].color = 0xFFFF0000;
+			float val;
 
-							if (_px < 0.f) v = 0.f;
-							else if (_px < MOD20) v *= _px * MOD20DIV;
+			if (flag == 1) val = 6.f;
+			else val = 3.f;
 
-							_px = boundaries.bottom - verts[vert].p.y;
+			if (fl2) val = FL2_PLAYERSIZE;
 
-							if (_px < 0.f) v = 0.f;
-							else if (_px < MOD20) v *= _px * MOD20DIV;
-						}
+			float rx = 0.f;
+			float ry = -val * 1.8f;
+			float rx2 = -val * ( 1.0f / 2 );
+			float ry2 = val;
+			float rx3 = val * ( 1.0f / 2 );
+			float ry3 = val;
 
-						verts[3].color = Color::gray(fl2 ? v * (1.f/2) : v).toBGR();
+			float angle = radians(player.angle.b);
+			float ca = EEcos(angle);
+			float sa = EEsin(angle);
 
-						oo += v;
+			verts[0].p.x = (px + rx2 * ca + ry2 * sa) * Xratio;
+			verts[0].p.y = (py + ry2 * ca - rx2 * sa) * Yratio;
+			verts[1].p.x = (px + rx * ca + ry * sa) * Xratio;
+			verts[1].p.y = (py + ry * ca - rx * sa) * Yratio;
+			verts[2].p.x = (px + rx3 * ca + ry3 * sa) * Xratio;
+			verts[2].p.y = (py + ry3 * ca - rx3 * sa) * Yratio;
 
-						if (oo > 0.f)
-						{
-							if (fl2)
-							{
-								verts[0].p.x += DECALX * Xratio;
-								verts[0].p.y += DECALY * Yratio;
-								verts[1].p.x += DECALX * Xratio;
-								verts[1].p.y += DECALY * Yratio;
-								verts[2].p.x += DECALX * Xratio;
-								verts[2].p.y += DECALY * Yratio;
-								verts[3].p.x += DECALX * Xratio;
-								verts[3].p.y += DECALY * Yratio;
-							}
+			GRenderer->ResetTexture(0);
 
-							EERIEDRAWPRIM(Renderer::TriangleFan, verts, 4);
-						}
-					}
-				}
+			if (fl2)
+			{
+				GRenderer->SetRenderState(Renderer::AlphaBlending, true);
+				verts[0].p.x += DECALX * Xratio;
+				verts[0].p.y += DECALY * Yratio;
+				verts[1].p.x += DECALX * Xratio;
+				verts[1].p.y += DECALY * Yratio;
+				verts[2].p.x += DECALX * Xratio;
+				verts[2].p.y += DECALY * Yratio;
 			}
-		}
 
-		if (flag != 2)
-		{
-			GRenderer->GetTextureStage(0)->SetWrapMode(TextureStage::WrapRepeat);
-			GRenderer->SetRenderState(Renderer::AlphaBlending, false);
+			EERIEDRAWPRIM(Renderer::TriangleFan, verts);
 
-			if(SHOWLEVEL == ARX_LEVELS_GetRealNum(CURRENTLEVEL)) {
-				
-				// Now Draws Playerpos/angle
-				verts[0].color = 0xFFFF0000;
-				verts[1].color = 0xFFFF0000;
-				verts[2].color = 0xFFFF0000;
-				float val;
-
-				if (flag == 1) val = 6.f;
-				else val = 3.f;
-
-				if (fl2) val = FL2_PLAYERSIZE;
-
-				float rx = 0.f;
-				float ry = -val * 1.8f;
-				float rx2 = -val * ( 1.0f / 2 );
-				float ry2 = val;
-				float rx3 = val * ( 1.0f / 2 );
-				float ry3 = val;
-
-				float angle = radians(player.angle.b);
-				float ca = EEcos(angle);
-				float sa = EEsin(angle);
-
-				verts[0].p.x = (px + rx2 * ca + ry2 * sa) * Xratio;
-				verts[0].p.y = (py + ry2 * ca - rx2 * sa) * Yratio;
-				verts[1].p.x = (px + rx * ca + ry * sa) * Xratio;
-				verts[1].p.y = (py + ry * ca - rx * sa) * Yratio;
-				verts[2].p.x = (px + rx3 * ca + ry3 * sa) * Xratio;
-				verts[2].p.y = (py + ry3 * ca - rx3 * sa) * Yratio;
-
-				GRenderer->ResetTexture(0);
-
-				if (fl2)
-				{
-					GRenderer->SetRenderState(Renderer::AlphaBlending, true);
-					verts[0].p.x += DECALX * Xratio;
-					verts[0].p.y += DECALY * Yratio;
-					verts[1].p.x += DECALX * Xratio;
-					verts[1].p.y += DECALY * Yratio;
-					verts[2].p.x += DECALX * Xratio;
-					verts[2].p.y += DECALY * Yratio;
-				}
-
-				EERIEDRAWPRIM(Renderer::TriangleFan, verts);
-
-				if (fl2) GRenderer->SetRenderState(Renderer::AlphaBlending, false);
-			}
+			if (fl2) GRenderer->SetRenderState(Renderer::AlphaBlending, false);
 		}
 
 		// tsu
@@ -249,7 +249,7 @@ void ARX_SPEECH_Launch_No_Unicode_Seek(const string & text, Entity * io_source,
 	{
 		aspeech[speechnum].scrpos = -1;
 		aspeech[speechnum].es = NULL;
-		aspeech[speechnum].ioscript = io_source;
+		aspeech[speechnum].ioscript = entities.handle(io_source);
 		aspeech[speechnum].flags = 0;
 		CinematicSpeech acs;
 		acs.type = ARX_CINE_SPEECH_NONE;
@@ -303,8 +303,10 @@ long ARX_SPEECH_GetFree() {
 
 long ARX_SPEECH_GetIOSpeech(Entity * io) {
 	
+	EntityHandle handle = entities.handle(io);
+	
 	for(size_t i = 0; i < MAX_ASPEECH; i++) {
-		if(aspeech[i].exist && aspeech[i].io == io) {
+		if(aspeech[i].exist && aspeech[i].io == handle) {
 			return i;
 		}
 	}
@@ -318,9 +320,10 @@ void ARX_SPEECH_Release(long i) {
 		
 		ARX_SOUND_Stop(aspeech[i].sample);
 		
-		if(ValidIOAddress(aspeech[i].io) && aspeech[i].io->animlayer[2].cur_anim) {
-			AcquireLastAnim(aspeech[i].io);
-			aspeech[i].io->animlayer[2].cur_anim = NULL;
+		Entity * io = entities.get(aspeech[i].io);
+		if(io && io->animlayer[2].cur_anim) {
+			AcquireLastAnim(io);
+			io->animlayer[2].cur_anim = NULL;
 		}
 		
 		aspeech[i].clear();
@@ -329,8 +332,10 @@ void ARX_SPEECH_Release(long i) {
 
 void ARX_SPEECH_ReleaseIOSpeech(Entity * io) {
 	
+	EntityHandle handle = entities.handle(io);
+	
 	for(size_t i = 0; i < MAX_ASPEECH; i++) {
-		if(aspeech[i].exist && aspeech[i].io == io) {
+		if(aspeech[i].exist && aspeech[i].io == handle) {
 			ARX_SPEECH_Release(i);
 		}
 	}
@@ -348,18 +353,20 @@ void ARX_SPEECH_ClearIOSpeech(Entity * io) {
 		return;
 	}
 	
+	EntityHandle handle = entities.handle(io);
+	
 	for(size_t i = 0; i < MAX_ASPEECH; i++) {
 		
-		if(!aspeech[i].exist || aspeech[i].io != io) {
+		if(!aspeech[i].exist || aspeech[i].io != handle) {
 			continue;
 		}
 		
 		EERIE_SCRIPT * es = aspeech[i].es;
-		Entity * io = aspeech[i].ioscript;
+		Entity * io = entities.get(aspeech[i].ioscript);
 		long scrpos = aspeech[i].scrpos;
 		ARX_SPEECH_Release(i);
 		
-		if(es && ValidIOAddress(io)) {
+		if(es && io) {
 			ScriptEvent::send(es, SM_EXECUTELINE, "", io, "", scrpos);
 		}
 	}
@@ -382,7 +389,7 @@ long ARX_SPEECH_AddSpeech(Entity * io, const std::string & data, long mood,
 	
 	aspeech[num].exist = 1;
 	aspeech[num].time_creation = arxtime.get_updated_ul();
-	aspeech[num].io = io; // can be NULL
+	aspeech[num].io = entities.handle(io); // can be NULL
 	aspeech[num].duration = 2000; // Minimum value
 	aspeech[num].flags = flags;
 	aspeech[num].sample = -1;
@@ -468,7 +475,7 @@ void ARX_SPEECH_Update() {
 	{
 		if (aspeech[i].exist)
 		{
-			Entity * io = aspeech[i].io;
+			Entity * io = entities.get(aspeech[i].io);
 
 			// updates animations
 			if (io)
@@ -478,8 +485,7 @@ void ARX_SPEECH_Update() {
 				else
 					ARX_SOUND_RefreshSpeechPosition(aspeech[i].sample, io);
 
-				if (((io != entities.player()) || ((io == entities.player())  && (EXTERNALVIEW)))
-						&&	ValidIOAddress(io))
+				if ((io != entities.player()) || ((io == entities.player())  && (EXTERNALVIEW)))
 				{
 					if (io->anims[aspeech[i].mood] == NULL)	aspeech[i].mood = ANIM_TALK_NEUTRAL;
 
@@ -499,12 +505,11 @@ void ARX_SPEECH_Update() {
 			if (tim >= aspeech[i].time_creation + aspeech[i].duration)
 			{
 				EERIE_SCRIPT	*	es		= aspeech[i].es;
-				Entity	* io		= aspeech[i].ioscript;
+				Entity	* io		= entities.get(aspeech[i].ioscript);
 				long				scrpos	= aspeech[i].scrpos;
 				ARX_SPEECH_Release(i);
 
-				if ((es)
-						&&	(ValidIOAddress(io)))
+				if ((es) && (io))
 					ScriptEvent::send(es, SM_EXECUTELINE, "", io, "", scrpos);
 			}
 		}
@@ -518,14 +523,14 @@ void ARX_SPEECH_Update() {
 		{
 			if (!speech->text.empty())
 			{
-				if ((ARX_CONVERSATION) && (speech->io))
+				if ((ARX_CONVERSATION) && !speech->io.isNull())
 				{
 					long ok = 0;
 
 					for (long j = 0 ; j < main_conversation.actors_nb ; j++)
 					{
 						if (main_conversation.actors[j] >= 0)
-							if (speech->io == entities[main_conversation.actors[j]])
+							if (speech->io == entities.handle(entities[main_conversation.actors[j]]))
 							{
 								ok = 1;
 							}
@@ -622,12 +627,13 @@ void ARX_SPEECH_Update() {
 
 bool ApplySpeechPos(EERIE_CAMERA * conversationcamera, long is) {
 	
-	if(is < 0 || !aspeech[is].io) {
+	Entity * io = (is < 0) ? NULL : entities.get(aspeech[is].io);
+	if(!io) {
 		return false;
 	}
 	
-	conversationcamera->d_pos = aspeech[is].io->pos + player.baseOffset();
-	float t = (aspeech[is].io->angle.b);
+	conversationcamera->d_pos = io->pos + player.baseOffset();
+	float t = (io->angle.b);
 	conversationcamera->pos = conversationcamera->d_pos;
 	conversationcamera->pos += Vec3f(EEsin(t) * 100.f, 0.f, -EEcos(t) * 100.f);
 	return true;
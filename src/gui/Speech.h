@@ -50,6 +50,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #include <string>
 
 #include "audio/AudioTypes.h"
+#include "game/EntityManager.h"
 #include "math/Angle.h"
 
 struct EERIE_CAMERA;
@@ -141,8 +142,8 @@ struct ARX_SPEECH {
 	int iTimeScroll;
 	float fPixelScroll;
 	std::string text;
-	Entity * io;
-	Entity * ioscript;
+	EntityHandle io;
+	EntityHandle ioscript;
 	CinematicSpeech cine;
 	EERIE_SCRIPT * es;
 	long scrpos;
@@ -158,8 +159,8 @@ struct ARX_SPEECH {
 		iTimeScroll = 0;
 		fPixelScroll = 0;
 		text.clear();
-		io = NULL;
-		ioscript = NULL;
+		io = EntityHandle();
+		ioscript = EntityHandle();
 		cine.clear();
 		es = NULL;
 		scrpos = 0;
@@ -44,6 +44,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 
 #include "gui/Text.h"
 
+#include <map>
 #include <sstream>
 
 #include "core/Localisation.h"
@@ -55,6 +56,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 
 #include "graphics/Renderer.h"
 #include "graphics/Math.h"
+#include "graphics/font/Font.h"
 #include "graphics/font/FontCache.h"
 
 #include "io/resource/PakReader.h"
@@ -74,33 +76,62 @@ Font * hFontCredits = NULL;
 Font * hFontInGame = NULL;
 Font * hFontInGameNote = NULL;
 
-void ARX_UNICODE_FormattingInRect(Font * font, const std::string & text,
-                                  const Rect & rect, Color col, long * textHeight = 0,
-                                  long * numChars = 0, bool computeOnly = false) {
+namespace {
+
+struct TextLayoutKey {
+	
+	Font * font;
+	std::string text;
+	int width;
+	int height;
+	
+	TextLayoutKey(Font * _font, const std::string & _text, int _width, int _height)
+		: font(_font), text(_text), width(_width), height(_height) { }
+	
+	bool operator<(const TextLayoutKey & o) const {
+		if(font != o.font) {
+			return font < o.font;
+		}
+		if(width != o.width) {
+			return width < o.width;
+		}
+		if(height != o.height) {
+			return height < o.height;
+		}
+		return text < o.text;
+	}
+	
+};
+
+//! Text wrapped into a rectangle, positioned relative to the top-left corner
+struct TextLayout {
+	Font::GlyphQuads quads;
+	long height;
+	long numChars;
+};
+
+typedef std::map<TextLayoutKey, TextLayout> TextLayoutCache;
+
+//! Formatted text is cached as most strings are drawn unchanged for many frames
+TextLayoutCache textLayouts;
+
+const size_t MAX_CACHED_TEXT_LAYOUTS = 256;
+
+void layoutTextInRect(Font * font, const std::string & text, int maxLineWidth, int maxHeight,
+                      TextLayout & layout) {
 	
 	std::string::const_iterator itLastLineBreak = text.begin();
 	std::string::const_iterator itLastWordBreak = text.begin();
 	std::string::const_iterator it = text.begin();
 	
-	int maxLineWidth;
-	if(rect.right == Rect::Limits::max()) {
-		maxLineWidth = std::numeric_limits<int>::max();
-	} else {
-		maxLineWidth = rect.width();
-	}
 	arx_assert(maxLineWidth > 0);
-	int penY = rect.top;
+	int penY = 0;
 	
-	if(textHeight) {
-		*textHeight = 0;
-	}
-	
-	if(numChars) {
-		*numChars = 0;
-	}
+	layout.height = 0;
+	layout.numChars = 0;
 	
 	// Ensure we can at least draw one line...
-	if(penY + font->getLineHeight() > rect.bottom) {
+	if(penY + font->getLineHeight() > maxHeight) {
 		return;
 	}
 	
@@ -143,10 +174,8 @@ void ARX_UNICODE_FormattingInRect(Font * font, const std::string & text,
 			
 			itTextEnd = (isLineBreak) ? it : it + 1;
 			
-			// Draw the line
-			if(!computeOnly) {
-				font->draw(rect.left, penY, itTextStart, itTextEnd, col);
-			}
+			// Position the line
+			font->layout(0, penY, itTextStart, itTextEnd, layout.quads);
 			
 			if(it != text.end()) {
 				itLastLineBreak = it + 1;
@@ -155,20 +184,69 @@ void ARX_UNICODE_FormattingInRect(Font * font, const std::string & text,
 			penY += font->getLineHeight();
 			
 			// Validate that the new line will fit inside the rect...
-			if(penY + font->getLineHeight() > rect.bottom) {
+			if(penY + font->getLineHeight() > maxHeight) {
 				break;
 			}
 		}
 	}
 	
+	layout.height = penY;
+	layout.numChars = it - text.begin();
+}
+
+const TextLayout & getTextLayout(Font * font, const std::string & text, const Rect & rect) {
+	
+	int maxLineWidth;
+	if(rect.right == Rect::Limits::max()) {
+		maxLineWidth = std::numeric_limits<int>::max();
+	} else {
+		maxLineWidth = rect.width();
+	}
+	
+	int maxHeight;
+	if(rect.bottom == Rect::Limits::max()) {
+		maxHeight = std::numeric_limits<int>::max();
+	} else {
+		maxHeight = rect.height();
+	}
+	
+	TextLayoutKey key(font, text, maxLineWidth, maxHeight);
+	
+	TextLayoutCache::iterator it = textLayouts.find(key);
+	if(it != textLayouts.end()) {
+		return it->second;
+	}
+	
+	if(textLayouts.size() >= MAX_CACHED_TEXT_LAYOUTS) {
+		textLayouts.clear();
+	}
+	
+	TextLayout & layout = textLayouts[key];
+	layoutTextInRect(font, text, maxLineWidth, maxHeight, layout);
+	
+	return layout;
+}
+
+} // anonymous namespace
+
+void ARX_UNICODE_FormattingInRect(Font * font, const std::string & text,
+                                  const Rect & rect, Color col, long * textHeight = 0,
+                                  long * numChars = 0, bool computeOnly = false) {
+	
+	const TextLayout & layout = getTextLayout(font, text, rect);
+	
+	if(!computeOnly) {
+		font->draw(rect.left, rect.top, layout.quads, col);
+	}
+	
 	// Return text height
 	if(textHeight) {
-		*textHeight = penY - rect.top;
+		*textHeight = layout.height;
 	}
 	
 	// Return num characters displayed
 	if(numChars) {
-		*numChars = it - text.begin();
+		*numChars = layout.numChars;
 	}
 }
 
@@ -190,6 +268,8 @@ long ARX_UNICODE_DrawTextInRect(Font* font,
 	
 	Rect previousViewport;
 	if(pClipRect) {
+		// Queued text must be drawn with the viewport it was queued for
+		Font::flushBatch();
 		previousViewport = GRenderer->GetViewport();
 		GRenderer->SetViewport(*pClipRect); 
 	}
@@ -203,6 +283,7 @@ long ARX_UNICODE_DrawTextInRect(Font* font,
 	ARX_UNICODE_FormattingInRect(font, _text, rect, col, &height);
 
 	if(pClipRect) {
+		Font::flushBatch();
 		GRenderer->SetViewport(previousViewport);
 	}
 
@@ -350,6 +431,8 @@ bool ARX_Text_Init() {
 	}
 	created_font_scale = scale;
 	
+	textLayouts.clear();
+	
 	// Keep small font small when increasing resolution
 	// TODO font size jumps around scale = 1
 	float small_scale = scale > 1.0f ? scale * 0.8f : scale;
@@ -406,6 +489,8 @@ void ARX_Text_Close() {
 	
 	created_font_scale = 0.f;
 	
+	textLayouts.clear();
+	
 	delete pTextManage;
 	pTextManage = NULL;
 	
@@ -156,6 +156,10 @@ void TextManager::Update(float _fDiffFrame) {
 }
 
 void TextManager::Render() {
+	
+	// Draw all entries with one draw call per font texture page
+	Font::beginBatch();
+	
 	vector<ManagedText *>::const_iterator itManage = entries.begin();
 	for(; itManage != entries.end(); ++itManage) {
 		
@@ -180,6 +184,8 @@ void TextManager::Render() {
 		
 		pArxText->rRect.bottom = pArxText->rRect.top + height;
 	}
+	
+	Font::endBatch();
 }
 
 void TextManager::Clear() {
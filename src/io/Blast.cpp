@@ -42,8 +42,10 @@
 #include <csetjmp> /* for setjmp(), longjmp(), and jmp_buf */
 #include <cstring>
 #include <cstdlib>
+#include <algorithm>
 
 #include "io/log/Logger.h"
+#include "platform/Platform.h"
 
 #define MAXBITS 13              /* maximum code length */
 #define MAXWIN 4096             /* maximum window size */
@@ -254,6 +256,26 @@ static int construct(huffman * h, const unsigned char * rep, int n) {
 	return left;
 }
 
+/* bit lengths of literal codes */
+static const unsigned char litlen[] = {
+	11, 124, 8, 7, 28, 7, 188, 13, 76, 4, 10, 8, 12, 10, 12, 10, 8, 23, 8,
+	9, 7, 6, 7, 8, 7, 6, 55, 8, 23, 24, 12, 11, 7, 9, 11, 12, 6, 7, 22, 5,
+	7, 24, 6, 11, 9, 6, 7, 22, 7, 11, 38, 7, 9, 8, 25, 11, 8, 11, 9, 12,
+	8, 12, 5, 38, 5, 38, 5, 11, 7, 5, 6, 21, 6, 10, 53, 8, 7, 24, 10, 27,
+	44, 253, 253, 253, 252, 252, 252, 13, 12, 45, 12, 45, 12, 61, 12, 45,
+	44, 173
+};
+/* bit lengths of length codes 0..15 */
+static const unsigned char lenlen[] = {2, 35, 36, 53, 38, 23};
+/* bit lengths of distance codes 0..63 */
+static const unsigned char distlen[] = {2, 20, 53, 230, 247, 151, 248};
+static const short base[16] = {     /* base for length codes */
+	3, 2, 4, 5, 6, 7, 8, 9, 10, 12, 16, 24, 40, 72, 136, 264
+};
+static const char extra[16] = {     /* extra bits for length codes */
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8
+};
+
 /*
  * Decode PKWare Compression Library stream.
  *
@@ -308,25 +330,6 @@ static BlastResult blastDecompress(state * s) {
 	static huffman litcode = {litcnt, litsym};   /* length code */
 	static huffman lencode = {lencnt, lensym};   /* length code */
 	static huffman distcode = {distcnt, distsym};/* distance code */
-	/* bit lengths of literal codes */
-	static const unsigned char litlen[] = {
-		11, 124, 8, 7, 28, 7, 188, 13, 76, 4, 10, 8, 12, 10, 12, 10, 8, 23, 8,
-		9, 7, 6, 7, 8, 7, 6, 55, 8, 23, 24, 12, 11, 7, 9, 11, 12, 6, 7, 22, 5,
-		7, 24, 6, 11, 9, 6, 7, 22, 7, 11, 38, 7, 9, 8, 25, 11, 8, 11, 9, 12,
-		8, 12, 5, 38, 5, 38, 5, 11, 7, 5, 6, 21, 6, 10, 53, 8, 7, 24, 10, 27,
-		44, 253, 253, 253, 252, 252, 252, 13, 12, 45, 12, 45, 12, 61, 12, 45,
-		44, 173
-	};
-	/* bit lengths of length codes 0..15 */
-	static const unsigned char lenlen[] = {2, 35, 36, 53, 38, 23};
-	/* bit lengths of distance codes 0..63 */
-	static const unsigned char distlen[] = {2, 20, 53, 230, 247, 151, 248};
-	static const short base[16] = {     /* base for length codes */
-		3, 2, 4, 5, 6, 7, 8, 9, 10, 12, 16, 24, 40, 72, 136, 264
-	};
-	static const char extra[16] = {     /* extra bits for length codes */
-		0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8
-	};
 	
 	/* set up decoding tables (once--might not be thread-safe) */
 	if(virgin) {
@@ -494,35 +497,301 @@ int blastOutMemRealloc(void * Param, unsigned char * buf, size_t len) {
 	return 0;
 }
 
+/*
+ * Fast decoder for contiguous in-memory input and output.
+ *
+ * This decodes the same format as blastDecompress() above, but:
+ *
+ * - Up to 64 bits of input are kept in the bit buffer so that a whole
+ *   length/distance pair can usually be decoded without refilling.
+ *
+ * - Huffman codes are decoded with a single table lookup indexed by the next
+ *   MAXBITS bits of input instead of walking the code lengths one bit at a
+ *   time.
+ *
+ * - Output is written directly to the destination buffer, which also serves
+ *   as the sliding window.
+ */
+
+namespace {
+
+/* decoded symbol and code length for one MAXBITS-bit input pattern */
+struct BlastTableEntry {
+	short symbol;       /* decoded symbol */
+	unsigned char len;  /* code length, or zero if the code is invalid */
+};
+
+struct BlastTable {
+	BlastTableEntry entry[1 << MAXBITS];
+};
+
+/*
+ * Fill the lookup table for the canonical code described by h by decoding
+ * every possible MAXBITS-bit input pattern the same way decode() does.
+ */
+void blastBuildTable(const huffman & h, BlastTable & table) {
+	
+	for(int pattern = 0; pattern < (1 << MAXBITS); pattern++) {
+		
+		BlastTableEntry & e = table.entry[pattern];
+		e.symbol = 0;
+		e.len = 0;
+		
+		int code = 0, first = 0, index = 0;
+		for(int len = 1; len <= MAXBITS; len++) {
+			code |= ((pattern >> (len - 1)) & 1) ^ 1; /* invert code */
+			int count = h.count[len];
+			if(code < first + count) {
+				e.symbol = h.symbol[index + (code - first)];
+				e.len = (unsigned char)len;
+				break;
+			}
+			index += count;
+			first += count;
+			first <<= 1;
+			code <<= 1;
+		}
+	}
+}
+
+struct BlastTables {
+	
+	BlastTable lit;
+	BlastTable len;
+	BlastTable dist;
+	
+	BlastTables() {
+		
+		short litcnt[MAXBITS+1], litsym[256];
+		short lencnt[MAXBITS+1], lensym[16];
+		short distcnt[MAXBITS+1], distsym[64];
+		huffman litcode = {litcnt, litsym};
+		huffman lencode = {lencnt, lensym};
+		huffman distcode = {distcnt, distsym};
+		
+		construct(&litcode, litlen, sizeof(litlen));
+		construct(&lencode, lenlen, sizeof(lenlen));
+		construct(&distcode, distlen, sizeof(distlen));
+		
+		blastBuildTable(litcode, lit);
+		blastBuildTable(lencode, len);
+		blastBuildTable(distcode, dist);
+	}
+	
+};
+
+/* built during static initialization so that the fast decoder is thread-safe */
+const BlastTables blastTables;
+
+/* input state for the fast decoder */
+class BlastBitReader {
+	
+	const unsigned char * in;
+	const unsigned char * end;
+	u64 bitbuf;
+	unsigned bitcnt;
+	
+public:
+	
+	BlastBitReader(const unsigned char * data, size_t size)
+		: in(data), end(data + size), bitbuf(0), bitcnt(0) { }
+	
+	/* load as many whole bytes as fit into the bit buffer */
+	void refill() {
+		while(bitcnt <= 56 && in != end) {
+			bitbuf |= u64(*in++) << bitcnt;
+			bitcnt += 8;
+		}
+	}
+	
+	/* get need <= 32 bits, returns false if there is not enough input */
+	bool bits(unsigned need, int & val) {
+		if(bitcnt < need) {
+			refill();
+			if(bitcnt < need) {
+				return false;
+			}
+		}
+		val = int(bitbuf & ((u64(1) << need) - 1));
+		bitbuf >>= need;
+		bitcnt -= need;
+		return true;
+	}
+	
+	/* decode a symbol, returns -1 for a truncated input and -9 for an invalid code */
+	int decode(const BlastTable & table) {
+		if(bitcnt < MAXBITS) {
+			refill();
+		}
+		const BlastTableEntry & e = table.entry[bitbuf & ((1 << MAXBITS) - 1)];
+		if(e.len == 0) {
+			/* ran out of codes, or the (zero-padded) end of the input */
+			return (bitcnt < MAXBITS) ? -1 : -9;
+		}
+		if(e.len > bitcnt) {
+			return -1;
+		}
+		bitbuf >>= e.len;
+		bitcnt -= e.len;
+		return e.symbol;
+	}
+	
+};
+
+/* output to a fixed-size buffer */
+class BlastFixedOutput {
+	
+	unsigned char * buf;
+	size_t size;
+	
+public:
+	
+	BlastFixedOutput(char * data, size_t capacity)
+		: buf(reinterpret_cast<unsigned char *>(data)), size(capacity) { }
+	
+	unsigned char * data() { return buf; }
+	
+	bool reserve(size_t needed) { return needed <= size; }
+	
+};
+
+/* output to a growing buffer allocated with malloc() */
+class BlastGrowingOutput {
+	
+	unsigned char * buf;
+	size_t size;
+	
+public:
+	
+	BlastGrowingOutput() : buf(NULL), size(0) { }
+	
+	unsigned char * data() { return buf; }
+	
+	unsigned char * release() {
+		unsigned char * result = buf;
+		buf = NULL, size = 0;
+		return result;
+	}
+	
+	bool reserve(size_t needed) {
+		if(needed <= size) {
+			return true;
+		}
+		size_t newSize = std::max(needed, std::max(size * 2, size_t(MAXWIN)));
+		unsigned char * newBuf = (unsigned char *)realloc(buf, newSize);
+		if(!newBuf) {
+			return false;
+		}
+		buf = newBuf, size = newSize;
+		return true;
+	}
+	
+	~BlastGrowingOutput() { free(buf); }
+	
+};
+
+template <class Output>
+BlastResult blastMemDecompress(const char * from, size_t fromSize, Output & out,
+                               size_t & outSize) {
+	
+	BlastBitReader s(reinterpret_cast<const unsigned char *>(from), fromSize);
+	size_t next = 0;
+	outSize = 0;
+	
+	/* read header */
+	int lit, dict;
+	if(!s.bits(8, lit)) return BLAST_TRUNCATED_INPUT;
+	if(lit > 1) return BLAST_INVALID_LITERAL_FLAG;
+	if(!s.bits(8, dict)) return BLAST_TRUNCATED_INPUT;
+	if(dict < 4 || dict > 6) return BLAST_INVALID_DIC_SIZE;
+	
+	/* decode literals and length/distance pairs */
+	while(true) {
+		
+		int flag;
+		if(!s.bits(1, flag)) return BLAST_TRUNCATED_INPUT;
+		
+		if(flag) {
+			
+			/* get length */
+			int symbol = s.decode(blastTables.len);
+			if(symbol < 0) {
+				/* an invalid code can only occur at the end of the input */
+				return BLAST_TRUNCATED_INPUT;
+			}
+			int extraBits;
+			if(!s.bits(extra[symbol], extraBits)) return BLAST_TRUNCATED_INPUT;
+			size_t len = base[symbol] + extraBits;
+			if(len == 519) break; /* end code */
+			
+			/* get distance */
+			unsigned shift = (len == 2) ? 2 : dict;
+			symbol = s.decode(blastTables.dist);
+			if(symbol < 0) return BLAST_TRUNCATED_INPUT;
+			int low;
+			if(!s.bits(shift, low)) return BLAST_TRUNCATED_INPUT;
+			size_t dist = (size_t(symbol) << shift) + low + 1;
+			if(dist > next) return BLAST_INVALID_OFFSET;
+			
+			/* copy length bytes from distance bytes back, may overlap */
+			if(!out.reserve(next + len)) return BLAST_OUTPUT_ERROR;
+			unsigned char * to = out.data() + next;
+			const unsigned char * src = to - dist;
+			next += len;
+			if(dist >= len) {
+				memcpy(to, src, len);
+			} else {
+				do {
+					*to++ = *src++;
+				} while(--len);
+			}
+			
+		} else {
+			
+			/* get literal and write it */
+			int symbol;
+			if(lit) {
+				symbol = s.decode(blastTables.lit);
+				if(symbol < 0) return BLAST_TRUNCATED_INPUT;
+			} else if(!s.bits(8, symbol)) {
+				return BLAST_TRUNCATED_INPUT;
+			}
+			if(!out.reserve(next + 1)) return BLAST_OUTPUT_ERROR;
+			out.data()[next++] = (unsigned char)symbol;
+			
+		}
+	}
+	
+	outSize = next;
+	return BLAST_SUCCESS;
+}
+
+} // anonymous namespace
+
 char * blastMemAlloc(const char * from, size_t fromSize, size_t & toSize) {
 	
-	BlastMemInBuffer in(from, fromSize);
-	BlastMemOutBufferRealloc out;
+	BlastGrowingOutput out;
 	
-	BlastResult error = blast(blastInMem, &in, blastOutMemRealloc, &out);
+	BlastResult error = blastMemDecompress(from, fromSize, out, toSize);
 	if(error) {
 		LogError << "blastMemAlloc error " << error << " for " << fromSize;
 		toSize = 0;
 		return NULL;
 	}
 	
-	// TODO realloc to fit fill size?
-	
-	toSize = out.fillSize;
-	return out.buf;
+	return reinterpret_cast<char *>(out.release());
 }
 
-
 size_t blastMem(const char * from, size_t fromSize, char * to, size_t toSize) {
 	
-	BlastMemInBuffer in(from, fromSize);
-	BlastMemOutBuffer out(to, toSize);
+	BlastFixedOutput out(to, toSize);
 	
-	BlastResult error = blast(blastInMem, &in, blastOutMem, &out);
+	size_t outSize;
+	BlastResult error = blastMemDecompress(from, fromSize, out, outSize);
 	if(error) {
 		LogError << "blastMem error " << error << " for " << fromSize << "/" << toSize;
 		return 0;
 	}
 	
-	return toSize - out.size;
+	return outSize;
 }
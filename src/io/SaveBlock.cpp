@@ -248,7 +248,8 @@ char * SaveBlock::File::loadData(std::istream & handle, size_t & size, const std
 	}
 }
 
-SaveBlock::SaveBlock(const fs::path & _savefile) : savefile(_savefile), totalSize(0), usedSize(0), chunkCount(0) { }
+SaveBlock::SaveBlock(const fs::path & _savefile)
+	: savefile(_savefile), version(SAV_VERSION_NOEXT), totalSize(0), usedSize(0), chunkCount(0) { }
 
 SaveBlock::~SaveBlock() { }
 
@@ -266,7 +267,6 @@ bool SaveBlock::loadFileTable() {
 	}
 	totalSize = fatOffset;
 	
-	u32 version;
 	if(fs::read(handle, version).fail()) {
 		return false;
 	}
@@ -336,6 +336,7 @@ void SaveBlock::writeFileTable(const std::string & important) {
 	handle.seekp(fatOffset + 4);
 	
 	fs::write(handle, SAV_VERSION_NOEXT);
+	version = SAV_VERSION_NOEXT;
 	
 	u32 nFiles = files.size();
 	fs::write(handle, nFiles);
@@ -568,6 +569,36 @@ vector<string> SaveBlock::getFiles() const {
 	return result;
 }
 
+bool SaveBlock::getFileInfo(const std::string & name, FileInfo & info) const {
+	
+	Files::const_iterator file = files.find(name);
+	if(file == files.end()) {
+		return false;
+	}
+	
+	info.storedSize = file->second.storedSize;
+	info.uncompressedSize = file->second.uncompressedSize;
+	info.chunks = file->second.chunks.size();
+	info.compression = file->second.compressionName();
+	
+	return true;
+}
+
+bool SaveBlock::isOutdated() const {
+	
+	if(version != SAV_VERSION_NOEXT) {
+		return true;
+	}
+	
+	for(Files::const_iterator file = files.begin(); file != files.end(); ++file) {
+		if(file->second.comp == File::ImplodeCrypt) {
+			return true;
+		}
+	}
+	
+	return false;
+}
+
 char * SaveBlock::load(const fs::path & savefile, const std::string & filename, size_t & size) {
 	
 	arx_assert_msg(filename.find_first_of(BADSAVCHAR) == string::npos,
@@ -101,6 +101,7 @@ private:
 	
 	fs::path savefile;
 	fs::fstream handle;
+	u32 version;
 	size_t totalSize;
 	size_t usedSize;
 	size_t chunkCount;
@@ -112,6 +113,14 @@ private:
 	
 public:
 	
+	//! Information about a file stored in the save block.
+	struct FileInfo {
+		size_t storedSize;
+		size_t uncompressedSize; //!< size_t(-1) if only known after loading the file
+		size_t chunks;
+		const char * compression;
+	};
+	
 	explicit SaveBlock(const fs::path & savefile);
 	
 	/*!
@@ -145,6 +154,15 @@ public:
 	
 	std::vector<std::string> getFiles() const;
 	
+	//! @return false if there is no file with the given name.
+	bool getFileInfo(const std::string & name, FileInfo & info) const;
+	
+	/*!
+	 * @return true if the file table uses an older format or if there are files
+	 *         stored with the old implode compression.
+	 */
+	bool isOutdated() const;
+	
 	/*!
 	 * Load a single file from the save block.
 	 * 
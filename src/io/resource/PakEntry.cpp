@@ -29,6 +29,7 @@
 using std::string;
 using std::find_first_of;
 using std::malloc;
+using std::free;
 
 PakFile::~PakFile() {
 	delete _alternative;
@@ -38,7 +39,10 @@ char * PakFile::readAlloc() const {
 	
 	char * buffer = (char*)malloc(size());
 	
-	read(buffer);
+	if(!read(buffer)) {
+		free(buffer);
+		return NULL;
+	}
 	
 	return buffer;
 }
@@ -51,9 +51,17 @@ public:
 	inline size_t size() const { return _size; }
 	inline PakFile * alternative() const { return _alternative; }
 	
-	virtual void read(void * buf) const = 0;
+	/*!
+	 * Read the whole file.
+	 * @param buf Buffer of at least size() bytes.
+	 * @return false if the stored data is truncated or corrupt.
+	 */
+	virtual bool read(void * buf) const = 0;
 	char * readAlloc() const;
 	
+	//! @return the size of the file data in the archive, which is smaller than size() if compressed.
+	virtual size_t compressedSize() const { return _size; }
+	
 	virtual PakFileHandle * open() const = 0;
 	
 };
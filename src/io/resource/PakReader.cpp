@@ -32,11 +32,18 @@
 #include "io/fs/FilePath.h"
 #include "io/fs/Filesystem.h"
 #include "io/fs/FileStream.h"
+#include "platform/Lock.h"
 
 namespace {
 
 const size_t PAK_READ_BUF_SIZE = 1024;
 
+/*!
+ * Serializes access to the archive streams, which are shared by all files
+ * in an archive, so that resources can be read from more than one thread.
+ */
+Lock archiveMutex;
+
 static PakReader::ReleaseType guessReleaseType(u32 first_bytes) {
 	switch(first_bytes) {
 		case 0x46515641:
@@ -80,7 +87,7 @@ public:
 	explicit UncompressedFile(std::istream * _archive, size_t _offset, size_t size)
 		: PakFile(size), archive(*_archive), offset(_offset) { }
 	
-	void read(void * buf) const;
+	bool read(void * buf) const;
 	
 	PakFileHandle * open() const;
 	
@@ -108,16 +115,19 @@ public:
 	
 };
 
-void UncompressedFile::read(void * buf) const {
+bool UncompressedFile::read(void * buf) const {
+	
+	Autolock lock(archiveMutex);
 	
 	archive.seekg(offset);
 	
 	fs::read(archive, buf, size());
 	
-	arx_assert(!archive.fail());
-	arx_assert(size_t(archive.gcount()) == size());
+	bool ok = !archive.fail() && size_t(archive.gcount()) == size();
 	
 	archive.clear();
+	
+	return ok;
 }
 
 PakFileHandle * UncompressedFile::open() const {
@@ -130,6 +140,8 @@ size_t UncompressedFileHandle::read(void * buf, size_t size) {
 		return 0;
 	}
 	
+	Autolock lock(archiveMutex);
+	
 	file.archive.seekg(file.offset + offset);
 	
 	if(file.size() < offset + size) {
@@ -182,7 +194,9 @@ public:
 	                        size_t _storedSize)
 		: PakFile(size), archive(*_archive), offset(_offset), storedSize(_storedSize) { }
 	
-	void read(void * buf) const;
+	bool read(void * buf) const;
+	
+	size_t compressedSize() const { return storedSize; }
 	
 	PakFileHandle * open() const;
 	
@@ -234,23 +248,31 @@ size_t blastInFile(void * Param, const unsigned char ** buf) {
 	return fs::read(p->file, p->readbuf, count).gcount();
 }
 
-void CompressedFile::read(void * buf) const {
+bool CompressedFile::read(void * buf) const {
 	
-	archive.seekg(offset);
+	// Read all compressed data at once so that the faster in-memory decoder can be used
+	char * compressed = (char *)malloc(storedSize);
+	if(!compressed) {
+		LogError << "could not allocate " << storedSize << " bytes";
+		return false;
+	}
 	
-	BlastFileInBuffer in(&archive, storedSize);
-	BlastMemOutBuffer out(reinterpret_cast<char *>(buf), size());
+	bool ok;
+	{
+		Autolock lock(archiveMutex);
+		archive.seekg(offset);
+		ok = !fs::read(archive, compressed, storedSize).fail();
+		archive.clear();
+	}
 	
-	int r = blast(blastInFile, &in, blastOutMem, &out);
-	if(r) {
-		LogError << "blast error " << r << " outSize=" << size();
+	size_t outSize = 0;
+	if(ok) {
+		outSize = blastMem(compressed, storedSize, reinterpret_cast<char *>(buf), size());
 	}
 	
-	arx_assert(!archive.fail());
-	arx_assert(in.remaining == 0);
-	arx_assert(out.size == 0);
+	free(compressed);
 	
-	archive.clear();
+	return (outSize == size());
 }
 
 PakFileHandle * CompressedFile::open() const {
@@ -309,6 +331,8 @@ size_t CompressedFileHandle::read(void * buf, size_t size) {
 		           << " offset=" << offset << " total=" << file.size();
 	}
 	
+	Autolock lock(archiveMutex);
+	
 	file.archive.seekg(file.offset);
 	
 	BlastFileInBuffer in(&file.archive, file.storedSize);
@@ -371,7 +395,7 @@ public:
 	
 	PlainFile(const fs::path & _path, size_t size) : PakFile(size), path(_path) { }
 	
-	void read(void * buf) const;
+	bool read(void * buf) const;
 	
 	PakFileHandle * open() const;
 	
@@ -398,15 +422,16 @@ public:
 	
 };
 
-void PlainFile::read(void * buf) const {
+bool PlainFile::read(void * buf) const {
 	
 	fs::ifstream ifs(path, fs::fstream::in | fs::fstream::binary);
-	arx_assert(ifs.is_open());
+	if(!ifs.is_open()) {
+		return false;
+	}
 	
 	fs::read(ifs, buf, size());
 	
-	arx_assert(!ifs.fail());
-	arx_assert(size_t(ifs.gcount()) == size());
+	return !ifs.fail() && size_t(ifs.gcount()) == size();
 }
 
 PakFileHandle * PlainFile::open() const {
@@ -572,9 +597,7 @@ bool PakReader::read(const res::path & name, void * buf) {
 		return false;
 	}
 	
-	f->read(buf);
-	
-	return true;
+	return f->read(buf);
 }
 
 char * PakReader::readAlloc(const res::path & name, size_t & sizeRead) {
@@ -0,0 +1,260 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "physics/AnchorTree.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "graphics/BaseGraphicsTypes.h"
+#include "physics/Anchors.h"
+
+namespace {
+
+struct AnchorAxisCompare {
+	
+	const ANCHOR_DATA * anchors;
+	int axis;
+	
+	AnchorAxisCompare(const ANCHOR_DATA * _anchors, int _axis)
+		: anchors(_anchors), axis(_axis) { }
+	
+	bool operator()(long a, long b) const {
+		return anchors[a].pos(axis) < anchors[b].pos(axis);
+	}
+	
+};
+
+} // anonymous namespace
+
+struct AnchorTree::Query {
+	
+	Vec3f pos;
+	float radius;
+	float height;
+	bool unblocked;
+	long except;
+	
+	long best;
+	float bestDist;
+	
+};
+
+AnchorTree::AnchorTree(ANCHOR_DATA * _anchors, size_t count) : anchors(_anchors) {
+	
+	for(size_t i = 0; i < count; i++) {
+		if(anchors[i].nblinked) {
+			order.push_back(long(i));
+		}
+	}
+	
+	nodes.resize(order.size());
+	build(0, order.size());
+	
+	positions.assign(count, -1);
+	for(size_t i = 0; i < order.size(); i++) {
+		positions[order[i]] = long(i);
+	}
+}
+
+void AnchorTree::build(size_t begin, size_t end) {
+	
+	if(begin >= end) {
+		return;
+	}
+	
+	// Split along the axis where the anchors are spread the most
+	Vec3f min = anchors[order[begin]].pos, max = min;
+	for(size_t i = begin + 1; i < end; i++) {
+		min = componentwise_min(min, anchors[order[i]].pos);
+		max = componentwise_max(max, anchors[order[i]].pos);
+	}
+	Vec3f extent = max - min;
+	int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z ? 1 : 2);
+	
+	size_t mid = begin + (end - begin) / 2;
+	std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+	                 AnchorAxisCompare(anchors, axis));
+	
+	build(begin, mid);
+	build(mid + 1, end);
+	
+	const ANCHOR_DATA & anchor = anchors[order[mid]];
+	
+	Node & node = nodes[mid];
+	node.min = min;
+	node.max = max;
+	node.maxRadius = anchor.radius;
+	node.minHeight = anchor.height;
+	node.available = (anchor.flags & ANCHOR_FLAG_BLOCKED) ? 0 : 1;
+	node.axis = axis;
+	
+	if(begin < mid) {
+		const Node & left = nodes[begin + (mid - begin) / 2];
+		node.maxRadius = std::max(node.maxRadius, left.maxRadius);
+		node.minHeight = std::min(node.minHeight, left.minHeight);
+		node.available += left.available;
+	}
+	
+	if(mid + 1 < end) {
+		const Node & right = nodes[mid + 1 + (end - mid - 1) / 2];
+		node.maxRadius = std::max(node.maxRadius, right.maxRadius);
+		node.minHeight = std::min(node.minHeight, right.minHeight);
+		node.available += right.available;
+	}
+}
+
+void AnchorTree::search(Query & query, size_t begin, size_t end) const {
+	
+	if(begin >= end) {
+		return;
+	}
+	
+	size_t mid = begin + (end - begin) / 2;
+	const Node & node = nodes[mid];
+	
+	if((query.unblocked && !node.available) || node.maxRadius < query.radius
+	   || node.minHeight > query.height) {
+		return;
+	}
+	
+	if(query.best != -1) {
+		float boxDist = 0.f;
+		for(int i = 0; i < 3; i++) {
+			float d = std::max(std::max(node.min(i) - query.pos(i), query.pos(i) - node.max(i)), 0.f);
+			boxDist += d * d;
+		}
+		if(boxDist > query.bestDist) {
+			return;
+		}
+	}
+	
+	long index = order[mid];
+	const ANCHOR_DATA & anchor = anchors[index];
+	
+	if(index != query.except && anchor.radius >= query.radius && anchor.height <= query.height
+	   && !(query.unblocked && (anchor.flags & ANCHOR_FLAG_BLOCKED))) {
+		float d = distSqr(anchor.pos, query.pos);
+		if(query.best == -1 || d < query.bestDist || (d == query.bestDist && index < query.best)) {
+			query.best = index;
+			query.bestDist = d;
+		}
+	}
+	
+	// Visit the half containing the query position first
+	if(query.pos(node.axis) < anchor.pos(node.axis)) {
+		search(query, begin, mid);
+		search(query, mid + 1, end);
+	} else {
+		search(query, mid + 1, end);
+		search(query, begin, mid);
+	}
+}
+
+long AnchorTree::getNearest(const Vec3f & pos, const EERIE_CYLINDER & cyl, long except) const {
+	
+	Query query;
+	query.pos = pos;
+	query.radius = cyl.radius;
+	query.height = cyl.height;
+	query.unblocked = true;
+	query.except = except;
+	query.best = -1;
+	query.bestDist = 0.f;
+	
+	search(query, 0, order.size());
+	
+	return query.best;
+}
+
+long AnchorTree::getNearest(const Vec3f & pos) const {
+	
+	Query query;
+	query.pos = pos;
+	query.radius = -std::numeric_limits<float>::infinity();
+	query.height = std::numeric_limits<float>::infinity();
+	query.unblocked = false;
+	query.except = -1;
+	query.best = -1;
+	query.bestDist = 0.f;
+	
+	search(query, 0, order.size());
+	
+	return query.best;
+}
+
+void AnchorTree::setBlocked(long anchor, bool blocked) {
+	
+	ANCHOR_DATA & ad = anchors[anchor];
+	if(bool(ad.flags & ANCHOR_FLAG_BLOCKED) == blocked) {
+		return;
+	}
+	
+	if(blocked) {
+		ad.flags |= ANCHOR_FLAG_BLOCKED;
+	} else {
+		ad.flags &= ~ANCHOR_FLAG_BLOCKED;
+	}
+	
+	long position = positions[anchor];
+	if(position < 0) {
+		return;
+	}
+	
+	// Update the counts of all subtrees containing the anchor
+	size_t begin = 0, end = order.size();
+	while(begin < end) {
+		size_t mid = begin + (end - begin) / 2;
+		if(blocked) {
+			nodes[mid].available--;
+		} else {
+			nodes[mid].available++;
+		}
+		if(size_t(position) == mid) {
+			break;
+		} else if(size_t(position) < mid) {
+			end = mid;
+		} else {
+			begin = mid + 1;
+		}
+	}
+}
+
+void AnchorTree::clearBlocked() {
+	
+	for(size_t i = 0; i < positions.size(); i++) {
+		anchors[i].flags &= ~ANCHOR_FLAG_BLOCKED;
+	}
+	
+	// Every subtree is now fully available
+	std::vector<std::pair<size_t, size_t> > stack(1, std::make_pair(size_t(0), order.size()));
+	while(!stack.empty()) {
+		size_t begin = stack.back().first, end = stack.back().second;
+		stack.pop_back();
+		if(begin >= end) {
+			continue;
+		}
+		size_t mid = begin + (end - begin) / 2;
+		nodes[mid].available = end - begin;
+		stack.push_back(std::make_pair(begin, mid));
+		stack.push_back(std::make_pair(mid + 1, end));
+	}
+}
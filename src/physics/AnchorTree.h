@@ -0,0 +1,105 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ARX_PHYSICS_ANCHORTREE_H
+#define ARX_PHYSICS_ANCHORTREE_H
+
+#include <stddef.h>
+#include <vector>
+
+#include "math/Vector3.h"
+
+struct ANCHOR_DATA;
+struct EERIE_CYLINDER;
+
+/*!
+ * Static k-d tree over the linked anchors of a background.
+ *
+ * Each subtree stores the bounding box of its anchors, the largest anchor radius,
+ * the smallest anchor height and the number of anchors that are not blocked.
+ * Nearest neighbor queries descend into the closer half first and skip subtrees
+ * that are farther away than the best match found so far or that cannot contain
+ * a matching anchor at all.
+ *
+ * Anchors without links are never returned and are not stored in the tree.
+ * The tree does not copy the anchor data: it must be rebuilt if anchors
+ * are added, removed, moved or linked.
+ */
+class AnchorTree {
+	
+public:
+	
+	AnchorTree(ANCHOR_DATA * anchors, size_t count);
+	
+	/*!
+	 * Find the nearest anchor that is large enough for a cylinder and not blocked.
+	 * Anchors at the same distance are resolved in favor of the lower index.
+	 *
+	 * @param except an anchor index to ignore, or -1
+	 * @return the index of the anchor or -1 if there is no matching anchor
+	 */
+	long getNearest(const Vec3f & pos, const EERIE_CYLINDER & cyl, long except = -1) const;
+	
+	/*!
+	 * Find the nearest anchor, ignoring size and blocked flags.
+	 * @return the index of the anchor or -1 if there are no linked anchors
+	 */
+	long getNearest(const Vec3f & pos) const;
+	
+	//! Set or clear the ANCHOR_FLAG_BLOCKED flag of one anchor.
+	void setBlocked(long anchor, bool blocked);
+	
+	//! Clear the ANCHOR_FLAG_BLOCKED flag of all anchors.
+	void clearBlocked();
+	
+private:
+	
+	struct Node {
+		Vec3f min;
+		Vec3f max;
+		float maxRadius;
+		float minHeight;
+		size_t available; //!< Number of unblocked anchors in this subtree
+		size_t axis;
+	};
+	
+	struct Query;
+	
+	void build(size_t begin, size_t end);
+	void search(Query & query, size_t begin, size_t end) const;
+	
+	ANCHOR_DATA * anchors;
+	
+	/*!
+	 * Anchor indices in tree order: the subtree for the range [begin, end) has
+	 * the anchor at the middle position as its root and the ranges before and
+	 * after the middle as its children.
+	 */
+	std::vector<long> order;
+	
+	//! Node data for each position in order
+	std::vector<Node> nodes;
+	
+	//! Position of each anchor in order, or -1 for anchors not in the tree
+	std::vector<long> positions;
+	
+};
+
+#endif // ARX_PHYSICS_ANCHORTREE_H
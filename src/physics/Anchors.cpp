@@ -53,6 +53,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #include "game/Player.h"
 #include "graphics/Math.h"
 #include "io/log/Logger.h"
+#include "physics/AnchorTree.h"
 #include "physics/Collisions.h"
 
 using std::min;
@@ -89,7 +90,7 @@ static EERIEPOLY * ANCHOR_CheckInPolyPrecis(float x, float y, float z) {
 		return NULL;
 	}
 
-	EERIEPOLY * ep;
+	const EERIE_COLLISION_POLY * ep;
 	FAST_BKG_DATA * feg;
 	EERIEPOLY * found = NULL;
 	float foundY = 9999999.f;
@@ -101,7 +102,7 @@ static EERIEPOLY * ANCHOR_CheckInPolyPrecis(float x, float y, float z) {
 
 			for (long k = 0; k < feg->nbpolyin; k++)
 			{
-				ep = feg->polyin[k];
+				ep = feg->collin[k];
 
 				if (!(ep->type & (POLY_WATER | POLY_TRANS | POLY_NOCOL))
 				        &&	(PointIn2DPolyXZ(ep, x, z))
@@ -118,7 +119,7 @@ static EERIEPOLY * ANCHOR_CheckInPolyPrecis(float x, float y, float z) {
 					        &&	((found == NULL) || ((found != NULL) && (yy <= foundY)))
 					   )
 					{
-						found = ep;
+						found = ep->poly;
 						foundY = yy;
 					}
 				}
@@ -155,20 +156,20 @@ static EERIEPOLY * ANCHOR_CheckInPoly(float x, float y, float z) {
 		return NULL;
 	}
 
-	EERIEPOLY * ep;
+	const EERIE_COLLISION_POLY * ep;
 	FAST_BKG_DATA * feg;
-	EERIEPOLY * found = NULL;
+	const EERIE_COLLISION_POLY * found = NULL;
 
 	feg = &ACTIVEBKG->fastdata[px][pz];
 
 	for (long k = 0; k < feg->nbpolyin; k++)
 	{
-		ep = feg->polyin[k];
+		ep = feg->collin[k];
 
 		if (!(ep->type & (POLY_WATER | POLY_TRANS | POLY_NOCOL))
 		        &&	(ep->max.y >= y)
 		        &&	(ep != found)
-		        &&	((ep->norm.y < 0.f) || ((ep->type & POLY_QUAD) && (ep->norm2.y < 0.f)))
+		        &&	((ep->normy < 0.f) || ((ep->type & POLY_QUAD) && (ep->norm2y < 0.f)))
 		        &&	(PointIn2DPolyXZ(ep, x, z)))
 		{
 			if ((found == NULL) || ((found != NULL) && (ep->min.y < found->min.y)))
@@ -178,13 +179,13 @@ static EERIEPOLY * ANCHOR_CheckInPoly(float x, float y, float z) {
 
 	if (!found) return CheckInPolyPrecis(x, y, z);
 
-	return found;
+	return found->poly;
 }
 
 extern Vec3f vector2D;
 
-float ANCHOR_IsPolyInCylinder(EERIEPOLY * ep, EERIE_CYLINDER * cyl,
-                              CollisionFlags flags) {
+static float ANCHOR_IsPolyInCylinder(const EERIE_COLLISION_POLY * ep, EERIE_CYLINDER * cyl,
+                                     CollisionFlags flags) {
 	
 	if (!(flags & CFLAG_EXTRA_PRECISION))
 	{
@@ -193,7 +194,7 @@ float ANCHOR_IsPolyInCylinder(EERIEPOLY * ep, EERIE_CYLINDER * cyl,
 
 	if (PointInCylinder(cyl, &ep->center)) 
 	{
-		if (ep->norm.y < 0.5f)
+		if (ep->normy < 0.5f)
 			return ep->min.y;
 
 		return ep->center.y;
@@ -223,7 +224,7 @@ float ANCHOR_IsPolyInCylinder(EERIEPOLY * ep, EERIE_CYLINDER * cyl,
 			for (long o = 0; o < 5; o++)
 			{
 				float p = (float)o * ( 1.0f / 5 );
-				center = ep->v[n].p * p + ep->center * (1.f - p);
+				center = ep->v[n] * p + ep->center * (1.f - p);
 				if(PointInCylinder(cyl, &center)) {
 					anything = std::min(anything, center.y);
 					return anything;
@@ -236,7 +237,7 @@ float ANCHOR_IsPolyInCylinder(EERIEPOLY * ep, EERIE_CYLINDER * cyl,
 		        || (flags & CFLAG_EXTRA_PRECISION)
 		   )
 		{
-			center = (ep->v[n].p + ep->v[r].p) * 0.5f;
+			center = (ep->v[n] + ep->v[r]) * 0.5f;
 			if(PointInCylinder(cyl, &center)) {
 				anything = std::min(anything, center.y);
 				return anything;
@@ -244,7 +245,7 @@ float ANCHOR_IsPolyInCylinder(EERIEPOLY * ep, EERIE_CYLINDER * cyl,
 
 			if ((ep->area > 4000.f) || (flags & CFLAG_EXTRA_PRECISION))
 			{
-				center = (ep->v[n].p + ep->center) * 0.5f;
+				center = (ep->v[n] + ep->center) * 0.5f;
 				if(PointInCylinder(cyl, &center)) {
 					anything = std::min(anything, center.y);
 					return anything;
@@ -253,7 +254,7 @@ float ANCHOR_IsPolyInCylinder(EERIEPOLY * ep, EERIE_CYLINDER * cyl,
 
 			if ((ep->area > 6000.f) || (flags & CFLAG_EXTRA_PRECISION))
 			{
-				center = (center + ep->v[n].p) * 0.5f;
+				center = (center + ep->v[n]) * 0.5f;
 				if(PointInCylinder(cyl, &center)) {
 					anything = std::min(anything, center.y);
 					return anything;
@@ -261,8 +262,8 @@ float ANCHOR_IsPolyInCylinder(EERIEPOLY * ep, EERIE_CYLINDER * cyl,
 			}
 		}
 
-		if(PointInCylinder(cyl, &ep->v[n].p)) {
-			anything = std::min(anything, ep->v[n].p.y);
+		if(PointInCylinder(cyl, &ep->v[n])) {
+			anything = std::min(anything, ep->v[n].y);
 			return anything;
 		}
 
@@ -272,7 +273,7 @@ float ANCHOR_IsPolyInCylinder(EERIEPOLY * ep, EERIE_CYLINDER * cyl,
 
 	}
 
-	if ((anything != 999999.f) && (ep->norm.y < 0.1f) && (ep->norm.y > -0.1f))
+	if ((anything != 999999.f) && (ep->normy < 0.1f) && (ep->normy > -0.1f))
 		anything = std::min(anything, ep->min.y);
 
 	return anything;
@@ -306,7 +307,6 @@ static float ANCHOR_CheckAnythingInCylinder(EERIE_CYLINDER * cyl,
 
 	float anything = 999999.f; 
 
-	EERIEPOLY * ep;
 	FAST_BKG_DATA * feg;
 
 	/* TO KEEP...
@@ -327,7 +327,7 @@ static float ANCHOR_CheckAnythingInCylinder(EERIE_CYLINDER * cyl,
 
 			for (long k = 0; k < feg->nbpoly; k++)
 			{
-				ep = &feg->polydata[k];
+				const EERIE_COLLISION_POLY * ep = &feg->colldata[k];
 
 				if (ep->type & (POLY_WATER | POLY_TRANS | POLY_NOCOL)) continue;
 
@@ -343,7 +343,7 @@ static float ANCHOR_CheckAnythingInCylinder(EERIE_CYLINDER * cyl,
 			}
 		}
 
-	ep = ANCHOR_CheckInPolyPrecis(cyl->origin.x, cyl->origin.y + cyl->height, cyl->origin.z);
+	EERIEPOLY * ep = ANCHOR_CheckInPolyPrecis(cyl->origin.x, cyl->origin.y + cyl->height, cyl->origin.z);
 
 	if (ep) anything = std::min(anything, ep->min.y);
 
@@ -657,6 +657,49 @@ void AnchorData_ClearAll(EERIE_BACKGROUND * eb) {
 
 	eb->anchors = NULL;
 	eb->nbanchors = 0;
+	
+	delete eb->anchorTree, eb->anchorTree = NULL;
+}
+
+void AnchorData_CreateTree(EERIE_BACKGROUND * eb) {
+	
+	delete eb->anchorTree, eb->anchorTree = NULL;
+	
+	if(eb->anchors && eb->nbanchors > 0) {
+		eb->anchorTree = new AnchorTree(eb->anchors, eb->nbanchors);
+	}
+}
+
+long AnchorData_GetNearest(const EERIE_BACKGROUND * eb, const Vec3f & pos,
+                           const EERIE_CYLINDER & cyl, long except) {
+	
+	if(!eb->anchorTree) {
+		return -1;
+	}
+	
+	return eb->anchorTree->getNearest(pos, cyl, except);
+}
+
+void AnchorData_SetBlocked(EERIE_BACKGROUND * eb, long anchor, bool blocked) {
+	
+	if(eb->anchorTree) {
+		eb->anchorTree->setBlocked(anchor, blocked);
+	} else if(blocked) {
+		eb->anchors[anchor].flags |= ANCHOR_FLAG_BLOCKED;
+	} else {
+		eb->anchors[anchor].flags &= ~ANCHOR_FLAG_BLOCKED;
+	}
+}
+
+void AnchorData_ClearBlocked(EERIE_BACKGROUND * eb) {
+	
+	if(eb->anchorTree) {
+		eb->anchorTree->clearBlocked();
+	} else {
+		for(long i = 0; i < eb->nbanchors; i++) {
+			eb->anchors[i].flags &= ~ANCHOR_FLAG_BLOCKED;
+		}
+	}
 }
 #define INC_HEIGHT 20
 #define INC_RADIUS 10
@@ -1333,4 +1376,5 @@ void AnchorData_Create(EERIE_BACKGROUND * eb) {
 
 	AnchorData_Create_Phase_II_Original_Method(eb);
 	AnchorData_Create_Links_Original_Method(eb);
+	AnchorData_CreateTree(eb);
 }
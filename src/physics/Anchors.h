@@ -76,5 +76,25 @@ void AnchorData_ClearAll(EERIE_BACKGROUND * eb);
 bool CylinderAboveInvalidZone(EERIE_CYLINDER * cyl);
 
 void AnchorData_Create(EERIE_BACKGROUND * eb);
+
+/*!
+ * (Re)build the spatial index used for nearest anchor queries.
+ * Must be called whenever the anchors of a background have been created or loaded.
+ */
+void AnchorData_CreateTree(EERIE_BACKGROUND * eb);
+
+/*!
+ * Find the nearest linked anchor that is not blocked and is large enough for a cylinder.
+ * @param except an anchor index to ignore, or -1
+ * @return the anchor index or -1 if there is no such anchor
+ */
+long AnchorData_GetNearest(const EERIE_BACKGROUND * eb, const Vec3f & pos,
+                           const EERIE_CYLINDER & cyl, long except = -1);
+
+//! Set or clear the ANCHOR_FLAG_BLOCKED flag of an anchor, keeping the index up to date
+void AnchorData_SetBlocked(EERIE_BACKGROUND * eb, long anchor, bool blocked);
+
+//! Clear the ANCHOR_FLAG_BLOCKED flag of all anchors
+void AnchorData_ClearBlocked(EERIE_BACKGROUND * eb);
  
 #endif // ARX_PHYSICS_ANCHORS_H
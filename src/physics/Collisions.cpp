@@ -78,7 +78,7 @@ bool DIRECT_PATH=true;
 
 //-----------------------------------------------------------------------------
 // Added immediate return (return anything;)
-inline float IsPolyInCylinder(EERIEPOLY *ep, EERIE_CYLINDER * cyl,long flag)
+inline float IsPolyInCylinder(const EERIE_COLLISION_POLY * ep, EERIE_CYLINDER * cyl,long flag)
 {
 	long flags=flag;
 	POLYIN=0;
@@ -98,7 +98,7 @@ inline float IsPolyInCylinder(EERIEPOLY *ep, EERIE_CYLINDER * cyl,long flag)
 
 	for (long num=0;num<to;num++)
 	{
-		float dd = fdist(Vec2f(ep->v[num].p.x, ep->v[num].p.z), Vec2f(cyl->origin.x, cyl->origin.z));
+		float dd = fdist(Vec2f(ep->v[num].x, ep->v[num].z), Vec2f(cyl->origin.x, cyl->origin.z));
 
 		if (dd<nearest)
 		{
@@ -124,7 +124,7 @@ inline float IsPolyInCylinder(EERIEPOLY *ep, EERIE_CYLINDER * cyl,long flag)
 	{	
 		POLYIN = 1;
 		
-		if (ep->norm.y<0.5f)
+		if (ep->normy<0.5f)
 			anything=min(anything,ep->min.y);
 		else
 			anything=min(anything,ep->center.y);
@@ -145,7 +145,7 @@ inline float IsPolyInCylinder(EERIEPOLY *ep, EERIE_CYLINDER * cyl,long flag)
 			for (long o=0;o<5;o++)
 			{
 				float p=(float)o*( 1.0f / 5 );
-				center = ep->v[n].p * p + ep->center * (1.f-p);
+				center = ep->v[n] * p + ep->center * (1.f-p);
 				if(PointInCylinder(cyl, &center)) {
 					anything=min(anything,center.y);
 					POLYIN=1;
@@ -157,7 +157,7 @@ inline float IsPolyInCylinder(EERIEPOLY *ep, EERIE_CYLINDER * cyl,long flag)
 		if ((ep->area>2000.f) 
 		        || (flags & CFLAG_EXTRA_PRECISION)  )
 		{
-			center = (ep->v[n].p + ep->v[r].p) * 0.5f;
+			center = (ep->v[n] + ep->v[r]) * 0.5f;
 			if(PointInCylinder(cyl, &center)) {
 				anything=min(anything,center.y);
 				POLYIN=1;
@@ -165,7 +165,7 @@ inline float IsPolyInCylinder(EERIEPOLY *ep, EERIE_CYLINDER * cyl,long flag)
 			}
 
 			if ((ep->area>4000.f) || (flags & CFLAG_EXTRA_PRECISION)) {
-				center = (ep->v[n].p + ep->center) * 0.5f;
+				center = (ep->v[n] + ep->center) * 0.5f;
 				if (PointInCylinder(cyl, &center)) 
 				{	
 					anything=min(anything,center.y);
@@ -176,7 +176,7 @@ inline float IsPolyInCylinder(EERIEPOLY *ep, EERIE_CYLINDER * cyl,long flag)
 			}
 
 			if ((ep->area>6000.f) || (flags & CFLAG_EXTRA_PRECISION)) {
-				center = (center + ep->v[n].p) * 0.5f;
+				center = (center + ep->v[n]) * 0.5f;
 				if(PointInCylinder(cyl, &center))
 				{
 					anything=min(anything,center.y);
@@ -187,9 +187,9 @@ inline float IsPolyInCylinder(EERIEPOLY *ep, EERIE_CYLINDER * cyl,long flag)
 			}
 		}
 
-		if(PointInCylinder(cyl, &ep->v[n].p)) {
+		if(PointInCylinder(cyl, &ep->v[n])) {
 			
-			anything=min(anything,ep->v[n].p.y);
+			anything=min(anything,ep->v[n].y);
 			POLYIN = 1;
 
 			if (!(flags & CFLAG_EXTRA_PRECISION)) return anything;
@@ -227,14 +227,14 @@ inline float IsPolyInCylinder(EERIEPOLY *ep, EERIE_CYLINDER * cyl,long flag)
 		}
 	} 
 //}*/
-	if ((anything!=999999.f) && (ep->norm.y<0.1f) && (ep->norm.y>-0.1f))
+	if ((anything!=999999.f) && (ep->normy<0.1f) && (ep->normy>-0.1f))
 		anything=min(anything,ep->min.y);
 
 	return anything;
 }
 
 //-----------------------------------------------------------------------------
-inline bool IsPolyInSphere(EERIEPOLY *ep, EERIE_SPHERE * sph)
+inline bool IsPolyInSphere(const EERIE_COLLISION_POLY * ep, EERIE_SPHERE * sph)
 {
 	if ((!ep) || (!sph)) return false;
 
@@ -252,27 +252,25 @@ inline bool IsPolyInSphere(EERIEPOLY *ep, EERIE_SPHERE * sph)
 	{
 		
 		if(ep->area > 2000.f) {
-			center = (ep->v[n].p + ep->v[r].p) * 0.5f;
+			center = (ep->v[n] + ep->v[r]) * 0.5f;
 			if(sph->contains(center)) {	
 				return true;
 			}
 			if(ep->area > 4000.f) {
-				center = (ep->v[n].p + ep->center) * 0.5f;
+				center = (ep->v[n] + ep->center) * 0.5f;
 				if(sph->contains(center)) {
 					return true;
 				}
 			}
 			if(ep->area > 6000.f) {
-				center = (center + ep->v[n].p) * 0.5f;
+				center = (center + ep->v[n]) * 0.5f;
 				if(sph->contains(center)) {
 					return true;
 				}
 			}
 		}
 		
-		Vec3f v(ep->v[n].p.x, ep->v[n].p.y, ep->v[n].p.z);
-
-		if(sph->contains(v)) {
+		if(sph->contains(ep->v[n])) {
 			return true;
 		}
 
@@ -530,7 +528,7 @@ float CheckAnythingInCylinder(EERIE_CYLINDER * cyl,Entity * ioo,long flags) {
 
 	float anything = 999999.f; 
 	
-	EERIEPOLY * ep;
+	const EERIE_COLLISION_POLY * ep;
 	FAST_BKG_DATA * feg;
 	
 	for (long j=pz-rad;j<=pz+rad;j++)
@@ -565,7 +563,7 @@ float CheckAnythingInCylinder(EERIE_CYLINDER * cyl,Entity * ioo,long flags) {
 		feg=&ACTIVEBKG->fastdata[i][j];
 		for (long k=0;k<feg->nbpoly;k++)
 		{
-			ep=&feg->polydata[k];	
+			ep=&feg->colldata[k];	
 
 			if (ep->type & (POLY_WATER | POLY_TRANS | POLY_NOCOL) ) continue;
 
@@ -585,9 +583,7 @@ float CheckAnythingInCylinder(EERIE_CYLINDER * cyl,Entity * ioo,long flags) {
 
 	float tempo;
 	
-	ep=CheckInPolyPrecis(cyl->origin.x,cyl->origin.y+cyl->height,cyl->origin.z,&tempo);
-	
-	if (ep) 
+	if(CheckInPolyPrecis(cyl->origin.x,cyl->origin.y+cyl->height,cyl->origin.z,&tempo)) 
 		{
 			anything=min(anything,tempo);
 	}
@@ -1060,7 +1056,7 @@ EERIEPOLY * CheckBackgroundInSphere(EERIE_SPHERE * sphere) //except source...
 	px = sphere->origin.x * ACTIVEBKG->Xmul;
 	pz = sphere->origin.z * ACTIVEBKG->Zmul;
 
-	EERIEPOLY * ep;
+	const EERIE_COLLISION_POLY * ep;
 	FAST_BKG_DATA * feg;
 	long spx=max(px-rad,0L);
 	long epx=min(px+rad,ACTIVEBKG->Xsize-1L);
@@ -1074,13 +1070,13 @@ EERIEPOLY * CheckBackgroundInSphere(EERIE_SPHERE * sphere) //except source...
 
 		for (long k=0;k<feg->nbpoly;k++)
 		{
-			ep=&feg->polydata[k];	
+			ep=&feg->colldata[k];	
 
 			if (ep->type & (POLY_WATER | POLY_TRANS | POLY_NOCOL)) continue;
 
 			if (IsPolyInSphere(ep,sphere)) 
 			{
-				return ep;					
+				return ep->poly;					
 			}			
 		}
 	}	
@@ -1100,7 +1096,7 @@ bool CheckAnythingInSphere(EERIE_SPHERE * sphere,long source,CASFlags flags,long
 	px = sphere->origin.x*ACTIVEBKG->Xmul;
 	pz = sphere->origin.z*ACTIVEBKG->Zmul;
 
-	EERIEPOLY * ep;
+	const EERIE_COLLISION_POLY * ep;
 	FAST_BKG_DATA * feg;
 
 	if (!(flags & CAS_NO_BACKGROUND_COL))
@@ -1117,7 +1113,7 @@ bool CheckAnythingInSphere(EERIE_SPHERE * sphere,long source,CASFlags flags,long
 
 			for (long k=0;k<feg->nbpoly;k++)
 			{
-				ep=&feg->polydata[k];	
+				ep=&feg->colldata[k];	
 
 				if (ep->type & (POLY_WATER | POLY_TRANS | POLY_NOCOL)) continue;
 
@@ -1862,11 +1858,7 @@ void ANCHOR_BLOCK_Clear()
 
 	if (eb)
 	{
-		for (long k=0;k<eb->nbanchors;k++)
-		{
-			ANCHOR_DATA * ad=&eb->anchors[k];	
-			ad->flags&=~ANCHOR_FLAG_BLOCKED;
-		}
+		AnchorData_ClearBlocked(eb);
 	}
 }
 
@@ -1908,10 +1900,7 @@ void ANCHOR_BLOCK_By_IO(Entity * io,long status)
 
 				if (PointIn2DPolyXZ(&ep, ad->pos.x, ad->pos.z)) 
 				{
-					if (status)
-						ad->flags|=ANCHOR_FLAG_BLOCKED;
-					else
-						ad->flags&=~ANCHOR_FLAG_BLOCKED;
+					AnchorData_SetBlocked(eb, k, status != 0);
 				}
 			}
 		}
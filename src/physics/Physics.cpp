@@ -67,15 +67,15 @@ EERIEPOLY * BCCheckInPoly(float x, float y, float z)
 	        ||	(pz < 0))
 		return NULL;
 
-	EERIEPOLY * ep;
+	const EERIE_COLLISION_POLY * ep;
 	EERIE_BKG_INFO * eg;
-	EERIEPOLY * found = NULL;
+	const EERIE_COLLISION_POLY * found = NULL;
 
 	eg = (EERIE_BKG_INFO *)&ACTIVEBKG->Backg[px+pz*ACTIVEBKG->Xsize];
 
 	for (long k = 0; k < eg->nbpolyin; k++)
 	{
-		ep = eg->polyin[k];
+		ep = eg->collin[k];
 
 		if (!(ep->type & POLY_WATER) &&  !(ep->type & POLY_TRANS))
 		{
@@ -101,7 +101,7 @@ EERIEPOLY * BCCheckInPoly(float x, float y, float z)
 
 		for (long k = 0; k < eg->nbpolyin; k++)
 		{
-			ep = eg->polyin[k];
+			ep = eg->collin[k];
 
 			if (!(ep->type & POLY_WATER) &&  !(ep->type & POLY_TRANS))
 			{
@@ -118,5 +118,5 @@ EERIEPOLY * BCCheckInPoly(float x, float y, float z)
 		}
 	}
 
-	return found;
+	return found ? found->poly : NULL;
 }
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "platform/JobSystem.h"
+
+#include "platform/Thread.h"
+
+bool JobGroup::isDone() {
+	Autolock lock(mutex);
+	return pending == 0;
+}
+
+class JobSystem::Worker : public Thread {
+	
+	JobSystem & system;
+	size_t queue;
+	
+public:
+	
+	Event wakeup;
+	
+	Worker(JobSystem & _system, size_t _queue) : system(_system), queue(_queue) {
+		setThreadName("Worker");
+	}
+	
+	void run() {
+		while(!system.isStopping()) {
+			if(!system.runOne(queue)) {
+				// The timeout only guards against missed wakeups
+				wakeup.wait(100);
+			}
+		}
+	}
+	
+};
+
+JobSystem::JobSystem(size_t threadCount) : next(0), stopping(false) {
+	
+	if(threadCount == 0) {
+		threadCount = 1;
+	}
+	
+	queues.resize(threadCount);
+	for(size_t i = 0; i < threadCount; i++) {
+		queues[i] = new Queue;
+	}
+	
+	workers.resize(threadCount - 1);
+	for(size_t i = 0; i < workers.size(); i++) {
+		workers[i] = new Worker(*this, i + 1);
+		workers[i]->start();
+	}
+}
+
+JobSystem::~JobSystem() {
+	
+	{
+		Autolock lock(mutex);
+		stopping = true;
+	}
+	
+	for(size_t i = 0; i < workers.size(); i++) {
+		workers[i]->wakeup.signal();
+	}
+	
+	for(size_t i = 0; i < workers.size(); i++) {
+		workers[i]->waitForCompletion();
+		delete workers[i];
+	}
+	
+	for(size_t i = 0; i < queues.size(); i++) {
+		delete queues[i];
+	}
+}
+
+bool JobSystem::isStopping() {
+	Autolock lock(mutex);
+	return stopping;
+}
+
+void JobSystem::submit(Job & job, JobGroup & group) {
+	
+	{
+		Autolock lock(group.mutex);
+		group.pending++;
+	}
+	
+	size_t queue;
+	{
+		Autolock lock(mutex);
+		queue = next;
+		next = (next + 1) % queues.size();
+	}
+	
+	Entry entry;
+	entry.job = &job;
+	entry.group = &group;
+	{
+		Autolock lock(queues[queue]->mutex);
+		queues[queue]->entries.push_back(entry);
+	}
+	
+	if(queue > 0) {
+		workers[queue - 1]->wakeup.signal();
+	}
+}
+
+bool JobSystem::runOne(size_t queue) {
+	
+	Entry entry;
+	bool found = false;
+	
+	// Own queue first, newest job
+	{
+		Queue & own = *queues[queue];
+		Autolock lock(own.mutex);
+		if(!own.entries.empty()) {
+			entry = own.entries.back();
+			own.entries.pop_back();
+			found = true;
+		}
+	}
+	
+	// Steal the oldest job from another queue
+	for(size_t i = 1; !found && i < queues.size(); i++) {
+		Queue & victim = *queues[(queue + i) % queues.size()];
+		Autolock lock(victim.mutex);
+		if(!victim.entries.empty()) {
+			entry = victim.entries.front();
+			victim.entries.pop_front();
+			found = true;
+		}
+	}
+	
+	if(!found) {
+		return false;
+	}
+	
+	entry.job->run();
+	
+	// Signal while holding the lock: the group may be destroyed as soon as
+	// wait() sees that it is done.
+	JobGroup & group = *entry.group;
+	Autolock lock(group.mutex);
+	if(--group.pending == 0) {
+		group.finished.signal();
+	}
+	
+	return true;
+}
+
+void JobSystem::wait(JobGroup & group) {
+	while(!group.isDone()) {
+		if(!runOne(0)) {
+			// Remaining jobs are running on other threads
+			group.finished.wait(1);
+		}
+	}
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ARX_PLATFORM_JOBSYSTEM_H
+#define ARX_PLATFORM_JOBSYSTEM_H
+
+#include <stddef.h>
+#include <deque>
+#include <vector>
+
+#include "platform/Lock.h"
+
+class JobSystem;
+
+/*!
+ * A piece of work that can be run on any thread of a JobSystem.
+ */
+class Job {
+	
+public:
+	
+	virtual ~Job() { }
+	
+	/*!
+	 * Run the job.
+	 * Jobs submitted to the same group may run concurrently and must not touch
+	 * data that is shared with other jobs in that group.
+	 */
+	virtual void run() = 0;
+	
+};
+
+/*!
+ * A set of submitted jobs that can be waited for.
+ * The group must outlive all jobs submitted to it.
+ */
+class JobGroup {
+	
+public:
+	
+	JobGroup() : pending(0) { }
+	
+	//! @return true if all jobs submitted to this group have finished
+	bool isDone();
+	
+private:
+	
+	Lock mutex;
+	Event finished;
+	size_t pending;
+	
+	friend class JobSystem;
+	
+};
+
+/*!
+ * A pool of persistent worker threads with one job queue per thread.
+ *
+ * Jobs are distributed over the queues in turn. Each thread runs the newest
+ * job from its own queue and, once that is empty, steals the oldest job
+ * from the other queues, so uneven jobs are balanced without a shared queue.
+ * The thread calling wait() owns the first queue and helps with the work
+ * until the group is done, which makes wait() a synchronization point:
+ * everything written by the jobs is visible to the caller afterwards.
+ */
+class JobSystem {
+	
+public:
+	
+	/*!
+	 * @param threadCount the number of threads that run jobs, including the
+	 *                    thread calling wait(): count - 1 workers are started
+	 */
+	explicit JobSystem(size_t threadCount);
+	
+	//! Stop all worker threads, jobs that have not been run yet are dropped.
+	~JobSystem();
+	
+	size_t getThreadCount() const { return queues.size(); }
+	
+	//! Queue a job to be run by any thread.
+	void submit(Job & job, JobGroup & group);
+	
+	//! Run queued jobs until all jobs in the group have finished.
+	void wait(JobGroup & group);
+	
+private:
+	
+	struct Entry {
+		Job * job;
+		JobGroup * group;
+	};
+	
+	struct Queue {
+		Lock mutex;
+		std::deque<Entry> entries;
+	};
+	
+	class Worker;
+	
+	bool runOne(size_t queue);
+	bool isStopping();
+	
+	std::vector<Queue *> queues;
+	std::vector<Worker *> workers;
+	
+	Lock mutex;
+	size_t next;
+	bool stopping;
+	
+};
+
+#endif // ARX_PLATFORM_JOBSYSTEM_H
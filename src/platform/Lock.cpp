@@ -23,6 +23,9 @@
 
 #if defined(ARX_HAVE_PTHREADS)
 
+#include <errno.h>
+#include <sys/time.h>
+
 Lock::Lock() : locked(false) {
 	const pthread_mutex_t mutex_init = PTHREAD_MUTEX_INITIALIZER;
 	mutex = mutex_init;
@@ -55,6 +58,49 @@ void Lock::unlock() {
 	pthread_mutex_unlock(&mutex);
 }
 
+Event::Event() : signaled(false) {
+	const pthread_mutex_t mutex_init = PTHREAD_MUTEX_INITIALIZER;
+	mutex = mutex_init;
+	const pthread_cond_t cond_init = PTHREAD_COND_INITIALIZER;
+	cond = cond_init;
+}
+
+Event::~Event() {
+	
+}
+
+void Event::signal() {
+	pthread_mutex_lock(&mutex);
+	signaled = true;
+	pthread_cond_signal(&cond);
+	pthread_mutex_unlock(&mutex);
+}
+
+bool Event::wait(unsigned timeout) {
+	
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	
+	long nsec = long(now.tv_usec) * 1000 + long(timeout % 1000) * 1000000;
+	struct timespec until;
+	until.tv_sec = now.tv_sec + timeout / 1000 + nsec / 1000000000;
+	until.tv_nsec = nsec % 1000000000;
+	
+	pthread_mutex_lock(&mutex);
+	
+	while(!signaled) {
+		if(pthread_cond_timedwait(&cond, &mutex, &until) == ETIMEDOUT) {
+			break;
+		}
+	}
+	
+	bool result = signaled;
+	signaled = false;
+	pthread_mutex_unlock(&mutex);
+	
+	return result;
+}
+
 #elif defined(ARX_HAVE_WINAPI)
 
 Lock::Lock() {
@@ -76,4 +122,20 @@ void Lock::unlock() {
 	ReleaseMutex(mutex);
 }
 
+Event::Event() {
+	event = CreateEvent(NULL, FALSE, FALSE, NULL);
+}
+
+Event::~Event() {
+	CloseHandle(event);
+}
+
+void Event::signal() {
+	SetEvent(event);
+}
+
+bool Event::wait(unsigned timeout) {
+	return (WaitForSingleObject(event, timeout) == WAIT_OBJECT_0);
+}
+
 #endif
@@ -75,4 +75,37 @@ public:
 	
 };
 
+/*!
+ * An event that one thread can wait for until another thread signals it.
+ * The event is reset when a waiting thread wakes up.
+ */
+class Event {
+	
+private:
+	
+#if defined(ARX_HAVE_PTHREADS)
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	bool signaled;
+#elif defined(ARX_HAVE_WINAPI)
+	HANDLE event;
+#endif
+	
+public:
+	
+	Event();
+	~Event();
+	
+	//! Wake up the waiting thread, or the next thread to wait if there is none.
+	void signal();
+	
+	/*!
+	 * Wait until the event is signaled.
+	 * @param timeout The maximum time to wait in milliseconds.
+	 * @return true if the event was signaled, false if the timeout expired.
+	 */
+	bool wait(unsigned timeout);
+	
+};
+
 #endif // ARX_PLATFORM_LOCK_H
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "platform/WorkerPool.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "Configure.h"
+
+#if defined(ARX_HAVE_SYSCONF)
+#include <unistd.h>
+#elif defined(ARX_HAVE_WINAPI)
+#include <windows.h>
+#endif
+
+#include "platform/JobSystem.h"
+
+namespace WorkerPool {
+
+namespace {
+
+size_t threadCountOverride = 0;
+
+JobSystem * jobs = NULL;
+
+//! Processes a contiguous range of the items of a task
+class ItemRangeJob : public Job {
+	
+	WorkerTask * task;
+	size_t begin;
+	size_t end;
+	
+public:
+	
+	ItemRangeJob() : task(NULL), begin(0), end(0) { }
+	
+	ItemRangeJob(WorkerTask & _task, size_t _begin, size_t _end)
+		: task(&_task), begin(_begin), end(_end) { }
+	
+	void run() {
+		for(size_t item = begin; item < end; item++) {
+			task->process(item);
+		}
+	}
+	
+};
+
+size_t getProcessorCount() {
+	
+#if defined(ARX_HAVE_SYSCONF) && defined(_SC_NPROCESSORS_ONLN)
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	if(count > 0) {
+		return size_t(count);
+	}
+#elif defined(ARX_HAVE_WINAPI)
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	if(info.dwNumberOfProcessors > 0) {
+		return size_t(info.dwNumberOfProcessors);
+	}
+#endif
+	
+	return 1;
+}
+
+} // anonymous namespace
+
+size_t getThreadCount() {
+	
+	if(threadCountOverride) {
+		return threadCountOverride;
+	}
+	
+	static size_t processors = getProcessorCount();
+	return processors;
+}
+
+void setThreadCount(size_t count) {
+	threadCountOverride = count;
+}
+
+void run(WorkerTask & task, size_t count) {
+	
+	if(count == 0) {
+		return;
+	}
+	
+	size_t threads = getThreadCount();
+	if(threads == 1 || count == 1) {
+		for(size_t item = 0; item < count; item++) {
+			task.process(item);
+		}
+		return;
+	}
+	
+	if(!jobs || jobs->getThreadCount() != threads) {
+		delete jobs;
+		jobs = new JobSystem(threads);
+	}
+	
+	// Use a few jobs per thread so that uneven items can be balanced by stealing
+	size_t jobCount = std::min(count, threads * 4);
+	std::vector<ItemRangeJob> ranges(jobCount);
+	
+	JobGroup group;
+	for(size_t i = 0; i < jobCount; i++) {
+		ranges[i] = ItemRangeJob(task, count * i / jobCount, count * (i + 1) / jobCount);
+		jobs->submit(ranges[i], group);
+	}
+	
+	jobs->wait(group);
+}
+
+void shutdown() {
+	delete jobs, jobs = NULL;
+}
+
+} // namespace WorkerPool
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ARX_PLATFORM_WORKERPOOL_H
+#define ARX_PLATFORM_WORKERPOOL_H
+
+#include <stddef.h>
+
+/*!
+ * A unit of work that can be split into independent items.
+ */
+class WorkerTask {
+	
+public:
+	
+	virtual ~WorkerTask() { }
+	
+	/*!
+	 * Process a single work item.
+	 * This may be called concurrently for different items and must not touch
+	 * data that is shared with other items.
+	 */
+	virtual void process(size_t item) = 0;
+	
+};
+
+namespace WorkerPool {
+
+/*!
+ * Get the number of threads (including the calling thread) used by run().
+ */
+size_t getThreadCount();
+
+/*!
+ * Override the number of threads used by run().
+ * @param count The number of threads to use, or 0 to use one per processor.
+ */
+void setThreadCount(size_t count);
+
+/*!
+ * Process items [0, count) of a task and wait until all items have been processed.
+ * The calling thread takes part in the work. Each item is processed exactly once,
+ * so the result does not depend on the number of threads as long as the items
+ * are independent.
+ * The worker threads are started on first use and kept until shutdown().
+ * run() must only be called from one thread at a time.
+ */
+void run(WorkerTask & task, size_t count);
+
+//! Stop the worker threads.
+void shutdown();
+
+} // namespace WorkerPool
+
+#endif // ARX_PLATFORM_WORKERPOOL_H
@@ -49,6 +49,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #include <iomanip>
 #include <sstream>
 #include <cstdio>
+#include <vector>
 
 #include <boost/algorithm/string/case_conv.hpp>
 
@@ -82,6 +83,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 
 #include "scene/Interactive.h"
 #include "scene/GameSound.h"
+#include "scene/LevelLoader.h"
 #include "scene/LoadLevel.h"
 #include "scene/SaveFormat.h"
 #include "scene/Light.h"
@@ -267,7 +269,7 @@ void ARX_CHANGELEVEL_Change(const string & level, const string & target, long an
 	
 	LogDebug("ARX_CHANGELEVEL_Change " << level << " " << target << " " << angle);
 	
-	PROGRESS_BAR_TOTAL = 238; 
+	PROGRESS_BAR_TOTAL = 238 + LEVELLOADER_PROGRESS;
 	OLD_PROGRESS_BAR_COUNT = PROGRESS_BAR_COUNT = 0;
 	
 	ARX_CHANGELEVEL_DesiredTime = arxtime.get_updated();
@@ -296,6 +298,9 @@ void ARX_CHANGELEVEL_Change(const string & level, const string & target, long an
 		return; // nothing more to do :)
 	}
 	
+	// Read the new level in the background while the current one is saved
+	ARX_LEVELLOADER_Start(num);
+	
 	ARX_PLAYER_Reset_Fall();
 	
 	arxtime.pause();
@@ -1070,20 +1075,10 @@ static long ARX_CHANGELEVEL_Push_IO(const Entity * io, long level) {
 	FillTargetInfo(ais.id_targetinfo, numtarget);
 
 	// Save Local Timers ?
-	long count = 0;
+	std::vector<long> timers;
+	ARX_SCRIPT_Timer_GetForIO(io, timers);
 
-	for (int i = 0; i < MAX_TIMER_SCRIPT; i++)
-	{
-		if (scr_timer[i].exist)
-		{
-			if (scr_timer[i].io == io)
-			{
-				count++;
-			}
-		}
-	}
-
-	ais.nbtimers = count;
+	ais.nbtimers = timers.size();
 
 	long allocsize =
 		sizeof(ARX_CHANGELEVEL_IO_SAVE)
@@ -1109,33 +1104,29 @@ static long ARX_CHANGELEVEL_Push_IO(const Entity * io, long level) {
 
 	long timm = (unsigned long)(arxtime); //treat warning C4244 conversion from 'float' to 'unsigned long''
 
-	for (int i = 0; i < MAX_TIMER_SCRIPT; i++)
+	for (size_t k = 0; k < timers.size(); k++)
 	{
-		if (scr_timer[i].exist)
-		{
-			if (scr_timer[i].io == io)
-			{
-				ARX_CHANGELEVEL_TIMERS_SAVE * ats = (ARX_CHANGELEVEL_TIMERS_SAVE *)(dat + pos);
-				memset(ats, 0, sizeof(ARX_CHANGELEVEL_TIMERS_SAVE));
-				ats->longinfo = scr_timer[i].longinfo;
-				ats->msecs = scr_timer[i].msecs;
-				strcpy(ats->name, scr_timer[i].name.c_str());
-				ats->pos = scr_timer[i].pos;
+		long i = timers[k];
+		
+		ARX_CHANGELEVEL_TIMERS_SAVE * ats = (ARX_CHANGELEVEL_TIMERS_SAVE *)(dat + pos);
+		memset(ats, 0, sizeof(ARX_CHANGELEVEL_TIMERS_SAVE));
+		ats->longinfo = scr_timer[i].longinfo;
+		ats->msecs = scr_timer[i].msecs;
+		strcpy(ats->name, scr_timer[i].name.c_str());
+		ats->pos = scr_timer[i].pos;
 
-				if (scr_timer[i].es == &io->script)
-					ats->script = 0;
-				else	ats->script = 1;
+		if (scr_timer[i].es == &io->script)
+			ats->script = 0;
+		else	ats->script = 1;
 
-				ats->tim = (scr_timer[i].tim + scr_timer[i].msecs) - timm;
+		ats->tim = (scr_timer[i].tim + scr_timer[i].msecs) - timm;
 
-				if (ats->tim < 0) ats->tim = 0;
+		if (ats->tim < 0) ats->tim = 0;
 
-				//else ats->tim=-ats->tim;
-				ats->times = scr_timer[i].times;
-				ats->flags = scr_timer[i].flags;
-				pos += sizeof(ARX_CHANGELEVEL_TIMERS_SAVE);
-			}
-		}
+		//else ats->tim=-ats->tim;
+		ats->times = scr_timer[i].times;
+		ats->flags = scr_timer[i].flags;
+		pos += sizeof(ARX_CHANGELEVEL_TIMERS_SAVE);
 	}
 
 	ARX_CHANGELEVEL_SCRIPT_SAVE * ass = (ARX_CHANGELEVEL_SCRIPT_SAVE *)(dat + pos);
@@ -1584,6 +1575,7 @@ long ARX_CHANGELEVEL_Pop_Level(ARX_CHANGELEVEL_INDEX * asi, long num, long First
 	ARX_CHANGELEVEL_Pop_Globals();
 	
 	DanaeLoadLevel(levelFile, FirstTime);
+	ARX_LEVELLOADER_Stop();
 	CleanScriptLoadedIO();
 	
 	FirstFrame = 1;
@@ -1789,6 +1781,7 @@ static long ARX_CHANGELEVEL_Pop_Player() {
 			}
 		}
 	}
+	ARX_INVENTORY_IndexInventory(0);
 	
 	if(size < pos + (asp->nb_PlayerQuest * 80)) {
 		LogError << "truncated data";
@@ -2130,8 +2123,6 @@ static Entity * ARX_CHANGELEVEL_Pop_IO(const string & ident, long num) {
 				continue;
 			}
 			
-			ActiveTimers++;
-			
 			if(ats->script) {
 				scr_timer[num].es = &io->over_script;
 			} else {
@@ -2139,8 +2130,7 @@ static Entity * ARX_CHANGELEVEL_Pop_IO(const string & ident, long num) {
 			}
 			
 			scr_timer[num].flags = sFlags;
-			scr_timer[num].exist = 1;
-			scr_timer[num].io = io;
+			scr_timer[num].io = entities.handle(io);
 			scr_timer[num].msecs = ats->msecs;
 			scr_timer[num].name = boost::to_lower_copy(util::loadString(ats->name));
 			scr_timer[num].pos = ats->pos;
@@ -2154,6 +2144,8 @@ static Entity * ARX_CHANGELEVEL_Pop_IO(const string & ident, long num) {
 			}
 			
 			scr_timer[num].times = ats->times;
+			
+			ARX_SCRIPT_Timer_Start(num);
 		}
 		
 		if(!loadScriptData(io->script, dat, pos) || !loadScriptData(io->over_script, dat, pos)) {
@@ -2438,6 +2430,7 @@ static void ARX_CHANGELEVEL_PopAllIO_FINISH(long reloadflag, bool firstTime) {
 							inv->slot[m][n].show = aids->slot_show[m][n];
 						}
 					}
+					ARX_INVENTORY_IndexInventory(io->index());
 				}
 			}
 			
@@ -2695,6 +2688,7 @@ static bool ARX_CHANGELEVEL_PopLevel(long instance, long reloadflag) {
 		for(long i = 0; i < MAX_TIMER_SCRIPT; i++) {
 			if(scr_timer[i].exist) {
 				scr_timer[i].tim = ulDTime;
+				ARX_SCRIPT_Timer_Update(i);
 			}
 		}
 	} else {
@@ -549,6 +549,7 @@ long ARX_SOUND_PlayInterface(SourceId & sample_id, float pitch, SoundLoopMode lo
 	audio::Channel channel;
 
 	channel.mixer = ARX_SOUND_MixerGameSample;
+	channel.priority = audio::PRIORITY_HIGH;
 	channel.flags = FLAG_VOLUME;
 	channel.volume = 1.0F;
 
@@ -566,6 +567,7 @@ long ARX_SOUND_PlayMenu(SourceId & sample_id, float pitch, SoundLoopMode loop) {
 	audio::Channel channel;
 
 	channel.mixer = ARX_SOUND_MixerMenuSample;
+	channel.priority = audio::PRIORITY_HIGH;
 	channel.flags = FLAG_VOLUME;
 	channel.volume = 1.0F;
 
@@ -608,6 +610,7 @@ long ARX_SOUND_PlaySpeech(const res::path & name, const Entity * io)
 	sample_id = audio::createSample(file);
 
 	channel.mixer = ARX_SOUND_MixerGameSpeech;
+	channel.priority = audio::PRIORITY_HIGH;
 	channel.flags = FLAG_VOLUME | FLAG_POSITION | FLAG_REVERBERATION | FLAG_AUTOFREE | FLAG_FALLOFF;
 	channel.volume = 1.f;
 	channel.falloff.start = ARX_SOUND_DEFAULT_FALLSTART;
@@ -664,6 +667,7 @@ long ARX_SOUND_PlayCollision(long mat1, long mat2, float volume, float power, Ve
 	float presence;
 
 	channel.mixer = ARX_SOUND_MixerGameSample;
+	channel.priority = audio::PRIORITY_LOW;
 
 	channel.flags = FLAG_VOLUME | FLAG_PITCH | FLAG_POSITION | FLAG_REVERBERATION | FLAG_FALLOFF;
 
@@ -729,6 +733,7 @@ long ARX_SOUND_PlayCollision(const string & name1, const string & name2, float v
 	
 	audio::Channel channel;
 	channel.mixer = ARX_SOUND_MixerGameSample;
+	channel.priority = audio::PRIORITY_LOW;
 	channel.flags = FLAG_VOLUME | FLAG_PITCH | FLAG_POSITION | FLAG_REVERBERATION | FLAG_FALLOFF;
 	
 	res::path sample_name;
@@ -844,6 +849,7 @@ long ARX_SOUND_PlayCinematic(const res::path & name, bool isSpeech) {
 	
 	audio::Channel channel;
 	channel.mixer = ARX_SOUND_MixerGameSpeech;
+	channel.priority = audio::PRIORITY_HIGH;
 	channel.flags = FLAG_VOLUME | FLAG_AUTOFREE | FLAG_POSITION | FLAG_FALLOFF
 	                | FLAG_REVERBERATION | FLAG_POSITION;
 	channel.volume = 1.0f;
@@ -1833,9 +1839,9 @@ class SoundUpdateThread : public StoppableThread {
 		
 		while(!isStopRequested()) {
 			
-			sleep(ARX_SOUND_UPDATE_INTERVAL);
-			
 			audio::update();
+			
+			audio::waitForUpdate(ARX_SOUND_UPDATE_INTERVAL);
 		}
 		
 	}
@@ -261,11 +261,12 @@ void ARX_INTERACTIVE_DestroyDynamicInfo(Entity * io)
 
 	if (io->flarecount)
 	{
+		EntityHandle handle = entities.handle(io);
 		for (long i = 0; i < MAX_FLARES; i++)
 		{
 			if ((flare[i].exist)
-			        &&	(flare[i].io == io))
-				flare[i].io = NULL;
+			        &&	(flare[i].io == handle))
+				flare[i].io = EntityHandle();
 		}
 	}
 	
@@ -478,7 +479,27 @@ TREATZONE_IO * treatio = NULL;
 long TREATZONE_CUR = 0;
 static long TREATZONE_MAX = 0;
 
+// Position of each entity in treatio, indexed by entity index, or -1
+static std::vector<long> treatzoneSlots;
+
+static long TREATZONE_GetSlot(const Entity * io) {
+	size_t index = io->index();
+	return (index < treatzoneSlots.size()) ? treatzoneSlots[index] : -1;
+}
+
+bool TREATZONE_Contains(const Entity * io) {
+	return TREATZONE_GetSlot(io) >= 0;
+}
+
 void TREATZONE_Clear() {
+	
+	for(long i = 0; i < TREATZONE_CUR; i++) {
+		if(treatio[i].io) {
+			treatio[i].io->gameFlags &= ~GFLAG_ISINTREATZONE;
+			treatzoneSlots[treatio[i].num] = -1;
+		}
+	}
+	
 	TREATZONE_CUR = 0;
 }
 
@@ -486,49 +507,85 @@ void TREATZONE_Release() {
 	free(treatio), treatio = NULL;
 	TREATZONE_MAX = 0;
 	TREATZONE_CUR = 0;
+	treatzoneSlots.clear();
 }
 
-void TREATZONE_RemoveIO(Entity * io)
-{
-	if (treatio)
-	{
-		for (long i = 0; i < TREATZONE_CUR; i++)
-		{
-			if (treatio[i].io == io)
-			{
-				treatio[i].io = NULL;
-				treatio[i].ioflags = 0;
-				treatio[i].show = 0;
-			}
-		}
+void TREATZONE_RemoveIO(Entity * io) {
+	
+	io->gameFlags &= ~GFLAG_ISINTREATZONE;
+	
+	long slot = TREATZONE_GetSlot(io);
+	if(slot < 0) {
+		return;
 	}
+	
+	// Leave a hole so that loops over treatio can continue safely
+	treatio[slot].io = NULL;
+	treatio[slot].ioflags = 0;
+	treatio[slot].show = 0;
+	treatzoneSlots[io->index()] = -1;
 }
 
 // flag & 1 IO_JUST_COLLIDE
-void TREATZONE_AddIO(Entity * io, long flag)
-{
-	if (TREATZONE_MAX == TREATZONE_CUR)
-	{
-		TREATZONE_MAX++;
-		treatio = (TREATZONE_IO *)realloc(treatio, sizeof(TREATZONE_IO) * TREATZONE_MAX);
+void TREATZONE_AddIO(Entity * io, long flag) {
+	
+	size_t index = io->index();
+	if(index >= treatzoneSlots.size()) {
+		treatzoneSlots.resize(std::max(index + 1, entities.size()), -1);
+	} else if(treatzoneSlots[index] >= 0) {
+		return;
 	}
-
-	for (long i = 0; i < TREATZONE_CUR; i++)
-	{
-		if (treatio[i].io == io)
-			return;
+	
+	if(TREATZONE_MAX == TREATZONE_CUR) {
+		TREATZONE_MAX = std::max(TREATZONE_MAX * 2, 64L);
+		treatio = (TREATZONE_IO *)realloc(treatio, sizeof(TREATZONE_IO) * TREATZONE_MAX);
 	}
-
+	
 	treatio[TREATZONE_CUR].io = io;
 	treatio[TREATZONE_CUR].ioflags = io->ioflags;
-
-	if (flag & 1) treatio[TREATZONE_CUR].ioflags |= IO_JUST_COLLIDE;
-
+	
+	if(flag & 1) {
+		treatio[TREATZONE_CUR].ioflags |= IO_JUST_COLLIDE;
+	} else {
+		io->gameFlags |= GFLAG_ISINTREATZONE;
+	}
+	
 	treatio[TREATZONE_CUR].show = io->show;
-	treatio[TREATZONE_CUR].num = io->index();
+	treatio[TREATZONE_CUR].num = index;
+	treatzoneSlots[index] = TREATZONE_CUR;
 	TREATZONE_CUR++;
 }
 
+/*!
+ * Removes the holes left by TREATZONE_RemoveIO() and the entities that were only
+ * added for collisions, and refreshes the cached state of the remaining entities.
+ */
+static void TREATZONE_Compact() {
+	
+	long count = 0;
+	
+	for(long i = 0; i < TREATZONE_CUR; i++) {
+		
+		Entity * io = treatio[i].io;
+		if(!io) {
+			continue;
+		}
+		
+		if(treatio[i].ioflags & IO_JUST_COLLIDE) {
+			treatzoneSlots[treatio[i].num] = -1;
+			continue;
+		}
+		
+		treatio[count] = treatio[i];
+		treatio[count].ioflags = io->ioflags;
+		treatio[count].show = io->show;
+		treatzoneSlots[treatio[count].num] = count;
+		count++;
+	}
+	
+	TREATZONE_CUR = count;
+}
+
 void CheckSetAnimOutOfTreatZone(Entity * io, long num)
 {
 	if ((io)
@@ -543,6 +600,19 @@ void CheckSetAnimOutOfTreatZone(Entity * io, long num)
 	}
 }
 
+//! Entities in the level, not in an inventory and not destroyed
+static bool IsInTreatableState(const Entity * io) {
+	return io->show == SHOW_FLAG_IN_SCENE || io->show == SHOW_FLAG_TELEPORTING
+	       || io->show == SHOW_FLAG_ON_PLAYER || io->show == SHOW_FLAG_HIDDEN;
+}
+
+//! Cell of a 300x300 grid on the x-z plane containing pos, offset by x and z cells
+static u64 TREATZONE_GetCell(const Vec3f & pos, int x, int z) {
+	s32 cx = s32(std::floor(pos.x * (1.f / 300.f))) + x;
+	s32 cz = s32(std::floor(pos.z * (1.f / 300.f))) + z;
+	return (u64(u32(cx)) << 32) | u64(u32(cz));
+}
+
 long GLOBAL_Player_Room = -1;
 void PrepareIOTreatZone(long flag)
 {
@@ -565,7 +635,12 @@ void PrepareIOTreatZone(long flag)
 
 	if (status++) return;
 
-	TREATZONE_Clear();
+	// Entities stay in the treat zone until they leave it, only update the changes
+	TREATZONE_Compact();
+	if(TREATZONE_CUR > 0 && treatio[0].io != entities.player()) {
+		TREATZONE_Clear();
+	}
+	
 	long Cam_Room = ARX_PORTALS_GetRoomNumForPosition(&ACTIVECAM->pos, 1);
 	GLOBAL_Player_Room = ARX_PORTALS_GetRoomNumForPosition(&player.pos, 1);
 	TREATZONE_AddIO(entities.player());
@@ -611,123 +686,127 @@ void PrepareIOTreatZone(long flag)
 	char treat;
 	for(size_t i = 1; i < entities.size(); i++) {
 		Entity * io = entities[i];
-
-		if ((io)
-		        &&	((io->show == SHOW_FLAG_IN_SCENE)
-		             ||	(io->show == SHOW_FLAG_TELEPORTING)
-		             ||	(io->show == SHOW_FLAG_ON_PLAYER)
-		             ||	(io->show == SHOW_FLAG_HIDDEN)))   
+		
+		if(!io) {
+			continue;
+		}
+		
+		if(!IsInTreatableState(io)) {
+			// Picked up, destroyed or otherwise removed from the scene
+			TREATZONE_RemoveIO(io);
+			continue;
+		}
+		
+		if ((io->ioflags & IO_CAMERA) && (!EDITMODE))
+			treat = 0;
+		else if ((io->ioflags & IO_MARKER) && (!EDITMODE))
+			treat = 0;
+		else if ((io->ioflags & IO_NPC) 
+		         && (io->_npcdata->pathfind.flags & PATHFIND_ALWAYS))
 		{
-			if ((io->ioflags & IO_CAMERA) && (!EDITMODE))
-				treat = 0;
-			else if ((io->ioflags & IO_MARKER) && (!EDITMODE))
-				treat = 0;
-			else if ((io->ioflags & IO_NPC) 
-			         && (io->_npcdata->pathfind.flags & PATHFIND_ALWAYS))
-			{
-				treat = 1;
-			}
-			else
-			{
-				float dists;
+			treat = 1;
+		}
+		else
+		{
+			float dists;
 
-				if (Cam_Room >= 0)
+			if (Cam_Room >= 0)
+			{
+				if (io->show == SHOW_FLAG_TELEPORTING)
 				{
-					if (io->show == SHOW_FLAG_TELEPORTING)
-					{
-						Vec3f pos;
-						GetItemWorldPosition(io, &pos);
-						dists = distSqr(ACTIVECAM->pos, pos);
-					}
-					else
-					{
-						if (io->room_flags & 1)
-							UpdateIORoom(io);
-
-						dists = square(SP_GetRoomDist(&io->pos, &ACTIVECAM->pos, io->room, Cam_Room));
-					}
+					Vec3f pos;
+					GetItemWorldPosition(io, &pos);
+					dists = distSqr(ACTIVECAM->pos, pos);
 				}
 				else
 				{
-					if (io->show == SHOW_FLAG_TELEPORTING)
-					{
-						Vec3f pos;
-						GetItemWorldPosition(io, &pos);
-						dists = distSqr(ACTIVECAM->pos, pos); //&io->pos,&pos);
-					}
-					else
-						dists = distSqr(io->pos, ACTIVECAM->pos);
+					if (io->room_flags & 1)
+						UpdateIORoom(io);
+
+					dists = square(SP_GetRoomDist(&io->pos, &ACTIVECAM->pos, io->room, Cam_Room));
 				}
-		
-				if (dists < square(TREATZONE_LIMIT)) treat = 1;
-				else treat = 0;
-				
 			}
-
-			if (!treat)
+			else
 			{
-				if (io == CAMERACONTROLLER)
-					treat = 1;
-
-				if (io == DRAGINTER)
-					treat = 1;
-			}
-			
-			if(io->gameFlags & GFLAG_ISINTREATZONE) {
-				io->gameFlags |= GFLAG_WASINTREATZONE;
-			} else {
-				io->gameFlags &= ~GFLAG_WASINTREATZONE;
-			}
-			
-			if(treat) {
-				io->gameFlags |= GFLAG_ISINTREATZONE;
-				TREATZONE_AddIO(io);
-				if((io->ioflags & IO_NPC) && io->_npcdata->weapon) {
-					Entity * iooo = io->_npcdata->weapon;
-					iooo->room = io->room;
-					iooo->room_flags = io->room_flags;
+				if (io->show == SHOW_FLAG_TELEPORTING)
+				{
+					Vec3f pos;
+					GetItemWorldPosition(io, &pos);
+					dists = distSqr(ACTIVECAM->pos, pos); //&io->pos,&pos);
 				}
-			} else {
-				io->gameFlags &= ~GFLAG_ISINTREATZONE;
+				else
+					dists = distSqr(io->pos, ACTIVECAM->pos);
 			}
+	
+			if (dists < square(TREATZONE_LIMIT)) treat = 1;
+			else treat = 0;
 			
-			EVENT_SENDER = NULL;
+		}
 
-			if ((io->gameFlags & GFLAG_ISINTREATZONE)
-			        && (!(io->gameFlags & GFLAG_WASINTREATZONE)))
-			{
-				//coming back; doesn't really matter right now
-				//	SendIOScriptEvent(entities[i],SM_TREATIN);
+		if (!treat)
+		{
+			if (io == CAMERACONTROLLER)
+				treat = 1;
 
+			if (io == DRAGINTER)
+				treat = 1;
+		}
+		
+		if(io->gameFlags & GFLAG_ISINTREATZONE) {
+			io->gameFlags |= GFLAG_WASINTREATZONE;
+		} else {
+			io->gameFlags &= ~GFLAG_WASINTREATZONE;
+		}
+		
+		if(treat) {
+			TREATZONE_AddIO(io);
+			if((io->ioflags & IO_NPC) && io->_npcdata->weapon) {
+				Entity * iooo = io->_npcdata->weapon;
+				iooo->room = io->room;
+				iooo->room_flags = io->room_flags;
 			}
-			else if ((!(io->gameFlags & GFLAG_ISINTREATZONE))
-			         &&	(io->gameFlags & GFLAG_WASINTREATZONE))
-			{
-				//going away;
-				io->gameFlags |= GFLAG_ISINTREATZONE;
-
-				if (SendIOScriptEvent(io, SM_TREATOUT) != REFUSE)
-				{
-					if (io->ioflags & IO_NPC)
-						io->_npcdata->pathfind.flags &= ~PATHFIND_ALWAYS;
-
-					io->gameFlags &= ~GFLAG_ISINTREATZONE;
+		} else if(io->gameFlags & GFLAG_WASINTREATZONE) {
+			
+			//going away;
+			EVENT_SENDER = NULL;
+			
+			if(SendIOScriptEvent(io, SM_TREATOUT) != REFUSE) {
+				if(io->ioflags & IO_NPC) {
+					io->_npcdata->pathfind.flags &= ~PATHFIND_ALWAYS;
 				}
+				TREATZONE_RemoveIO(io);
+			} else {
+				TREATZONE_AddIO(io);
 			}
 		}
 	}
-
+	
+	// Entities close to the ones in the treat zone still need to collide with them
+	
 	long M_TREAT = TREATZONE_CUR;
-
+	
+	static std::vector< std::pair<u64, Entity *> > cells;
+	cells.clear();
+	
+	for(long i = 1; i < M_TREAT; i++) {
+		Entity * ioo = treatio[i].io;
+		if(ioo && IsInTreatableState(ioo)) {
+			cells.push_back(std::make_pair(TREATZONE_GetCell(ioo->pos, 0, 0), ioo));
+		}
+	}
+	
+	if(cells.empty()) {
+		return;
+	}
+	
+	std::sort(cells.begin(), cells.end());
+	
 	for(size_t i = 1; i < entities.size(); i++) {
 		Entity * io = entities[i];
 
 		if ((io != NULL)
 		        &&	!(io->gameFlags & GFLAG_ISINTREATZONE)
-		        && ((io->show == SHOW_FLAG_IN_SCENE)
-		            ||	(io->show == SHOW_FLAG_TELEPORTING)
-		            ||	(io->show == SHOW_FLAG_ON_PLAYER)
-		            ||	(io->show == SHOW_FLAG_HIDDEN)))   // show 5 = ininventory; 15 = destroyed
+		        &&	IsInTreatableState(io))
 		{
 			if ((io->ioflags & IO_CAMERA)
 			        ||	(io->ioflags & IO_ITEM)
@@ -736,16 +815,19 @@ void PrepareIOTreatZone(long flag)
 
 			long toadd = 0;
 
-			for (long ii = 1; ii < M_TREAT; ii++)
-			{
-				Entity * ioo = treatio[ii].io;
-
-				if (ioo)
-				{
-					if (distSqr(io->pos, ioo->pos) < square(300.f))
-					{
-						toadd = 1;
-						break;
+			for(int x = -1; x <= 1 && !toadd; x++) {
+				for(int z = -1; z <= 1 && !toadd; z++) {
+					
+					u64 cell = TREATZONE_GetCell(io->pos, x, z);
+					std::vector< std::pair<u64, Entity *> >::const_iterator it;
+					it = std::lower_bound(cells.begin(), cells.end(),
+					                      std::make_pair(cell, (Entity *)NULL));
+					
+					for(; it != cells.end() && it->first == cell; ++it) {
+						if(distSqr(io->pos, it->second->pos) < square(300.f)) {
+							toadd = 1;
+							break;
+						}
 					}
 				}
 			}
@@ -1227,11 +1309,12 @@ void RestoreInitialIOStatusOfIO(Entity * io)
 		//HALO_NEGATIVE;
 		io->no_collide = -1;
 
+		EntityHandle handle = entities.handle(io);
 		for (long i = 0; i < MAX_FLARES; i++)
 		{
-			if ((flare[i].exist)  && (flare[i].io == io))
+			if ((flare[i].exist)  && (flare[i].io == handle))
 			{
-				flare[i].io = NULL;
+				flare[i].io = EntityHandle();
 			}
 		}
 
@@ -1245,7 +1328,7 @@ void RestoreInitialIOStatusOfIO(Entity * io)
 		io->gameFlags &= ~GFLAG_INVISIBILITY;
 		io->gameFlags &= ~GFLAG_MEGAHIDE;
 		io->gameFlags &= ~GFLAG_NOGORE;
-		io->gameFlags &= ~GFLAG_ISINTREATZONE;
+		TREATZONE_RemoveIO(io);
 		io->gameFlags &= ~GFLAG_PLATFORM;
 		io->gameFlags &= ~GFLAG_ELEVATOR;
 		io->gameFlags &= ~GFLAG_HIDEWEAPON;
@@ -1515,15 +1598,14 @@ void ARX_INTERACTIVE_TeleportBehindTarget(Entity * io)
 		if (num != -1)
 		{
 			long t = io->index();
-			ActiveTimers++;
 			scr_timer[num].es = NULL;
-			scr_timer[num].exist = 1;
-			scr_timer[num].io = io;
+			scr_timer[num].io = entities.handle(io);
 			scr_timer[num].msecs = Random::get(3000, 6000);
 			scr_timer[num].name = "_r_a_t_";
 			scr_timer[num].pos = -1; 
 			scr_timer[num].tim = (unsigned long)(arxtime);
 			scr_timer[num].times = 1;
+			ARX_SCRIPT_Timer_Start(num);
 			entities[t]->show = SHOW_FLAG_TELEPORTING;
 			AddRandomSmoke(io, 10);
 			ARX_PARTICLES_Add_Smoke(&io->pos, 3, 20);
@@ -3393,7 +3475,7 @@ void ARX_INTERACTIVE_DestroyIO(Entity * ioo)
 			// Need To Kill timers
 			ARX_SCRIPT_Timer_Clear_By_IO(ioo);
 			ioo->show = SHOW_FLAG_DESTROYED;
-			ioo->gameFlags &= ~GFLAG_ISINTREATZONE;
+			TREATZONE_RemoveIO(ioo);
 
 			if (!FAST_RELEASE)
 				RemoveFromAllInventories(ioo);
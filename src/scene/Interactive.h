@@ -141,7 +141,8 @@ void LinkObjToMe(Entity * io, Entity * io2, const std::string & attach);
  * ValidIONum and ValidIOAddress are fundamentally flawed and vulnerable to
  * index / address aliasing as both indices and memory addresses can be reused.
  *
- * We should instead use a proper weak pointer!
+ * Entity references that outlive the current frame should be stored as
+ * EntityHandle and resolved with EntityManager::get() instead.
  */
 long ValidIONum(long num);
 long ValidIOAddress(const Entity * io);
@@ -224,6 +225,11 @@ float ARX_INTERACTIVE_GetArmorClass(Entity * io);
 long  ARX_INTERACTIVE_GetPrice(Entity * io, Entity * shop);
 void IO_UnlinkAllLinkedObjects(Entity * io);
 
+/*!
+ * Entities close enough to the camera to be updated.
+ * GFLAG_ISINTREATZONE is set exactly for the entities in the treat zone that
+ * were not only added to collide with the others.
+ */
 struct TREATZONE_IO {
 	long num;
 	Entity * io;
@@ -238,6 +244,7 @@ void TREATZONE_Clear();
 void TREATZONE_Release();
 void TREATZONE_AddIO(Entity * io, long flag = 0);
 void TREATZONE_RemoveIO(Entity * io);
+bool TREATZONE_Contains(const Entity * io);
 bool IsSameObject(Entity * io, Entity * ioo);
 void ARX_INTERACTIVE_ClearAllDynData();
 bool HaveCommonGroup(Entity * io, Entity * ioo);
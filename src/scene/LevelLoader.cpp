@@ -0,0 +1,341 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "scene/LevelLoader.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <boost/crc.hpp>
+
+#include "core/Config.h"
+#include "game/Levels.h"
+#include "graphics/data/FastSceneCacheFormat.h"
+#include "graphics/data/FastSceneFormat.h"
+#include "graphics/data/Mesh.h"
+#include "gui/Interface.h"
+#include "io/Blast.h"
+#include "io/fs/FilePath.h"
+#include "io/fs/Filesystem.h"
+#include "io/log/Logger.h"
+#include "io/resource/PakReader.h"
+#include "io/resource/ResourcePath.h"
+#include "platform/Lock.h"
+#include "platform/Thread.h"
+#include "scene/LevelFormat.h"
+#include "util/String.h"
+
+extern float PROGRESS_BAR_COUNT;
+
+namespace {
+
+//! Number of files loaded for each level: .dlf, fast.fts and .llf
+const size_t LEVELLOADER_FILES = 3;
+
+struct LoaderFile {
+	
+	res::path name;
+	LevelFileData data;
+	bool ready;
+	bool taken;
+	
+	explicit LoaderFile(const res::path & name) : name(name), ready(false), taken(false) { }
+	
+};
+
+/*!
+ * Reads the files of one level. Files become available one by one in the order
+ * DanaeLoadLevel() needs them. The fast.fts file is only known after the .dlf
+ * file has been read.
+ */
+class LevelLoaderThread : public StoppableThread {
+	
+public:
+	
+	Lock mutex;
+	Event loaded;
+	
+	std::vector<LoaderFile> files;
+	size_t filesDone;
+	bool used;
+	
+	//! Progress already added to the progress bar, only used by the main thread
+	float reportedProgress;
+	
+	const long level;
+	
+	LevelLoaderThread(long level, const res::path & levelFile)
+		: filesDone(0), used(false), reportedProgress(0.f), level(level), levelFile(levelFile) {
+		files.reserve(LEVELLOADER_FILES);
+		files.push_back(LoaderFile(levelFile));
+		files.push_back(LoaderFile(res::path(levelFile).set_ext("llf")));
+	}
+	
+	~LevelLoaderThread() {
+		for(size_t i = 0; i < files.size(); i++) {
+			free(files[i].data.data);
+			free(files[i].data.unpacked);
+			delete[] files[i].data.cache;
+		}
+	}
+	
+	//! @return the file with the given name or NULL, requires mutex to be locked
+	LoaderFile * find(const res::path & name) {
+		for(size_t i = 0; i < files.size(); i++) {
+			if(files[i].name == name) {
+				return &files[i];
+			}
+		}
+		return NULL;
+	}
+	
+private:
+	
+	const res::path levelFile;
+	
+	void run();
+	
+	void finish(const res::path & name, const LevelFileData & data);
+	
+	bool loadLevel(res::path & scene, bool & compressed);
+	void loadScene(const res::path & scene);
+	void loadLighting(bool compressed);
+	
+};
+
+void LevelLoaderThread::finish(const res::path & name, const LevelFileData & data) {
+	
+	{
+		Autolock lock(mutex);
+		LoaderFile * file = find(name);
+		arx_assert(file && !file->ready);
+		file->data = data;
+		file->ready = true;
+		filesDone++;
+	}
+	
+	loaded.signal();
+}
+
+bool LevelLoaderThread::loadLevel(res::path & scene, bool & compressed) {
+	
+	LevelFileData result;
+	result.data = resources->readAlloc(levelFile, result.size);
+	
+	if(result.data && result.size >= sizeof(DANAE_LS_HEADER)) {
+		
+		DANAE_LS_HEADER dlh;
+		memcpy(&dlh, result.data, sizeof(DANAE_LS_HEADER));
+		
+		const char * dat = result.data + sizeof(DANAE_LS_HEADER);
+		size_t size = result.size - sizeof(DANAE_LS_HEADER);
+		
+		compressed = (dlh.version >= 1.44f);
+		if(compressed) {
+			result.unpacked = blastMemAlloc(dat, size, result.unpackedSize);
+			dat = result.unpacked, size = result.unpacked ? result.unpackedSize : 0;
+		}
+		
+		if(dlh.nb_scn > 0 && size >= sizeof(DANAE_LS_SCENE)) {
+			const DANAE_LS_SCENE * dls = reinterpret_cast<const DANAE_LS_SCENE *>(dat);
+			scene = res::path::load(util::loadString(dls->name));
+			Autolock lock(mutex);
+			files.push_back(LoaderFile("game" / scene / "fast.fts"));
+		}
+	}
+	
+	finish(levelFile, result);
+	
+	return !scene.empty();
+}
+
+void LevelLoaderThread::loadScene(const res::path & scene) {
+	
+	res::path file = "game" / scene / "fast.fts";
+	
+	LevelFileData result;
+	result.data = resources->readAlloc(file, result.size);
+	if(!result.data) {
+		finish(file, result);
+		return;
+	}
+	
+	boost::crc_32_type crc;
+	crc.process_bytes(result.data, result.size);
+	result.crc = crc.checksum();
+	
+	// Read the prepared scene data, it is only validated by FastSceneLoad()
+	bool cached = false;
+	if(config.misc.levelCache) {
+		fs::path cacheFile = getSceneCacheFile(scene);
+		if(!cacheFile.empty() && fs::is_regular_file(cacheFile)) {
+			result.cache = fs::read_file(cacheFile, result.cacheSize);
+		}
+		if(result.cache && result.cacheSize >= sizeof(SCENE_CACHE_HEADER)) {
+			const SCENE_CACHE_HEADER * header;
+			header = reinterpret_cast<const SCENE_CACHE_HEADER *>(result.cache);
+			cached = (header->source_hash == result.crc && header->source_size == result.size);
+		}
+	}
+	
+	// Decompress the scene data if there is no usable cache
+	if(!cached && result.size >= sizeof(UNIQUE_HEADER)) {
+		const UNIQUE_HEADER * uh = reinterpret_cast<const UNIQUE_HEADER *>(result.data);
+		size_t offset = sizeof(UNIQUE_HEADER) + size_t(uh->count) * sizeof(UNIQUE_HEADER3);
+		if(uh->version == FTS_VERSION && uh->count >= 0 && uh->uncompressedsize > 0
+		   && offset <= result.size) {
+			result.unpacked = (char *)malloc(uh->uncompressedsize);
+			if(result.unpacked) {
+				result.unpackedSize = blastMem(result.data + offset, result.size - offset,
+				                               result.unpacked, uh->uncompressedsize);
+				if(!result.unpackedSize) {
+					free(result.unpacked), result.unpacked = NULL;
+				}
+			}
+		}
+	}
+	
+	finish(file, result);
+}
+
+void LevelLoaderThread::loadLighting(bool compressed) {
+	
+	res::path file = res::path(levelFile).set_ext("llf");
+	
+	LevelFileData result;
+	result.data = resources->readAlloc(file, result.size);
+	if(result.data && compressed) {
+		result.unpacked = blastMemAlloc(result.data, result.size, result.unpackedSize);
+	}
+	
+	finish(file, result);
+}
+
+void LevelLoaderThread::run() {
+	
+	res::path scene;
+	bool compressed = false;
+	bool hasScene = loadLevel(scene, compressed);
+	
+	if(hasScene && !isStopRequested()) {
+		loadScene(scene);
+	}
+	
+	if(!isStopRequested()) {
+		loadLighting(compressed);
+	}
+	
+	LogDebug("level loader: done loading level " << level);
+}
+
+LevelLoaderThread * loader = NULL;
+
+//! Add the files loaded since the last update to the progress bar.
+void updateProgressBar() {
+	float progress = ARX_LEVELLOADER_GetProgress();
+	PROGRESS_BAR_COUNT += (progress - loader->reportedProgress) * LEVELLOADER_PROGRESS;
+	loader->reportedProgress = progress;
+}
+
+} // anonymous namespace
+
+void ARX_LEVELLOADER_Start(long num) {
+	
+	if(num < 0) {
+		return;
+	}
+	
+	if(loader) {
+		Autolock lock(loader->mutex);
+		if(loader->level == num && !loader->used) {
+			return;
+		}
+	}
+	
+	ARX_LEVELLOADER_Stop();
+	
+	char levelId[256];
+	GetLevelNameByNum(num, levelId);
+	std::string levelFile = std::string("graph/levels/level") + levelId + "/level" + levelId + ".dlf";
+	
+	LogDebug("level loader: loading " << levelFile);
+	
+	loader = new LevelLoaderThread(num, levelFile);
+	loader->setThreadName("Level Loader");
+	loader->start();
+}
+
+bool ARX_LEVELLOADER_Take(const res::path & file, LevelFileData & data) {
+	
+	if(!loader) {
+		return false;
+	}
+	
+	while(true) {
+		
+		{
+			Autolock lock(loader->mutex);
+			
+			LoaderFile * entry = loader->find(file);
+			if(!entry || entry->taken) {
+				return false;
+			}
+			
+			if(entry->ready) {
+				entry->taken = true;
+				loader->used = true;
+				data = entry->data;
+				entry->data = LevelFileData();
+				break;
+			}
+		}
+		
+		// Keep the loading screen updated while the loader thread is busy
+		updateProgressBar();
+		LoadLevelScreen();
+		loader->loaded.wait(16);
+	}
+	
+	updateProgressBar();
+	
+	return (data.data != NULL);
+}
+
+float ARX_LEVELLOADER_GetProgress() {
+	
+	if(!loader) {
+		return 0.f;
+	}
+	
+	Autolock lock(loader->mutex);
+	return float(loader->filesDone) / float(LEVELLOADER_FILES);
+}
+
+void ARX_LEVELLOADER_Stop() {
+	
+	if(!loader) {
+		return;
+	}
+	
+	loader->stop();
+	delete loader, loader = NULL;
+}
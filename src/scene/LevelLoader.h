@@ -0,0 +1,86 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ARX_SCENE_LEVELLOADER_H
+#define ARX_SCENE_LEVELLOADER_H
+
+#include <stddef.h>
+
+#include "platform/Platform.h"
+
+namespace res { class path; }
+
+/*!
+ * Contents of a level file read by the level loader thread.
+ * Ownership of all buffers is passed to the caller of ARX_LEVELLOADER_Take().
+ */
+struct LevelFileData {
+	
+	//! Contents of the file, allocated using malloc()
+	char * data;
+	size_t size;
+	
+	//! Decompressed data following the file header, allocated using malloc(), or NULL
+	char * unpacked;
+	size_t unpackedSize;
+	
+	//! CRC32 of the file contents
+	u32 crc;
+	
+	//! Contents of the level cache file for fast.fts files, allocated using new[], or NULL
+	char * cache;
+	size_t cacheSize;
+	
+	LevelFileData()
+		: data(NULL), size(0), unpacked(NULL), unpackedSize(0), crc(0),
+		  cache(NULL), cacheSize(0) { }
+	
+};
+
+//! Progress bar units reported while waiting for the loader thread.
+const float LEVELLOADER_PROGRESS = 10.f;
+
+/*!
+ * Start reading and decompressing the .dlf, fast.fts and .llf files of a level
+ * in a background thread.
+ *
+ * This can be called as soon as the next level is known so that the I/O
+ * overlaps with the remaining frames of the current level and with saving it.
+ * Calling it again for the same level has no effect until the files have been used.
+ */
+void ARX_LEVELLOADER_Start(long num);
+
+/*!
+ * Get a file prepared by the loader thread.
+ * If the loader has not finished the file yet, this waits for it while keeping
+ * the loading screen updated.
+ *
+ * @return false if the file is not being loaded in the background or could not be
+ *         read there, in which case the caller should read it itself.
+ */
+bool ARX_LEVELLOADER_Take(const res::path & file, LevelFileData & data);
+
+//! @return how much of the current level has been loaded in the background, from 0 to 1
+float ARX_LEVELLOADER_GetProgress();
+
+//! Stop the loader thread and release files that have not been used.
+void ARX_LEVELLOADER_Stop();
+
+#endif // ARX_SCENE_LEVELLOADER_H
@@ -44,6 +44,8 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 
 #include "scene/Light.h"
 
+#include <vector>
+
 #include "core/Application.h"
 #include "core/GameTime.h"
 #include "core/Core.h"
@@ -52,6 +54,9 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #include "game/Inventory.h"
 #include "graphics/Math.h"
 #include "graphics/Draw.h"
+#include "io/log/Logger.h"
+#include "platform/Time.h"
+#include "platform/WorkerPool.h"
 #include "scene/Object.h"
 #include "scene/GameSound.h"
 #include "scene/Interactive.h"
@@ -68,6 +73,8 @@ long TOTIOPDL = 0;
 
 static void ARX_EERIE_LIGHT_Make(EERIEPOLY * ep, float * epr, float * epg, float * epb, EERIE_LIGHT * light);
 
+using std::vector;
+
 bool ValidDynLight(long num)
 {
 	if (	(num >= 0)
@@ -120,7 +127,48 @@ void PrecalcIOLighting(const Vec3f * pos, float radius, long flags) {
 	}
 }
 
-void EERIE_LIGHT_Apply(EERIEPOLY * ep) {
+static bool IsStaticLight(const EERIE_LIGHT * el) {
+	return el && el->treat && el->exist && el->status && !(el->extras & EXTRAS_SEMIDYNAMIC);
+}
+
+static bool IsFireAction(size_t i) {
+	return actions[i].exist && (actions[i].type == ACT_FIRE2 || actions[i].type == ACT_FIRE);
+}
+
+/*!
+ * Collect the static lights and fires that can reach the given rectangle in the XZ plane.
+ * The lights are kept in their GLight / actions order so that the accumulated
+ * colors are identical to checking all lights for each polygon.
+ */
+static void GetStaticLights(vector<EERIE_LIGHT *> & lights,
+                            float minx, float minz, float maxx, float maxz) {
+	
+	lights.clear();
+	
+	for(size_t i = 0; i < MAX_LIGHTS; i++) {
+		EERIE_LIGHT * el = GLight[i];
+		if(IsStaticLight(el)) {
+			float range = el->fallend + 100.f;
+			if(el->pos.x + range >= minx && el->pos.x - range <= maxx
+			   && el->pos.z + range >= minz && el->pos.z - range <= maxz) {
+				lights.push_back(el);
+			}
+		}
+	}
+	
+	for(size_t i = 0; i < MAX_ACTIONS; i++) {
+		if(IsFireAction(i)) {
+			EERIE_LIGHT * el = &actions[i].light;
+			float range = el->fallend + 100.f;
+			if(el->pos.x + range >= minx && el->pos.x - range <= maxx
+			   && el->pos.z + range >= minz && el->pos.z - range <= maxz) {
+				lights.push_back(el);
+			}
+		}
+	}
+}
+
+static void EERIE_LIGHT_Apply(EERIEPOLY * ep, const vector<EERIE_LIGHT *> & lights) {
 	
 	if (ep->type & POLY_IGNORE)  return;
 
@@ -132,26 +180,10 @@ void EERIE_LIGHT_Apply(EERIEPOLY * ep) {
 	epg[3] = epg[2] = epg[1] = epg[0] = 0; 
 	epb[3] = epb[2] = epb[1] = epb[0] = 0; 
 
-	for(size_t i = 0; i < MAX_LIGHTS; i++) {
-		
-		EERIE_LIGHT * el = GLight[i];
-
-		if ((el) && (el->treat) && (el->exist) && (el->status) 
-		        && !(el->extras & EXTRAS_SEMIDYNAMIC))
-		{
-			if(closerThan(el->pos, ep->center, el->fallend + 100.f)) {
-				ARX_EERIE_LIGHT_Make(ep, epr, epg, epb, el);
-			}
-		}
-	}
-
-	for (size_t i = 0; i < MAX_ACTIONS; i++)
-	{
-		if ((actions[i].exist) && ((actions[i].type == ACT_FIRE2) || (actions[i].type == ACT_FIRE)))
-		{
-			if(closerThan(actions[i].light.pos, ep->center, actions[i].light.fallend + 100.f)) {
-				ARX_EERIE_LIGHT_Make(ep, epr, epg, epb, &actions[i].light);
-			}
+	for(size_t i = 0; i < lights.size(); i++) {
+		EERIE_LIGHT * el = lights[i];
+		if(closerThan(el->pos, ep->center, el->fallend + 100.f)) {
+			ARX_EERIE_LIGHT_Make(ep, epr, epg, epb, el);
 		}
 	}
 
@@ -168,6 +200,16 @@ void EERIE_LIGHT_Apply(EERIEPOLY * ep) {
 	}
 }
 
+void EERIE_LIGHT_Apply(EERIEPOLY * ep) {
+	
+	if (ep->type & POLY_IGNORE)  return;
+	
+	vector<EERIE_LIGHT *> lights;
+	GetStaticLights(lights, ep->center.x, ep->center.z, ep->center.x, ep->center.z);
+	
+	EERIE_LIGHT_Apply(ep, lights);
+}
+
 void EERIE_LIGHT_TranslateSelected(const Vec3f * trans) {
 	for(size_t i = 0; i < MAX_LIGHTS; i++) {
 		if(GLight[i] && GLight[i]->selected) {
@@ -677,10 +719,63 @@ void EERIE_LIGHT_ChangeLighting()
 //*************************************************************************************
 //*************************************************************************************
 
+namespace {
+
+//! Computes the static lighting of one row of background tiles
+class PrecalcLightsTask : public WorkerTask {
+	
+	long minx, minz, maxx;
+	
+	//! Candidate lights for each tile of a row, reused between tiles
+	vector<EERIE_LIGHT *> zoneLights;
+	
+public:
+	
+	PrecalcLightsTask(long _minx, long _minz, long _maxx, long _maxz)
+		: minx(_minx), minz(_minz), maxx(_maxx) {
+		GetStaticLights(zoneLights, float(_minx) * ACTIVEBKG->Xdiv, float(_minz) * ACTIVEBKG->Zdiv,
+		                float(_maxx + 1) * ACTIVEBKG->Xdiv, float(_maxz + 1) * ACTIVEBKG->Zdiv);
+	}
+	
+	void process(size_t item) {
+		
+		long j = minz + long(item);
+		
+		vector<EERIE_LIGHT *> lights;
+		lights.reserve(zoneLights.size());
+		
+		for(long i = minx; i <= maxx; i++) {
+			
+			EERIE_BKG_INFO * eg = &ACTIVEBKG->Backg[i + j * ACTIVEBKG->Xsize];
+			if(eg->nbpoly == 0) {
+				continue;
+			}
+			
+			// Only keep the lights that can reach this tile
+			float x0 = float(i) * ACTIVEBKG->Xdiv, x1 = x0 + ACTIVEBKG->Xdiv;
+			float z0 = float(j) * ACTIVEBKG->Zdiv, z1 = z0 + ACTIVEBKG->Zdiv;
+			lights.clear();
+			for(size_t l = 0; l < zoneLights.size(); l++) {
+				EERIE_LIGHT * el = zoneLights[l];
+				float range = el->fallend + 100.f;
+				if(el->pos.x + range >= x0 && el->pos.x - range <= x1
+				   && el->pos.z + range >= z0 && el->pos.z - range <= z1) {
+					lights.push_back(el);
+				}
+			}
+			
+			for(long k = 0; k < eg->nbpoly; k++) {
+				EERIE_LIGHT_Apply(&eg->polydata[k], lights);
+			}
+		}
+	}
+	
+};
+
+} // anonymous namespace
+
 void EERIEPrecalcLights(long minx, long minz, long maxx, long maxz)
 {
-	EERIE_BKG_INFO * eg;
- 
 	if (minx < 0) minx = 0;
 	else if (minx >= ACTIVEBKG->Xsize) minx = ACTIVEBKG->Xsize - 1;
 
@@ -713,23 +808,31 @@ void EERIEPrecalcLights(long minx, long minz, long maxx, long maxz)
 		}
 	}
 	
-	for (long j = minz; j <= maxz; j++)
-	{
-		for (long i = minx; i <= maxx; i++)
-		{
-			eg = &ACTIVEBKG->Backg[i+j*ACTIVEBKG->Xsize];
-
-			for (long k = 0; k < eg->nbpoly; k++)
-			{
-				EERIEPOLY * ep = &eg->polydata[k];
-					
-				if(ep) {
-					ep->type &= ~POLY_IGNORE;
-					EERIE_LIGHT_Apply(ep);
-				}
+	if(maxz < minz || maxx < minx) {
+		return;
+	}
+	
+	// Polygon flags are read by the lighting of neighbouring tiles, so update them first
+	for(long j = minz; j <= maxz; j++) {
+		for(long i = minx; i <= maxx; i++) {
+			EERIE_BKG_INFO * eg = &ACTIVEBKG->Backg[i + j * ACTIVEBKG->Xsize];
+			for(long k = 0; k < eg->nbpoly; k++) {
+				eg->polydata[k].type &= ~POLY_IGNORE;
 			}
 		}
 	}
+	
+#ifdef _DEBUG
+	u64 startTime = Time::getUs();
+#endif
+	
+	// Polygons only write their own vertex colors, so the tile rows can be lit in parallel
+	PrecalcLightsTask task(minx, minz, maxx, maxz);
+	WorkerPool::run(task, size_t(maxz - minz + 1));
+	
+	LogDebug("lit " << (maxx - minx + 1) << "x" << (maxz - minz + 1) << " tiles in "
+	         << (Time::getElapsedUs(startTime) / 1000) << "ms using "
+	         << WorkerPool::getThreadCount() << " threads");
 }
 
 void RecalcLightZone(float x, float z, long siz) {
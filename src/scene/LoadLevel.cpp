@@ -62,6 +62,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #include "core/Core.h"
 
 #include "game/EntityManager.h"
+#include "game/Inventory.h"
 #include "game/Levels.h"
 #include "game/Player.h"
 
@@ -89,6 +90,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #include "scene/GameSound.h"
 #include "scene/Interactive.h"
 #include "scene/LevelFormat.h"
+#include "scene/LevelLoader.h"
 #include "scene/Light.h"
 
 #include "util/String.h"
@@ -646,8 +648,15 @@ long DanaeLoadLevel(const res::path & file, bool loadEntities) {
 	LogDebug("fic2 " << lightingFileName);
 	LogDebug("fileDlf " << file);
 
+	// Use the files read by the level loader thread if available
+	LevelFileData levelData;
 	size_t FileSize = 0;
-	char * dat = resources->readAlloc(file, FileSize);
+	char * dat = NULL;
+	if(ARX_LEVELLOADER_Take(file, levelData)) {
+		dat = levelData.data, FileSize = levelData.size;
+	} else {
+		dat = resources->readAlloc(file, FileSize);
+	}
 	if(!dat) {
 		LogError << "Unable to find " << file;
 		return -1;
@@ -670,13 +679,18 @@ long DanaeLoadLevel(const res::path & file, bool loadEntities) {
 		LogError << "Unexpected level file version: " << dlh.version << " for " << file;
 		free(dat);
 		dat = NULL;
+		free(levelData.unpacked);
 		return -1;
 	}
 	
 	// using compression
 	if(dlh.version >= 1.44f) {
 		char * torelease = dat;
-		dat = blastMemAlloc(dat + pos, FileSize - pos, FileSize);
+		if(levelData.unpacked) {
+			dat = levelData.unpacked, FileSize = levelData.unpackedSize;
+		} else {
+			dat = blastMemAlloc(dat + pos, FileSize - pos, FileSize);
+		}
 		free(torelease);
 		pos = 0;
 		if(!dat) {
@@ -995,15 +1009,30 @@ long DanaeLoadLevel(const res::path & file, bool loadEntities) {
 	pos = 0;
 	dat = NULL;
 	
-	if(lightingFile) {
+	LevelFileData lightingData;
+	if(lightingFile && ARX_LEVELLOADER_Take(lightingFileName, lightingData)) {
+		
+		LogDebug("Loading prepared LLF Info");
+		
+		if(dlh.version >= 1.44f) {
+			free(lightingData.data);
+			dat = lightingData.unpacked, FileSize = lightingData.unpackedSize;
+		} else {
+			free(lightingData.unpacked);
+			dat = lightingData.data, FileSize = lightingData.size;
+		}
+		
+	} else if(lightingFile) {
 		
 		LogDebug("Loading LLF Info");
 		
 		// using compression
 		if(dlh.version >= 1.44f) {
 			char * compressed = lightingFile->readAlloc();
-			dat = (char*)blastMemAlloc(compressed, lightingFile->size(), FileSize);
-			free(compressed);
+			if(compressed) {
+				dat = (char*)blastMemAlloc(compressed, lightingFile->size(), FileSize);
+				free(compressed);
+			}
 		} else {
 			dat = lightingFile->readAlloc();
 			FileSize = lightingFile->size();
@@ -1173,6 +1202,7 @@ void DanaeClearLevel(long flag)
 	UnlinkAllLinkedObjects();
 	
 	entities.clear();
+	ARX_INVENTORY_ClearIndex();
 	
 	DANAE_ReleaseAllDatasDynamic();
 	delete stone0, stone0 = NULL, stone0_count = 0;
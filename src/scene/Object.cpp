@@ -46,11 +46,14 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 
 #include "scene/Object.h"
 
+#include <algorithm>
 #include <cstdio>
 
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 
+#include "animation/Skinning.h"
+
 #include "core/Config.h"
 #include "core/Core.h"
 
@@ -479,6 +482,14 @@ EERIE_ANIM * TheaToEerie(const char * adr, size_t size, const res::path & file)
 		eerie->anim_time = 1;
 	}
 	
+	// Key frame lookups can only binary search where frame times are ordered
+	eerie->nb_ordered_frames = min(eerie->nb_key_frames, 1l);
+	while(eerie->nb_ordered_frames < eerie->nb_key_frames
+	      && long(eerie->frames[eerie->nb_ordered_frames - 1].time)
+	         < long(eerie->frames[eerie->nb_ordered_frames].time)) {
+		eerie->nb_ordered_frames++;
+	}
+	
 	LogDebug("Finished Conversion TEA -> EERIE - " << (eerie->anim_time / 1000) << " seconds");
 	
 	return eerie;
@@ -1227,6 +1238,7 @@ void EERIE_3DOBJ::clear() {
 		fastaccess.padding_ = 0;
 
 		c_data = 0;
+		skin = NULL;
 		
 	cub.xmin = cub.ymin = cub.zmin = std::numeric_limits<float>::max();
 	cub.xmax = cub.ymax = cub.zmax = std::numeric_limits<float>::min();
@@ -1283,6 +1295,7 @@ EERIE_3DOBJ * Eerie_Copy(const EERIE_3DOBJ * obj) {
 	nouvo->cdata = NULL;
 	nouvo->sdata = NULL;
 	nouvo->c_data = NULL;
+	nouvo->skin = NULL;
 	nouvo->vertexlocal = NULL;
 	
 	nouvo->angle = obj->angle;
@@ -1417,10 +1430,18 @@ void EERIE_RemoveCedricData(EERIE_3DOBJ * eobj) {
 	delete[] eobj->c_data->bones, eobj->c_data->bones = NULL;
 	delete eobj->c_data, eobj->c_data = NULL;
 	delete[] eobj->vertexlocal, eobj->vertexlocal = NULL;
+	
+	if(eobj->skin) {
+		eobj->skin->release(), eobj->skin = NULL;
+	}
 }
 
 void EERIE_CreateCedricData(EERIE_3DOBJ * eobj) {
 	
+	if(eobj->skin) {
+		eobj->skin->release(), eobj->skin = NULL;
+	}
+	
 	eobj->c_data = new EERIE_C_DATA();
 	memset(eobj->c_data, 0, sizeof(EERIE_C_DATA));
 
@@ -1563,7 +1584,8 @@ void EERIE_CreateCedricData(EERIE_3DOBJ * eobj) {
 				outVert.x = temp.x, outVert.y = temp.y, outVert.z = temp.z;
 			}
 		}
-	}
+	}	
+	eobj->skin = SkinData::acquire(eobj);
 }
 
 #ifdef BUILD_EDIT_LOADSAVE
@@ -1839,6 +1839,12 @@ void ApplyDynLight_VertexBuffer_2(EERIEPOLY *ep,short x,short y,SMY_VERTEX *_pVe
 
 TILE_LIGHTS tilelights[MAX_BKGX][MAX_BKGZ];
 
+//! Tiles that received lights during the last ComputeTileLights() call
+static vector<TILE_LIGHTS *> tilelights_used;
+
+//! Tile range binned by the last ComputeTileLights() call
+static long tilelights_x0 = 0, tilelights_z0 = 0, tilelights_x1 = -1, tilelights_z1 = -1;
+
 void InitTileLights()
 {
 	for (long j=0;j<MAX_BKGZ;j++)
@@ -1848,36 +1854,92 @@ void InitTileLights()
 		tilelights[i][j].max=0;
 		tilelights[i][j].num=0;
 	}
+	tilelights_used.clear();
+	tilelights_x0 = tilelights_z0 = 0, tilelights_x1 = tilelights_z1 = -1;
 }
 
-void ComputeTileLights(short x,short z)
-{
-	tilelights[x][z].num=0;
-	float xx=((float)x+0.5f)*ACTIVEBKG->Xdiv;
-	float zz=((float)z+0.5f)*ACTIVEBKG->Zdiv;
+static void AddTileLight(TILE_LIGHTS * tl, EERIE_LIGHT * light) {
+	
+	if(tl->num == 0) {
+		tilelights_used.push_back(tl);
+	}
+	
+	if(tl->num >= tl->max) {
+		tl->max = (tl->max == 0) ? 4 : tl->max * 2;
+		tl->el = (EERIE_LIGHT **)realloc(tl->el, sizeof(EERIE_LIGHT *) * tl->max);
+	}
+	
+	tl->el[tl->num++] = light;
+}
 
-	for (long i=0;i<TOTPDL;i++)
-	{
-		if(closerThan(Vec2f(xx, zz), Vec2f(PDL[i]->pos.x, PDL[i]->pos.z), PDL[i]->fallend + 60.f)) {
+/*!
+ * Bin the treated dynamic lights (PDL) into the background tiles they can reach.
+ * This is done once per frame so that polygons only need to look at the lights
+ * of their own tile instead of testing all TOTPDL lights.
+ */
+void ComputeTileLights(long x0, long z0, long x1, long z1) {
+	
+	for(size_t i = 0; i < tilelights_used.size(); i++) {
+		tilelights_used[i]->num = 0;
+	}
+	tilelights_used.clear();
+	
+	tilelights_x0 = x0, tilelights_z0 = z0, tilelights_x1 = x1, tilelights_z1 = z1;
+	
+	for(long i = 0; i < TOTPDL; i++) {
+		
+		EERIE_LIGHT * el = PDL[i];
+		
+		float radius = el->fallend + 60.f;
+		if(radius < 0.f) {
+			continue;
+		}
+		
+		long minx = max(x0, long((el->pos.x - radius) * ACTIVEBKG->Xmul));
+		long maxx = min(x1, long((el->pos.x + radius) * ACTIVEBKG->Xmul));
+		long minz = max(z0, long((el->pos.z - radius) * ACTIVEBKG->Zmul));
+		long maxz = min(z1, long((el->pos.z + radius) * ACTIVEBKG->Zmul));
+		
+		for(long z = minz; z <= maxz; z++) {
 			
-			if (tilelights[x][z].num>=tilelights[x][z].max)
-			{
-				tilelights[x][z].max++;
-				tilelights[x][z].el=(EERIE_LIGHT **)realloc(tilelights[x][z].el,sizeof(EERIE_LIGHT *)*(tilelights[x][z].max));
+			// Distance along z from the light to the tile rectangle
+			float tz0 = float(z) * ACTIVEBKG->Zdiv;
+			float dz = max(0.f, max(tz0 - el->pos.z, el->pos.z - (tz0 + ACTIVEBKG->Zdiv)));
+			
+			for(long x = minx; x <= maxx; x++) {
+				
+				float tx0 = float(x) * ACTIVEBKG->Xdiv;
+				float dx = max(0.f, max(tx0 - el->pos.x, el->pos.x - (tx0 + ACTIVEBKG->Xdiv)));
+				
+				if(dx * dx + dz * dz <= radius * radius) {
+					AddTileLight(&tilelights[x][z], el);
+				}
 			}
-
-			tilelights[x][z].el[tilelights[x][z].num]=PDL[i];
-			tilelights[x][z].num++;
 		}
 	}
 }
 
+TILE_LIGHTS * GetTileLights(const Vec3f & pos) {
+	
+	long x = long(pos.x * ACTIVEBKG->Xmul);
+	long z = long(pos.z * ACTIVEBKG->Zmul);
+	
+	if(x < tilelights_x0 || x > tilelights_x1 || z < tilelights_z0 || z > tilelights_z1
+	   || x < 0 || x >= ACTIVEBKG->Xsize || z < 0 || z >= ACTIVEBKG->Zsize) {
+		return NULL;
+	}
+	
+	return &tilelights[x][z];
+}
+
 void ClearTileLights() {
 	for(long j = 0; j < MAX_BKGZ; j++) for(long i = 0; i < MAX_BKGZ; i++) {
 		tilelights[i][j].max = 0;
 		tilelights[i][j].num = 0;
 		free(tilelights[i][j].el), tilelights[i][j].el = NULL;
 	}
+	tilelights_used.clear();
+	tilelights_x0 = tilelights_z0 = 0, tilelights_x1 = tilelights_z1 = -1;
 }
 
 void ARX_PORTALS_Frustrum_RenderRoomTCullSoft(long room_num,EERIE_FRUSTRUM_DATA * frustrums,long prec,long tim)
@@ -1927,9 +1989,6 @@ void ARX_PORTALS_Frustrum_RenderRoomTCullSoft(long room_num,EERIE_FRUSTRUM_DATA
 					if (!feg2->treat)
 					{
 						feg2->treat=1;
-
-						if (USE_LIGHT_OPTIM) 
-								ComputeTileLights(static_cast<short>(nx), static_cast<short>(nz));
 					}
 				}
 			}
@@ -2864,7 +2923,10 @@ void ARX_SCENE_Render(long flag) {
 	long LAST_FC=FRAME_COUNT;
 	FRAME_COUNT=0;
 
-	if ((FRAME_COUNT<=0) && (ModeLight & MODE_DYNAMICLIGHT)) PrecalcDynamicLighting(x0,z0,x1,z1);
+	if ((FRAME_COUNT<=0) && (ModeLight & MODE_DYNAMICLIGHT)) {
+		PrecalcDynamicLighting(x0,z0,x1,z1);
+		ComputeTileLights(x0, z0, x1, z1);
+	}
 
 	float temp0=radians(ACTIVECAM->angle.b);
 	ACTIVECAM->norm.x=-(float)EEsin(temp0);
@@ -2910,14 +2972,7 @@ void ARX_SCENE_Render(long flag) {
 				feg->treat=0;												
 			}
 		}
-
-		for (long j=0;j<ACTIVEBKG->Zsize;j++)
-		for (i=0; i<ACTIVEBKG->Xsize; i++)
-		{
-			if (tilelights[i][j].num)
-				tilelights[i][j].num=0;
-		}
-			}
+	}
 
 
 if (USE_PORTALS && portals)
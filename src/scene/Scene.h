@@ -50,6 +50,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #include "math/MathFwd.h"
 
 class Entity;
+struct TILE_LIGHTS;
 
 long ARX_PORTALS_GetRoomNumForPosition(Vec3f * pos, long flag = 0);
 
@@ -61,4 +62,16 @@ bool ARX_SCENE_PORTAL_Basic_ClipIO(Entity * io);
 bool VisibleSphere(float x, float y, float z, float radius);
 void ClearTileLights();
 
+/*!
+ * Bin the current dynamic lights into the background tiles in the given range.
+ * Must be called after PrecalcDynamicLighting() for the same range.
+ */
+void ComputeTileLights(long x0, long z0, long x1, long z1);
+
+/*!
+ * Get the dynamic lights that can reach the background tile containing pos.
+ * @return NULL if pos is outside the tiles binned by the last ComputeTileLights() call.
+ */
+TILE_LIGHTS * GetTileLights(const Vec3f & pos);
+
 #endif // ARX_SCENE_SCENE_H
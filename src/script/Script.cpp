@@ -51,8 +51,11 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #include <sstream>
 #include <cstdio>
 #include <algorithm>
+#include <deque>
+#include <vector>
 
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/unordered_map.hpp>
 
 #include "ai/Paths.h"
 
@@ -77,10 +80,13 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #include "io/resource/PakReader.h"
 #include "io/log/Logger.h"
 
+#include "platform/Lock.h"
+
 #include "scene/Scene.h"
 #include "scene/Interactive.h"
 
 #include "script/ScriptEvent.h"
+#include "script/TimerWheel.h"
 
 using std::sprintf;
 using std::min;
@@ -240,6 +246,15 @@ void ARX_SCRIPT_ResetAll(long flags) {
 	}
 }
 
+/*!
+ * Entities that get heartbeat events and idle timers: the ones in the treat zone
+ * and the items carried by the player, which are kept out of the treat zone.
+ */
+static bool isScriptActive(Entity * io) {
+	return (io->gameFlags & GFLAG_ISINTREATZONE)
+	       || (io->show == SHOW_FLAG_IN_INVENTORY && IsInPlayerInventory(io));
+}
+
 void ARX_SCRIPT_AllowInterScriptExec() {
 	
 	static long ppos = 0;
@@ -260,7 +275,7 @@ void ARX_SCRIPT_AllowInterScriptExec() {
 			return;
 		}
 		
-		if(entities[i] == NULL || !(entities[i]->gameFlags & GFLAG_ISINTREATZONE)) {
+		if(entities[i] == NULL || !isScriptActive(entities[i])) {
 			continue;
 		}
 		
@@ -754,7 +769,7 @@ ValueType getSystemVar(const EERIE_SCRIPT * es, Entity * entity, const string &
 			if(boost::starts_with(name, "^speaking")) {
 				if(entity) {
 					for(size_t i = 0; i < MAX_ASPEECH; i++) {
-						if(aspeech[i].exist && entity == aspeech[i].io) {
+						if(aspeech[i].exist && entities.handle(entity) == aspeech[i].io) {
 							*lcontent = 1;
 							return TYPE_LONG;
 						}
@@ -1499,118 +1514,225 @@ void MakeSSEPARAMS(const char * params)
 	}
 }
 
-#define MAX_EVENT_STACK 800
+//! Maximum number of stacked events, further events are dropped
+static const size_t MAX_EVENT_STACK = 800;
+
+//! Parameters up to this length are stored in the event itself
+static const size_t STACKED_EVENT_PARAMS = 64;
+
 struct STACKED_EVENT {
-	Entity * sender;
-	long              exist;
-	Entity * io;
+	EntityHandle      sender;
+	EntityHandle      io;
+	ScriptMessage     msg;
+	size_t            eventname; //!< Interned event name, see getEventName()
+	size_t            paramsLength;
+	char              params[STACKED_EVENT_PARAMS];
+	std::string       longParams; //!< Used if the parameters don't fit in params
+};
+
+//! FIFO ring buffer of stacked events
+static STACKED_EVENT eventstack[MAX_EVENT_STACK];
+static size_t eventStackStart = 0; //!< Index of the oldest event
+static size_t eventStackSize = 0;
+static EventStackStats eventStackStats;
+
+//! Events posted from other threads, moved to the event stack by the main thread
+struct POSTED_EVENT {
+	EntityHandle      io;
 	ScriptMessage     msg;
 	std::string       params;
 	std::string       eventname;
 };
+static Lock postedEventsLock;
+static std::vector<POSTED_EVENT> postedEvents;
 
-STACKED_EVENT eventstack[MAX_EVENT_STACK];
+typedef boost::unordered_map<std::string, size_t> EventNameIndex;
+static std::deque<std::string> eventNames; // references must stay valid when adding names
+static EventNameIndex eventNameIndex;
+
+//! @return an id for the event name, 0 for no name
+static size_t internEventName(const std::string & name) {
+	
+	if(name.empty()) {
+		return 0;
+	}
+	
+	EventNameIndex::const_iterator it = eventNameIndex.find(name);
+	if(it != eventNameIndex.end()) {
+		return it->second;
+	}
+	
+	eventNames.push_back(name);
+	return eventNameIndex[name] = eventNames.size();
+}
+
+static const std::string & getEventName(size_t id) {
+	static const std::string none;
+	return id ? eventNames[id - 1] : none;
+}
+
+static void pushStackedEvent(EntityHandle sender, EntityHandle io, ScriptMessage msg,
+                             const std::string & params, size_t eventname) {
+	
+	if(eventStackSize == MAX_EVENT_STACK) {
+		if(eventStackStats.dropped++ == 0) {
+			LogWarning << "Script event stack full, dropping events";
+		}
+		return;
+	}
+	
+	STACKED_EVENT & event = eventstack[(eventStackStart + eventStackSize) % MAX_EVENT_STACK];
+	eventStackSize++;
+	eventStackStats.maxSize = std::max(eventStackStats.maxSize, eventStackSize);
+	
+	event.sender = sender;
+	event.io = io;
+	event.msg = msg;
+	event.eventname = eventname;
+	event.paramsLength = params.length();
+	if(event.paramsLength <= STACKED_EVENT_PARAMS) {
+		std::copy(params.begin(), params.end(), event.params);
+	} else {
+		event.longParams = params;
+	}
+}
 
 void ARX_SCRIPT_EventStackInit()
 {
-	ARX_SCRIPT_EventStackClear( false ); // Clear everything in the stack
+	ARX_SCRIPT_EventStackClear(); // Clear everything in the stack
+	eventStackStats = EventStackStats();
 }
-void ARX_SCRIPT_EventStackClear( bool check_exist )
+
+void ARX_SCRIPT_EventStackClear()
 {
 	LogDebug("Event Stack Clear");
-	for (long i = 0; i < MAX_EVENT_STACK; i++)
-	{
-		if ( check_exist ) // If we're not blatantly clearing everything
-			if ( !eventstack[i].exist ) // If the Stacked_Event is not being used
-				continue; // Continue on to the next one
-
-			// Otherwise, clear all the fields in this stacked_event
-			eventstack[i].sender = NULL;
-			eventstack[i].exist = 0;
-			eventstack[i].io = NULL;
-			eventstack[i].msg = SM_NULL;
-			eventstack[i].params.clear();
-			eventstack[i].eventname.clear();
+	
+	for(size_t i = 0; i < MAX_EVENT_STACK; i++) {
+		eventstack[i].sender = EntityHandle();
+		eventstack[i].io = EntityHandle();
+		eventstack[i].msg = SM_NULL;
+		eventstack[i].longParams.clear();
 	}
+	
+	eventStackStart = 0;
+	eventStackSize = 0;
+	
+	Autolock lock(postedEventsLock);
+	postedEvents.clear();
 }
 
 long STACK_FLOW = 8;
 
 void ARX_SCRIPT_EventStackClearForIo(Entity * io)
 {
-	for (long i = 0; i < MAX_EVENT_STACK; i++)
-	{
-		if (eventstack[i].exist)
-		{
-			if (eventstack[i].io == io)
-			{
-				eventstack[i].sender = NULL;
-				eventstack[i].exist = 0;
-				eventstack[i].io = NULL;
-				eventstack[i].msg = SM_NULL;
-				eventstack[i].params.clear();
-				eventstack[i].eventname.clear();
-			}
+	EntityHandle handle = entities.handle(io);
+	
+	// Cancelled events are skipped when they reach the front of the stack
+	for(size_t i = 0; i < eventStackSize; i++) {
+		STACKED_EVENT & event = eventstack[(eventStackStart + i) % MAX_EVENT_STACK];
+		if(event.io == handle) {
+			event.io = EntityHandle();
 		}
 	}
 }
 
 void ARX_SCRIPT_EventStackExecute()
 {
-	long count = 0;
-
-	for (long i = 0; i < MAX_EVENT_STACK; i++)
+	// Move events posted by other threads to the stack
+	static std::vector<POSTED_EVENT> posted;
 	{
-		if (eventstack[i].exist)
-		{
-			if (!ValidIOAddress(eventstack[i].io))
-				goto kill;
-
-			if (ValidIOAddress(eventstack[i].sender))
-				EVENT_SENDER = eventstack[i].sender;
-			else
-				EVENT_SENDER = NULL;
-
-			SendIOScriptEvent(eventstack[i].io, eventstack[i].msg, eventstack[i].params, eventstack[i].eventname);
-		kill:
-			;
-
-			eventstack[i].sender = NULL;
-			eventstack[i].exist = 0;
-			eventstack[i].io = NULL;
-			eventstack[i].msg = SM_NULL;
-			eventstack[i].params.clear();
-			eventstack[i].eventname.clear();
-			count++;
-
-			if (count >= STACK_FLOW) return;
+		Autolock lock(postedEventsLock);
+		posted.swap(postedEvents);
+	}
+	for(size_t i = 0; i < posted.size(); i++) {
+		pushStackedEvent(EntityHandle(), posted[i].io, posted[i].msg, posted[i].params,
+		                 internEventName(posted[i].eventname));
+		eventStackStats.posted++;
+	}
+	posted.clear();
+	
+	// Only run events that were queued before, events stacked by the scripts we run wait
+	// for the next call
+	size_t count = std::min(eventStackSize, size_t(std::max(STACK_FLOW, 0l)));
+	
+	std::string params;
+	
+	while(count > 0 && eventStackSize > 0) {
+		
+		STACKED_EVENT & event = eventstack[eventStackStart];
+		eventStackStart = (eventStackStart + 1) % MAX_EVENT_STACK;
+		eventStackSize--;
+		
+		if(event.io.isNull()) {
+			// Cancelled by ARX_SCRIPT_EventStackClearForIo
+			continue;
+		}
+		
+		count--;
+		
+		Entity * io = entities.get(event.io);
+		if(!io) {
+			continue;
 		}
+		
+		// Copy everything out of the slot as the scripts may stack new events
+		if(event.paramsLength <= STACKED_EVENT_PARAMS) {
+			params.assign(event.params, event.paramsLength);
+		} else {
+			params.swap(event.longParams);
+			event.longParams.clear();
+		}
+		ScriptMessage msg = event.msg;
+		const std::string & eventname = getEventName(event.eventname);
+		
+		EVENT_SENDER = entities.get(event.sender);
+		
+		SendIOScriptEvent(io, msg, params, eventname);
 	}
 }
 
 void ARX_SCRIPT_EventStackExecuteAll()
 {
 	STACK_FLOW = 9999999;
-	ARX_SCRIPT_EventStackExecute();
+	
+	// Also run the events stacked by the scripts we run, but give up on scripts
+	// that keep sending events to each other
+	const size_t maxPasses = 100;
+	size_t passes = 0;
+	do {
+		ARX_SCRIPT_EventStackExecute();
+	} while(eventStackSize > 0 && ++passes < maxPasses);
+	
+	if(eventStackSize > 0) {
+		LogWarning << "Script events are still being stacked after " << maxPasses << " passes";
+	}
+	
 	STACK_FLOW = 20;
 }
 
 void Stack_SendIOScriptEvent(Entity * io, ScriptMessage msg, const std::string& params, const std::string& eventname)
 {
-	for (long i = 0; i < MAX_EVENT_STACK; i++)
-	{
-		if (!eventstack[i].exist)
-		{
-			eventstack[i].sender = EVENT_SENDER;
-			eventstack[i].io = io;
-			eventstack[i].msg = msg;
-			eventstack[i].exist = 1;
-			eventstack[i].params = params;
-			eventstack[i].eventname = eventname;
+	pushStackedEvent(entities.handle(EVENT_SENDER), entities.handle(io), msg, params,
+	                 internEventName(eventname));
+}
 
-			return;
-		}
-	}
+void ARX_SCRIPT_EventStackPost(EntityHandle io, ScriptMessage msg, const std::string & params,
+                               const std::string & eventname) {
+	
+	POSTED_EVENT event;
+	event.io = io;
+	event.msg = msg;
+	event.params = params;
+	event.eventname = eventname;
+	
+	Autolock lock(postedEventsLock);
+	postedEvents.push_back(event);
+}
+
+EventStackStats ARX_SCRIPT_EventStackGetStats() {
+	EventStackStats stats = eventStackStats;
+	stats.size = eventStackSize;
+	return stats;
 }
 
 ScriptResult SendIOScriptEventReverse(Entity * io, ScriptMessage msg, const std::string& params, const std::string& eventname)
@@ -1650,14 +1772,15 @@ ScriptResult SendIOScriptEvent(Entity * io, ScriptMessage msg, const std::string
 	
 	long num = io->index();
 	
-	Entity * oes = EVENT_SENDER;
+	// The sender may be destroyed by the scripts
+	EntityHandle oes = entities.handle(EVENT_SENDER);
 
 	if ((msg == SM_INIT) || (msg == SM_INITEND))
 	{
 		if (entities[num])
 		{
 			SendIOScriptEventReverse(entities[num], msg, params, eventname);
-			EVENT_SENDER = oes;
+			EVENT_SENDER = entities.get(oes);
 		}
 	}
 
@@ -1665,19 +1788,19 @@ ScriptResult SendIOScriptEvent(Entity * io, ScriptMessage msg, const std::string
 	if (entities[num] && !entities[num]->over_script.data)
 	{
 		ScriptResult ret = ScriptEvent::send(&entities[num]->script, msg, params, entities[num], eventname);
-		EVENT_SENDER = oes;
+		EVENT_SENDER = entities.get(oes);
 		return ret;
 	}
 
 	// If this IO has a Global script send to Local (if exists)
 	// then to Global if no overriden by Local
 	if (entities[num] && ScriptEvent::send(&entities[num]->over_script, msg, params, entities[num], eventname) != REFUSE) {
-		EVENT_SENDER = oes;
+		EVENT_SENDER = entities.get(oes);
 
 		if (entities[num])
 		{
 			ScriptResult ret = ScriptEvent::send(&entities[num]->script, msg, params, entities[num], eventname);
-			EVENT_SENDER = oes;
+			EVENT_SENDER = entities.get(oes);
 			return ret;
 		}
 		else
@@ -1692,7 +1815,8 @@ ScriptResult SendInitScriptEvent(Entity * io) {
 	
 	if (!io) return REFUSE;
 
-	Entity * oes = EVENT_SENDER;
+	// The sender may be destroyed by the scripts
+	EntityHandle oes = entities.handle(EVENT_SENDER);
 	EVENT_SENDER = NULL;
 	long num = io->index();
 
@@ -1716,22 +1840,72 @@ ScriptResult SendInitScriptEvent(Entity * io) {
 		ScriptEvent::send(&entities[num]->over_script, SM_INITEND, "", entities[num], "");
 	}
 
-	EVENT_SENDER = oes;
+	EVENT_SENDER = entities.get(oes);
 	return ACCEPT;
 }
 
-//! Checks if timer named texx exists.
-static bool ARX_SCRIPT_Timer_Exist(const std::string & texx) {
+//! Scheduler for the active script timers, ids are indices into scr_timer
+static TimerWheel timerWheel;
+
+//! Number of active timers for each timer name
+typedef boost::unordered_map<std::string, long> TimerNameCounts;
+static TimerNameCounts timerNames;
+
+/*!
+ * Active timers for each entity, as doubly-linked lists through scr_timer indices.
+ * Lists are indexed by getTimerListIndex(), -1 marks the end of a list.
+ */
+static std::vector<long> ioTimers;
+static std::vector<long> nextIOTimer;
+static std::vector<long> prevIOTimer;
+
+static long minFreeTimer = 0; // no unused timers below this index
+
+static size_t getTimerListIndex(EntityHandle handle) {
+	return handle.isNull() ? 0 : handle.index() + 1;
+}
+
+static long getFirstTimerForIO(EntityHandle handle) {
+	size_t list = getTimerListIndex(handle);
+	return (list < ioTimers.size()) ? ioTimers[list] : -1;
+}
+
+static void linkIOTimer(long num) {
 	
-	for(long i = 0; i < MAX_TIMER_SCRIPT; i++) {
-		if(scr_timer[i].exist) {
-			if(scr_timer[i].name == texx) {
-				return true;
-			}
-		}
+	size_t list = getTimerListIndex(scr_timer[num].io);
+	if(list >= ioTimers.size()) {
+		ioTimers.resize(list + 1, -1);
+	}
+	
+	prevIOTimer[num] = -1;
+	nextIOTimer[num] = ioTimers[list];
+	if(nextIOTimer[num] != -1) {
+		prevIOTimer[nextIOTimer[num]] = num;
 	}
+	ioTimers[list] = num;
+}
+
+static void unlinkIOTimer(long num) {
 	
-	return false;
+	if(prevIOTimer[num] != -1) {
+		nextIOTimer[prevIOTimer[num]] = nextIOTimer[num];
+	} else {
+		ioTimers[getTimerListIndex(scr_timer[num].io)] = nextIOTimer[num];
+	}
+	if(nextIOTimer[num] != -1) {
+		prevIOTimer[nextIOTimer[num]] = prevIOTimer[num];
+	}
+	
+	prevIOTimer[num] = nextIOTimer[num] = -1;
+}
+
+static void scheduleTimer(long num) {
+	timerWheel.insert(num, scr_timer[num].tim + scr_timer[num].msecs);
+}
+
+//! Checks if timer named texx exists.
+static bool ARX_SCRIPT_Timer_Exist(const std::string & texx) {
+	return timerNames.find(texx) != timerNames.end();
 }
 
 string ARX_SCRIPT_Timer_GetDefaultName() {
@@ -1752,14 +1926,36 @@ string ARX_SCRIPT_Timer_GetDefaultName() {
 //*************************************************************************************
 long ARX_SCRIPT_Timer_GetFree() {
 	
-	for(long i = 0; i < MAX_TIMER_SCRIPT; i++) {
-		if(!(scr_timer[i].exist))
+	for(long i = minFreeTimer; i < MAX_TIMER_SCRIPT; i++) {
+		if(!(scr_timer[i].exist)) {
+			minFreeTimer = i;
 			return i;
+		}
 	}
 	
+	minFreeTimer = MAX_TIMER_SCRIPT;
 	return -1;
 }
 
+void ARX_SCRIPT_Timer_Start(long num) {
+	
+	SCR_TIMER & timer = scr_timer[num];
+	arx_assert(!timer.exist);
+	
+	timer.exist = 1;
+	ActiveTimers++;
+	
+	linkIOTimer(num);
+	timerNames[timer.name]++;
+	scheduleTimer(num);
+}
+
+void ARX_SCRIPT_Timer_Update(long num) {
+	if(scr_timer[num].exist) {
+		scheduleTimer(num);
+	}
+}
+
 //*************************************************************************************
 // Count the number of active script timers...
 //*************************************************************************************
@@ -1773,40 +1969,66 @@ long ARX_SCRIPT_CountTimers() {
 //*************************************************************************************
 void ARX_SCRIPT_Timer_ClearByNum(long timer_idx) {
 	if(scr_timer[timer_idx].exist) {
+		
+		timerWheel.remove(timer_idx);
+		unlinkIOTimer(timer_idx);
+		
+		TimerNameCounts::iterator it = timerNames.find(scr_timer[timer_idx].name);
+		arx_assert(it != timerNames.end());
+		if(--it->second == 0) {
+			timerNames.erase(it);
+		}
+		
 		scr_timer[timer_idx].name.clear();
 		ActiveTimers--;
 		scr_timer[timer_idx].exist = 0;
+		
+		if(timer_idx < minFreeTimer) {
+			minFreeTimer = timer_idx;
+		}
 	}
 }
 
 void ARX_SCRIPT_Timer_Clear_By_Name_And_IO(const string & timername, Entity * io) {
-	for(long i = 0; i < MAX_TIMER_SCRIPT; i++) {
-		if(scr_timer[i].exist && scr_timer[i].io == io && scr_timer[i].name == timername) {
+	EntityHandle handle = entities.handle(io);
+	for(long i = getFirstTimerForIO(handle); i != -1; ) {
+		long next = nextIOTimer[i];
+		if(scr_timer[i].io == handle && scr_timer[i].name == timername) {
 			ARX_SCRIPT_Timer_ClearByNum(i);
 		}
+		i = next;
 	}
 }
 
 void ARX_SCRIPT_Timer_Clear_All_Locals_For_IO(Entity * io)
 {
-	for (long i = 0; i < MAX_TIMER_SCRIPT; i++)
+	EntityHandle handle = entities.handle(io);
+	for (long i = getFirstTimerForIO(handle); i != -1; )
 	{
-		if (scr_timer[i].exist)
-		{
-			if ((scr_timer[i].io == io) && (scr_timer[i].es == &io->over_script))
-				ARX_SCRIPT_Timer_ClearByNum(i);
-		}
+		long next = nextIOTimer[i];
+		if ((scr_timer[i].io == handle) && (scr_timer[i].es == &io->over_script))
+			ARX_SCRIPT_Timer_ClearByNum(i);
+		i = next;
 	}
 }
 
 void ARX_SCRIPT_Timer_Clear_By_IO(Entity * io)
 {
-	for (long i = 0; i < MAX_TIMER_SCRIPT; i++)
+	EntityHandle handle = entities.handle(io);
+	for (long i = getFirstTimerForIO(handle); i != -1; )
 	{
-		if (scr_timer[i].exist)
-		{
-			if (scr_timer[i].io == io)
-				ARX_SCRIPT_Timer_ClearByNum(i);
+		long next = nextIOTimer[i];
+		if (scr_timer[i].io == handle)
+			ARX_SCRIPT_Timer_ClearByNum(i);
+		i = next;
+	}
+}
+
+void ARX_SCRIPT_Timer_GetForIO(const Entity * io, std::vector<long> & timers) {
+	EntityHandle handle = entities.handle(io);
+	for(long i = getFirstTimerForIO(handle); i != -1; i = nextIOTimer[i]) {
+		if(scr_timer[i].io == handle) {
+			timers.push_back(i);
 		}
 	}
 }
@@ -1824,6 +2046,13 @@ void ARX_SCRIPT_Timer_FirstInit(long number)
 	delete[] scr_timer;
 	scr_timer = new SCR_TIMER[MAX_TIMER_SCRIPT];
 	ActiveTimers = 0;
+	
+	timerWheel.reset(MAX_TIMER_SCRIPT, static_cast<unsigned long>(arxtime));
+	timerNames.clear();
+	ioTimers.clear();
+	nextIOTimer.assign(MAX_TIMER_SCRIPT, -1);
+	prevIOTimer.assign(MAX_TIMER_SCRIPT, -1);
+	minFreeTimer = 0;
 }
 
 void ARX_SCRIPT_Timer_ClearAll()
@@ -1837,20 +2066,15 @@ void ARX_SCRIPT_Timer_ClearAll()
 
 void ARX_SCRIPT_Timer_Clear_For_IO(Entity * io)
 {
-	for (long i = 0; i < MAX_TIMER_SCRIPT; i++)
-	{
-		if (scr_timer[i].exist)
-		{
-			if (scr_timer[i].io == io) ARX_SCRIPT_Timer_ClearByNum(i);
-		}
-	}
+	ARX_SCRIPT_Timer_Clear_By_IO(io);
 }
 
 long ARX_SCRIPT_GetSystemIOScript(Entity * io, const std::string & name) {
 	
 	if(ActiveTimers) {
-		for(long i = 0; i < MAX_TIMER_SCRIPT; i++) {
-			if(scr_timer[i].exist && scr_timer[i].io == io && scr_timer[i].name == name) {
+		EntityHandle handle = entities.handle(io);
+		for(long i = getFirstTimerForIO(handle); i != -1; i = nextIOTimer[i]) {
+			if(scr_timer[i].io == handle && scr_timer[i].name == name) {
 				return i;
 			}
 		}
@@ -1861,7 +2085,11 @@ long ARX_SCRIPT_GetSystemIOScript(Entity * io, const std::string & name) {
 
 long Manage_Specific_RAT_Timer(SCR_TIMER * st)
 {
-	Entity * io = st->io;
+	Entity * io = entities.get(st->io);
+	if(!io) {
+		return 0;
+	}
+	
 	GetTargetPos(io);
 	Vec3f target = io->target - io->pos;
 	fnormalize(target);
@@ -1910,35 +2138,49 @@ void ARX_SCRIPT_Timer_Check() {
 		return;
 	}
 	
-	for(long i = 0; i < MAX_TIMER_SCRIPT; i++) {
+	unsigned long now = static_cast<unsigned long>(arxtime);
+	
+	if(now + 1 < timerWheel.getTime()) {
+		// Game time has been reset - reschedule all timers relative to the new time
+		timerWheel.reset(MAX_TIMER_SCRIPT, now - 1);
+		for(long i = 0; i < MAX_TIMER_SCRIPT; i++) {
+			if(scr_timer[i].exist) {
+				scheduleTimer(i);
+			}
+		}
+	}
+	
+	static std::vector<size_t> due;
+	due.clear();
+	timerWheel.expire(now, due);
+	
+	for(size_t j = 0; j < due.size(); j++) {
 		
+		long i = long(due[j]);
 		SCR_TIMER * st = &scr_timer[i];
-		if(!st->exist) {
+		if(!st->exist || timerWheel.contains(i)) {
+			// Cleared or restarted by one of the timers that fired before
 			continue;
 		}
 		
-		unsigned long now = static_cast<unsigned long>(arxtime);
-		unsigned long fire_time = st->tim + st->msecs;
-		if(fire_time > now) {
-			// Timer not ready to fire yet
-			continue;
-		}
+		Entity * io = entities.get(st->io);
 		
 		// Skip heartbeat timer events for far away objects
-		if((st->flags & 1) && !(st->io->gameFlags & GFLAG_ISINTREATZONE)) {
+		if((st->flags & 1) && io && !isScriptActive(io)) {
 			long increment = (now - st->tim) / st->msecs;
 			st->tim += st->msecs * increment;
 			arx_assert_msg(st->tim <= now && st->tim + st->msecs > now,
 			               "start=%lu wait=%ld now=%lu", st->tim, st->msecs, now);
+			scheduleTimer(i);
 			continue;
 		}
 		
 		EERIE_SCRIPT * es = st->es;
-		Entity * io = st->io;
 		long pos = st->pos;
 		
 		if(!es && st->name == "_r_a_t_") {
 			if(Manage_Specific_RAT_Timer(st)) {
+				scheduleTimer(i);
 				continue;
 			}
 		}
@@ -1950,9 +2192,10 @@ void ARX_SCRIPT_Timer_Check() {
 				st->times--;
 			}
 			st->tim += st->msecs;
+			scheduleTimer(i);
 		}
 		
-		if(es && ValidIOAddress(io)) {
+		if(es && io) {
 			ScriptEvent::send(es, SM_EXECUTELINE, "", io, "", pos);
 		}
 		
@@ -2148,7 +2391,7 @@ void loadScript(EERIE_SCRIPT & script, PakFile * file) {
 	free(script.data);
 	
 	script.data = file->readAlloc();
-	script.size = file->size();
+	script.size = script.data ? file->size() : 0;
 	
 	std::transform(script.data, script.data + script.size, script.data, ::tolower);
 	
@@ -49,7 +49,9 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 
 #include <stddef.h>
 #include <string>
+#include <vector>
 
+#include "game/EntityManager.h"
 #include "platform/Flags.h"
 
 class PakFile;
@@ -127,11 +129,11 @@ struct SCR_TIMER {
 	long pos;
 	long longinfo;
 	unsigned long tim;
-	Entity * io;
+	EntityHandle io;
 	EERIE_SCRIPT * es;
 	
 	inline SCR_TIMER() : name(), exist(0), flags(0), times(0),
-	                     msecs(0), pos(0), longinfo(0), tim(0), io(NULL), es(NULL) { }
+	                     msecs(0), pos(0), longinfo(0), tim(0), io(), es(NULL) { }
 	
 	inline void reset() {
 		name.clear();
@@ -142,7 +144,7 @@ struct SCR_TIMER {
 		pos = 0;
 		longinfo = 0;
 		tim = 0;
-		io = NULL;
+		io = EntityHandle();
 		es = NULL;
 	}
 	
@@ -419,12 +421,24 @@ void ARX_SCRIPT_Timer_ClearAll();
 void ARX_SCRIPT_Timer_Clear_For_IO(Entity * io);
 void ARX_SCRIPT_Timer_Clear_By_IO(Entity * io);
 long ARX_SCRIPT_Timer_GetFree();
+
+/*!
+ * Activate a timer slot returned by ARX_SCRIPT_Timer_GetFree() after all fields have been set.
+ * The timer fires at tim + msecs.
+ */
+void ARX_SCRIPT_Timer_Start(long num);
+
+//! Reschedule an active timer after changing its tim or msecs fields
+void ARX_SCRIPT_Timer_Update(long num);
+
+//! Get the indices of all active timers for an entity
+void ARX_SCRIPT_Timer_GetForIO(const Entity * io, std::vector<long> & timers);
  
 void ARX_SCRIPT_SetMainEvent(Entity * io, const std::string & newevent);
 void ARX_SCRIPT_EventStackExecute();
 void ARX_SCRIPT_EventStackExecuteAll();
 void ARX_SCRIPT_EventStackInit();
-void ARX_SCRIPT_EventStackClear(bool check_exist = true);
+void ARX_SCRIPT_EventStackClear();
 void ARX_SCRIPT_ResetObject(Entity * io, long flags);
 void ARX_SCRIPT_Reset(Entity * io, long flags);
 long ARX_SCRIPT_GetSystemIOScript(Entity * io, const std::string & name);
@@ -434,6 +448,26 @@ long ARX_SCRIPT_CountTimers();
 void ARX_SCRIPT_Timer_ClearByNum(long num);
 void ARX_SCRIPT_ResetAll(long flags);
 void ARX_SCRIPT_EventStackClearForIo(Entity * io);
+
+struct EventStackStats {
+	size_t size; //!< Number of events currently on the stack
+	size_t maxSize; //!< Highest number of events on the stack
+	size_t dropped; //!< Number of events dropped because the stack was full
+	size_t posted; //!< Number of events posted from other threads
+	EventStackStats() : size(0), maxSize(0), dropped(0), posted(0) { }
+};
+
+EventStackStats ARX_SCRIPT_EventStackGetStats();
+
+/*!
+ * Stack a script event from any thread.
+ *
+ * The event is added to the event stack by the next ARX_SCRIPT_EventStackExecute()
+ * call on the main thread, with no sender.
+ */
+void ARX_SCRIPT_EventStackPost(EntityHandle io, ScriptMessage msg,
+                               const std::string & params = "",
+                               const std::string & eventname = "");
 Entity * ARX_SCRIPT_Get_IO_Max_Events();
 Entity * ARX_SCRIPT_Get_IO_Max_Events_Sent();
 
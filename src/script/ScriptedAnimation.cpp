@@ -275,10 +275,8 @@ public:
 			size_t pos = context.skipCommand();
 			if(pos != (size_t)-1) {
 				scr_timer[num2].reset();
-				ActiveTimers++;
 				scr_timer[num2].es = context.getScript();
-				scr_timer[num2].exist = 1;
-				scr_timer[num2].io = context.getEntity();
+				scr_timer[num2].io = entities.handle(context.getEntity());
 				scr_timer[num2].msecs = 1000.f;
 				// Don't assume that we successfully set the animation - use the current animation
 				if(layer.cur_anim) {
@@ -292,6 +290,7 @@ public:
 				scr_timer[num2].tim = (unsigned long)(arxtime);
 				scr_timer[num2].times = 1;
 				scr_timer[num2].longinfo = 0;
+				ARX_SCRIPT_Timer_Start(num2);
 			}
 		}
 		
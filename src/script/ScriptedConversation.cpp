@@ -424,7 +424,7 @@ public:
 		if(onspeechend != (size_t)-1) {
 			aspeech[speechnum].scrpos = onspeechend;
 			aspeech[speechnum].es = context.getScript();
-			aspeech[speechnum].ioscript = io;
+			aspeech[speechnum].ioscript = entities.handle(io);
 			if(unbreakable) {
 				aspeech[speechnum].flags |= ARX_SPEECH_FLAG_UNBREAKABLE;
 			}
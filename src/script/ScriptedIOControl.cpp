@@ -48,6 +48,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #include "game/Equipment.h"
 #include "game/Inventory.h"
 #include "game/Item.h"
+#include "game/Levels.h"
 #include "game/Missile.h"
 #include "game/NPC.h"
 #include "game/Player.h"
@@ -57,6 +58,7 @@ ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
 #include "io/resource/ResourcePath.h"
 #include "physics/Collisions.h"
 #include "scene/Interactive.h"
+#include "scene/LevelLoader.h"
 #include "script/ScriptUtils.h"
 
 using std::string;
@@ -208,19 +210,19 @@ public:
 			for(size_t k = 0; k < entities.size(); k++) {
 				Entity * ioo = entities[k];
 				if(ioo && IsCollidingIO(io, ioo)) {
-					Entity * oes = EVENT_SENDER;
+					EntityHandle oes = entities.handle(EVENT_SENDER);
 					EVENT_SENDER = ioo;
 					Stack_SendIOScriptEvent(io, SM_COLLISION_ERROR_DETAIL);
-					EVENT_SENDER = oes;
+					EVENT_SENDER = entities.get(oes);
 					colliding = true;
 				}
 			}
 			
 			if(colliding) {
-				Entity * oes = EVENT_SENDER;
+				EntityHandle oes = entities.handle(EVENT_SENDER);
 				EVENT_SENDER = NULL;
 				Stack_SendIOScriptEvent(io, SM_COLLISION_ERROR);
-				EVENT_SENDER = oes;
+				EVENT_SENDER = entities.get(oes);
 			}
 		}
 		
@@ -346,7 +348,7 @@ public:
 			io->_itemdata->count--;
 		} else {
 			io->show = SHOW_FLAG_KILLED;
-			io->gameFlags &= ~GFLAG_ISINTREATZONE;
+			TREATZONE_RemoveIO(io);
 			RemoveFromAllInventories(io);
 			ARX_DAMAGES_ForceDeath(io, EVENT_SENDER);
 		}
@@ -581,6 +583,12 @@ public:
 				
 				CHANGE_LEVEL_ICON =  confirm ? 1 : 200;
 				
+				// Start reading the new level while the player decides to use the exit
+				long num = GetLevelNumByName("level" + level);
+				if(num != CURRENTLEVEL) {
+					ARX_LEVELLOADER_Start(num);
+				}
+				
 				DebugScript(' ' << options << ' ' << angle << ' ' << level << ' ' << target);
 				
 				return Success;
@@ -472,16 +472,16 @@ public:
 		}
 		
 		if(unequip) {
-			Entity * oes = EVENT_SENDER;
+			EntityHandle oes = entities.handle(EVENT_SENDER);
 			EVENT_SENDER = entities[t];
 			Stack_SendIOScriptEvent(context.getEntity(), SM_EQUIPOUT);
-			EVENT_SENDER = oes;
+			EVENT_SENDER = entities.get(oes);
 			ARX_EQUIPMENT_UnEquip(entities[t], context.getEntity());
 		} else {
-			Entity * oes = EVENT_SENDER;
+			EntityHandle oes = entities.handle(EVENT_SENDER);
 			EVENT_SENDER = entities[t];
 			Stack_SendIOScriptEvent(context.getEntity(), SM_EQUIPIN);
-			EVENT_SENDER = oes;
+			EVENT_SENDER = entities.get(oes);
 			ARX_EQUIPMENT_Equip(entities[t], context.getEntity());
 		}
 		
@@ -371,7 +371,7 @@ public:
 			io->_itemdata->count--;
 		} else {
 			io->show = SHOW_FLAG_KILLED;
-			io->gameFlags &= ~GFLAG_ISINTREATZONE;
+			TREATZONE_RemoveIO(io);
 			RemoveFromAllInventories(io);
 			ARX_DAMAGES_ForceDeath(io, EVENT_SENDER);
 		}
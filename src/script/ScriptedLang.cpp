@@ -304,7 +304,7 @@ public:
 			DebugScript(' ' << event << (params.empty() ? "" : " \"" + params + '"') << " to " << target);
 		}
 		
-		Entity * oes = EVENT_SENDER;
+		EntityHandle oes = entities.handle(EVENT_SENDER);
 		EVENT_SENDER = context.getEntity();
 		
 		Entity * io = context.getEntity();
@@ -342,7 +342,7 @@ public:
 			ARX_PATH * ap = ARX_PATH_GetAddressByName(zonename);
 			if(!ap) {
 				ScriptWarning << "unknown zone: " << zonename;
-				EVENT_SENDER = oes;
+				EVENT_SENDER = entities.get(oes);
 				return Failed;
 			}
 			
@@ -390,7 +390,7 @@ public:
 			
 			Entity * t = entities.getById(target, io);
 			if(!t) {
-				EVENT_SENDER = oes;
+				EVENT_SENDER = entities.get(oes);
 				return Failed;
 			}
 			
@@ -398,7 +398,7 @@ public:
 			Stack_SendIOScriptEvent(t, SM_NULL, params, event);
 		}
 		
-		EVENT_SENDER = oes;
+		EVENT_SENDER = entities.get(oes);
 		
 		return Success;
 	}
@@ -881,10 +881,8 @@ void timerCommand(const string & timer, Context & context) {
 		return;
 	}
 	
-	ActiveTimers++;
 	scr_timer[num].es = context.getScript();
-	scr_timer[num].exist = 1;
-	scr_timer[num].io = io;
+	scr_timer[num].io = entities.handle(io);
 	scr_timer[num].msecs = millisecons;
 	scr_timer[num].name = timername;
 	scr_timer[num].pos = pos;
@@ -893,6 +891,7 @@ void timerCommand(const string & timer, Context & context) {
 	
 	scr_timer[num].flags = (idle && io) ? 1 : 0;
 	
+	ARX_SCRIPT_Timer_Start(num);
 }
 
 void setupScriptedLang() {
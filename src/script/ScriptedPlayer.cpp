@@ -311,7 +311,7 @@ public:
 	
 	Result execute(Context & context) {
 		
-		Entity * oes = EVENT_SENDER;
+		EntityHandle oes = entities.handle(EVENT_SENDER);
 		EVENT_SENDER = context.getEntity();
 		
 		bool enable = context.getBool();
@@ -333,7 +333,7 @@ public:
 			player.Interface &= ~INTER_COMBATMODE;
 		}
 		
-		EVENT_SENDER = oes;
+		EVENT_SENDER = entities.get(oes);
 		
 		return Success;
 	}
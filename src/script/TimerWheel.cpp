@@ -0,0 +1,204 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "script/TimerWheel.h"
+
+#include <algorithm>
+
+#include "platform/Platform.h"
+
+const size_t TimerWheel::None;
+
+TimerWheel::TimerWheel() : count(0), current(0) {
+	std::fill(heads, heads + Buckets, None);
+	std::fill(counts, counts + Levels + 2, 0);
+}
+
+void TimerWheel::reset(size_t capacity, Time now) {
+	
+	Node node;
+	node.prev = node.next = node.bucket = None;
+	node.time = 0;
+	nodes.assign(capacity, node);
+	
+	std::fill(heads, heads + Buckets, None);
+	std::fill(counts, counts + Levels + 2, 0);
+	count = 0;
+	
+	current = now + 1;
+}
+
+size_t TimerWheel::getBucket(Time time) const {
+	
+	if(time < current) {
+		return DueBucket;
+	}
+	
+	Time delta = time - current;
+	if(delta < Time(FirstSize)) {
+		return size_t(time & (FirstSize - 1));
+	}
+	
+	size_t shift = FirstBits;
+	for(size_t level = 1; level < Levels; level++, shift += LevelBits) {
+		if(delta < (Time(1) << (shift + LevelBits))) {
+			size_t index = size_t(time >> shift) & (LevelSize - 1);
+			return FirstSize + (level - 1) * LevelSize + index;
+		}
+	}
+	
+	return OverflowBucket;
+}
+
+size_t TimerWheel::getLevel(size_t bucket) {
+	if(bucket < FirstSize) {
+		return 0;
+	} else if(bucket < OverflowBucket) {
+		return 1 + (bucket - FirstSize) / LevelSize;
+	} else {
+		return Levels + (bucket - OverflowBucket);
+	}
+}
+
+void TimerWheel::link(size_t id, size_t bucket) {
+	
+	Node & node = nodes[id];
+	node.bucket = bucket;
+	node.prev = None;
+	node.next = heads[bucket];
+	if(node.next != None) {
+		nodes[node.next].prev = id;
+	}
+	heads[bucket] = id;
+	
+	counts[getLevel(bucket)]++;
+	count++;
+}
+
+void TimerWheel::unlink(size_t id) {
+	
+	Node & node = nodes[id];
+	if(node.prev != None) {
+		nodes[node.prev].next = node.next;
+	} else {
+		heads[node.bucket] = node.next;
+	}
+	if(node.next != None) {
+		nodes[node.next].prev = node.prev;
+	}
+	
+	counts[getLevel(node.bucket)]--;
+	count--;
+	
+	node.bucket = None;
+}
+
+void TimerWheel::insert(size_t id, Time time) {
+	
+	arx_assert(id < nodes.size());
+	
+	if(contains(id)) {
+		unlink(id);
+	}
+	
+	nodes[id].time = time;
+	link(id, getBucket(time));
+}
+
+void TimerWheel::remove(size_t id) {
+	if(contains(id)) {
+		unlink(id);
+	}
+}
+
+void TimerWheel::cascade() {
+	
+	size_t shift = FirstBits;
+	for(size_t level = 1; level <= Levels; level++, shift += LevelBits) {
+		
+		size_t index = 0;
+		size_t bucket = OverflowBucket;
+		if(level < Levels) {
+			index = size_t(current >> shift) & (LevelSize - 1);
+			bucket = FirstSize + (level - 1) * LevelSize + index;
+		}
+		
+		// Detach the bucket first as timers may be re-added to the same bucket
+		size_t id = heads[bucket];
+		heads[bucket] = None;
+		while(id != None) {
+			size_t next = nodes[id].next;
+			counts[level]--, count--;
+			link(id, getBucket(nodes[id].time));
+			id = next;
+		}
+		
+		if(index != 0) {
+			// Higher levels only need to be redistributed when this level wraps around
+			break;
+		}
+	}
+}
+
+void TimerWheel::take(size_t bucket, std::vector<size_t> & due) {
+	
+	size_t level = getLevel(bucket);
+	
+	size_t id = heads[bucket];
+	heads[bucket] = None;
+	while(id != None) {
+		due.push_back(id);
+		size_t next = nodes[id].next;
+		nodes[id].bucket = None;
+		counts[level]--, count--;
+		id = next;
+	}
+}
+
+void TimerWheel::expire(Time now, std::vector<size_t> & due) {
+	
+	take(DueBucket, due);
+	
+	while(current <= now) {
+		
+		if((current & (FirstSize - 1)) == 0) {
+			cascade();
+		}
+		
+		take(size_t(current & (FirstSize - 1)), due);
+		current++;
+		
+		if(counts[0] != 0) {
+			continue;
+		}
+		
+		// Skip ahead to the next time where an upper level needs to be redistributed
+		Time next = now + 1;
+		size_t shift = FirstBits;
+		for(size_t level = 1; level <= Levels; level++, shift += LevelBits) {
+			if(counts[level] != 0) {
+				Time mask = (Time(1) << shift) - 1;
+				next = std::min(next, (current + mask) & ~mask);
+				break;
+			}
+		}
+		current = std::max(current, next);
+	}
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ARX_SCRIPT_TIMERWHEEL_H
+#define ARX_SCRIPT_TIMERWHEEL_H
+
+#include <stddef.h>
+#include <vector>
+
+/*!
+ * Hierarchical timing wheel for a fixed set of timer ids.
+ *
+ * Timers are sorted into buckets by how far in the future they expire:
+ * the first level has one bucket per millisecond for the next 256 ms and each
+ * of the following levels covers 64 times the range of the previous one.
+ * Timers further than about 18 hours in the future are kept in an overflow list.
+ * Buckets of the upper levels are redistributed to the lower levels as time
+ * advances, so inserting and removing a timer take constant time and expiring
+ * timers only touches buckets that are actually due.
+ */
+class TimerWheel {
+	
+public:
+	
+	typedef unsigned long Time;
+	
+	TimerWheel();
+	
+	/*!
+	 * Remove all timers.
+	 *
+	 * @param capacity the number of timer ids, valid ids are 0 to capacity - 1
+	 * @param now time that has already been processed
+	 */
+	void reset(size_t capacity, Time now);
+	
+	//! Schedule a timer, replacing any previous schedule for the same id
+	void insert(size_t id, Time time);
+	
+	//! Cancel a timer, does nothing if the timer is not scheduled
+	void remove(size_t id);
+	
+	bool contains(size_t id) const {
+		return id < nodes.size() && nodes[id].bucket != None;
+	}
+	
+	/*!
+	 * Remove all timers that expire at or before now and append their ids to due.
+	 * Timers scheduled for a time that has already been processed expire immediately.
+	 */
+	void expire(Time now, std::vector<size_t> & due);
+	
+	//! @return the first time that has not been processed by expire() yet
+	Time getTime() const { return current; }
+	
+	//! @return the number of scheduled timers
+	size_t size() const { return count; }
+	
+private:
+	
+	static const size_t None = size_t(-1);
+	
+	static const size_t FirstBits = 8;
+	static const size_t LevelBits = 6;
+	static const size_t Levels = 4; //!< including the first level
+	
+	static const size_t FirstSize = size_t(1) << FirstBits;
+	static const size_t LevelSize = size_t(1) << LevelBits;
+	static const size_t OverflowBucket = FirstSize + (Levels - 1) * LevelSize;
+	static const size_t DueBucket = OverflowBucket + 1;
+	static const size_t Buckets = DueBucket + 1;
+	
+	struct Node {
+		size_t prev;
+		size_t next;
+		size_t bucket;
+		Time time;
+	};
+	
+	std::vector<Node> nodes;
+	size_t heads[Buckets];
+	size_t counts[Levels + 2]; //!< number of timers in each level, overflow and due list
+	size_t count;
+	Time current;
+	
+	size_t getBucket(Time time) const;
+	static size_t getLevel(size_t bucket);
+	
+	void link(size_t id, size_t bucket);
+	void unlink(size_t id);
+	
+	//! Redistribute buckets of the upper levels that start at the current time
+	void cascade();
+	
+	//! Move all timers from a bucket to the due list
+	void take(size_t bucket, std::vector<size_t> & due);
+	
+};
+
+#endif // ARX_SCRIPT_TIMERWHEEL_H
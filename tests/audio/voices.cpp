@@ -0,0 +1,185 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <cstdlib>
+#include <vector>
+
+#include <cppunit/TestCase.h>
+
+#include "audio/AudioTypes.h"
+#include "audio/VoicePool.h"
+
+using audio::VoicePool;
+
+/*
+ * A voice that only records whether it has a hardware voice, so that the
+ * pool can be tested without an audio backend.
+ */
+class TestVoice : public VoicePool::Voice {
+	
+public:
+	
+	int priority;
+	float audibility;
+	bool fail;
+	bool playing;
+	
+	TestVoice() : priority(0), audibility(1.f), fail(false), playing(false) { }
+	
+	int getPriority() const { return priority; }
+	float getAudibility() const { return audibility; }
+	
+protected:
+	
+	bool activate() {
+		if(fail) {
+			return false;
+		}
+		playing = true;
+		return true;
+	}
+	
+	void deactivate() {
+		playing = false;
+	}
+	
+};
+
+class VoicePoolTest : public CppUnit::TestCase {
+	
+	static size_t countActive(const std::vector<TestVoice> & voices) {
+		size_t count = 0;
+		for(size_t i = 0; i < voices.size(); i++) {
+			CPPUNIT_ASSERT(voices[i].isActive() == voices[i].playing);
+			count += voices[i].isActive() ? 1 : 0;
+		}
+		return count;
+	}
+	
+	static bool isMoreImportant(const TestVoice & a, const TestVoice & b) {
+		if(a.priority != b.priority) {
+			return a.priority > b.priority;
+		}
+		return a.audibility > b.audibility;
+	}
+	
+	void testStealing() {
+		
+		std::vector<TestVoice> voices(4);
+		VoicePool pool(2);
+		
+		pool.add(&voices[0]);
+		pool.add(&voices[1]);
+		CPPUNIT_ASSERT(voices[0].isActive() && voices[1].isActive());
+		
+		// Not more important than any active voice
+		voices[2].audibility = 0.5f;
+		pool.add(&voices[2]);
+		CPPUNIT_ASSERT(!voices[2].isActive() && pool.getActiveCount() == 2);
+		
+		// Higher priority steals from the quietest voice
+		voices[1].audibility = 0.8f;
+		voices[3].priority = audio::PRIORITY_HIGH;
+		voices[3].audibility = 0.1f;
+		pool.add(&voices[3]);
+		CPPUNIT_ASSERT(voices[3].isActive() && voices[0].isActive() && !voices[1].isActive());
+		
+		// Removing an active voice frees its hardware voice for the next update
+		pool.remove(&voices[0]);
+		CPPUNIT_ASSERT(!voices[0].isActive() && pool.getActiveCount() == 1);
+		pool.update();
+		CPPUNIT_ASSERT(voices[1].isActive() && !voices[2].isActive() && voices[3].isActive());
+		
+		// Inaudible voices lose their hardware voice even when there are enough
+		pool.remove(&voices[2]);
+		voices[1].audibility = 0.f;
+		pool.update();
+		CPPUNIT_ASSERT(!voices[1].isActive() && pool.getActiveCount() == 1);
+		
+		// Unknown voices are ignored
+		pool.remove(&voices[2]);
+		CPPUNIT_ASSERT(pool.size() == 2);
+	}
+	
+	void testRandom() {
+		
+		srand(38);
+		
+		for(int i = 0; i < 1000; i++) {
+			
+			size_t max = 1 + rand() % 8;
+			VoicePool pool(max);
+			
+			std::vector<TestVoice> voices(1 + rand() % 32);
+			for(size_t j = 0; j < voices.size(); j++) {
+				voices[j].priority = rand() % 3 - 1;
+				voices[j].audibility = (rand() % 4 == 0) ? 0.f : float(rand() % 1000) / 1000.f;
+				voices[j].fail = (rand() % 16 == 0);
+				pool.add(&voices[j]);
+				CPPUNIT_ASSERT(countActive(voices) == pool.getActiveCount());
+				CPPUNIT_ASSERT(pool.getActiveCount() <= max);
+			}
+			
+			for(size_t j = 0; j < voices.size(); j++) {
+				voices[j].audibility = (rand() % 4 == 0) ? 0.f : float(rand() % 1000) / 1000.f;
+			}
+			pool.update();
+			CPPUNIT_ASSERT(countActive(voices) == pool.getActiveCount());
+			
+			// Every audible voice without a hardware voice is less important than all
+			// voices that have one, unless it failed to allocate one.
+			for(size_t j = 0; j < voices.size(); j++) {
+				if(voices[j].isActive()) {
+					CPPUNIT_ASSERT(voices[j].audibility >= 0.001f);
+					continue;
+				}
+				if(voices[j].fail || voices[j].audibility < 0.001f) {
+					continue;
+				}
+				for(size_t k = 0; k < voices.size(); k++) {
+					if(voices[k].isActive()) {
+						CPPUNIT_ASSERT(!isMoreImportant(voices[j], voices[k]));
+					}
+				}
+			}
+			
+			for(size_t j = 0; j < voices.size(); j++) {
+				pool.remove(&voices[j]);
+			}
+			CPPUNIT_ASSERT(pool.size() == 0 && pool.getActiveCount() == 0);
+			CPPUNIT_ASSERT(countActive(voices) == 0);
+		}
+	}
+	
+public:
+	
+	VoicePoolTest(std::string name) : CppUnit::TestCase(name) { }
+	
+	void runTest() {
+		testStealing();
+		testRandom();
+	}
+	
+};
+
+int main() {
+	VoicePoolTest test("voices");
+	test.runTest();
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <cppunit/TestCase.h>
+
+#include "io/Blast.h"
+#include "platform/Time.h"
+
+/*
+ * Writes a valid PKWare DCL stream with uncoded literals and random
+ * length/distance pairs, and the data it decompresses to.
+ */
+class BlastEncoder {
+	
+	std::vector<char> & out;
+	unsigned bitbuf;
+	unsigned bitcnt;
+	
+public:
+	
+	std::vector<char> data;
+	
+	explicit BlastEncoder(std::vector<char> & _out) : out(_out), bitbuf(0), bitcnt(0) {
+		out.push_back(0); // uncoded literals
+		out.push_back(6); // 4096 byte dictionary
+	}
+	
+	void bits(unsigned value, unsigned count) {
+		bitbuf |= value << bitcnt;
+		bitcnt += count;
+		while(bitcnt >= 8) {
+			out.push_back(char(bitbuf & 0xff));
+			bitbuf >>= 8, bitcnt -= 8;
+		}
+	}
+	
+	void literal(char c) {
+		bits(0, 1);
+		bits((unsigned char)c, 8);
+		data.push_back(c);
+	}
+	
+	/* copy 3 to 518 bytes from 1 to 64 bytes back */
+	void match(unsigned len, unsigned dist) {
+		
+		// Length codes and extra bits, in stream bit order (symbol 1 is unused)
+		static const unsigned codes[16] = {
+			0x3, 0x5, 0x1, 0x6, 0xa, 0x2, 0xc, 0x14, 0x4, 0x18, 0x8, 0x30, 0x10, 0x20, 0x40, 0x0
+		};
+		static const unsigned codelen[16] = { 2, 3, 3, 3, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 7, 7 };
+		static const unsigned base[16] = {
+			3, 2, 4, 5, 6, 7, 8, 9, 10, 12, 16, 24, 40, 72, 136, 264
+		};
+		static const unsigned extra[16] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+		
+		unsigned symbol = 15;
+		while(symbol > 0 && (symbol == 1 || base[symbol] > len)) {
+			symbol--;
+		}
+		
+		bits(1, 1);
+		bits(codes[symbol], codelen[symbol]);
+		bits(len - base[symbol], extra[symbol]);
+		
+		// Distance code 0 followed by the low six bits
+		bits(0x3, 2);
+		bits(dist - 1, 6);
+		
+		for(unsigned i = 0; i < len; i++) {
+			data.push_back(data[data.size() - dist]);
+		}
+	}
+	
+	void end() {
+		bits(1, 1);
+		bits(0x0, 7); // length code 15
+		bits(0xff, 8);
+		bits(0, 7); // flush
+	}
+	
+	static void random(std::vector<char> & compressed, std::vector<char> & data, size_t size,
+	                   unsigned maxLength = 518) {
+		BlastEncoder encoder(compressed);
+		while(encoder.data.size() < size) {
+			if(encoder.data.size() < 64 || rand() % 2 == 0) {
+				encoder.literal(char(rand()));
+			} else {
+				encoder.match(3 + rand() % (maxLength - 2), 1 + rand() % 64);
+			}
+		}
+		encoder.end();
+		data.swap(encoder.data);
+	}
+	
+};
+
+/*
+ * Compares the in-memory fast path of blastMem() against the streaming
+ * blast() decoder, on valid streams and on random input. Any byte sequence
+ * with a valid header is a prefix of some compressed stream, so random data
+ * exercises literals, matches, invalid distances and truncated input.
+ */
+class BlastTest : public CppUnit::TestCase {
+	
+	static std::vector<char> randomStream(size_t size) {
+		std::vector<char> data(size);
+		for(size_t i = 0; i < size; i++) {
+			data[i] = char(rand());
+		}
+		data[0] = char(rand() % 2); // literal flag
+		data[1] = char(4 + rand() % 3); // dictionary size
+		return data;
+	}
+	
+	static size_t blastReference(const std::vector<char> & in, std::vector<char> & out) {
+		BlastMemInBuffer inBuf(&in[0], in.size());
+		BlastMemOutBuffer outBuf(&out[0], out.size());
+		if(blast(blastInMem, &inBuf, blastOutMem, &outBuf)) {
+			return 0;
+		}
+		return out.size() - outBuf.size;
+	}
+	
+public:
+	
+	BlastTest(std::string name) : CppUnit::TestCase(name) { }
+	
+	void runTest() {
+		
+		srand(42);
+		
+		for(int i = 0; i < 1000; i++) {
+			
+			std::vector<char> in, expected;
+			BlastEncoder::random(in, expected, 1 + rand() % (256 * 1024));
+			
+			std::vector<char> actual(expected.size());
+			size_t size = blastMem(&in[0], in.size(), &actual[0], actual.size());
+			CPPUNIT_ASSERT(size == expected.size() && actual == expected);
+			
+			size_t allocSize;
+			char * alloc = blastMemAlloc(&in[0], in.size(), allocSize);
+			CPPUNIT_ASSERT(alloc != NULL && allocSize == expected.size());
+			CPPUNIT_ASSERT(std::equal(expected.begin(), expected.end(), alloc));
+			free(alloc);
+			
+			// Output buffer too small
+			CPPUNIT_ASSERT(blastMem(&in[0], in.size(), &actual[0], actual.size() - 1) == 0);
+			
+			// Truncated input
+			CPPUNIT_ASSERT(blastMem(&in[0], in.size() - 2, &actual[0], actual.size()) == 0);
+		}
+		
+		for(int i = 0; i < 10000; i++) {
+			
+			std::vector<char> in = randomStream(2 + rand() % 2048);
+			size_t maxOut = 1 + rand() % (64 * 1024);
+			
+			std::vector<char> expected(maxOut);
+			size_t expectedSize = blastReference(in, expected);
+			
+			std::vector<char> actual(maxOut);
+			size_t actualSize = blastMem(&in[0], in.size(), &actual[0], actual.size());
+			
+			CPPUNIT_ASSERT(actualSize == expectedSize);
+			CPPUNIT_ASSERT(std::equal(expected.begin(), expected.begin() + expectedSize,
+			                          actual.begin()));
+		}
+	}
+	
+	void runBenchmark() {
+		
+		srand(1);
+		
+		size_t inTotal = 0, outTotal = 0;
+		u64 streamTime = 0, memTime = 0;
+		
+		for(int i = 0; i < 100; i++) {
+			
+			std::vector<char> in, data;
+			// Mostly short matches, similar to the game data
+			BlastEncoder::random(in, data, 1024 * 1024, 16);
+			std::vector<char> out(data.size());
+			
+			u64 start = Time::getUs();
+			blastReference(in, out);
+			u64 middle = Time::getUs();
+			blastMem(&in[0], in.size(), &out[0], out.size());
+			u64 end = Time::getUs();
+			
+			inTotal += in.size(), outTotal += data.size();
+			streamTime += middle - start, memTime += end - middle;
+		}
+		
+		printf("blast: %.1f MB/s, blastMem: %.1f MB/s (%lu -> %lu bytes)\n",
+		       double(outTotal) / double(std::max(streamTime, u64(1))),
+		       double(outTotal) / double(std::max(memTime, u64(1))),
+		       (unsigned long)inTotal, (unsigned long)outTotal);
+	}
+	
+};
+
+int main(int argc, char * argv[]) {
+	BlastTest test("blast");
+	test.runTest();
+	if(argc > 1 && !strcmp(argv[1], "--benchmark")) {
+		test.runBenchmark();
+	}
+}
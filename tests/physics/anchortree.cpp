@@ -0,0 +1,126 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+#include <cppunit/TestCase.h>
+
+#include "graphics/BaseGraphicsTypes.h"
+#include "physics/AnchorTree.h"
+#include "physics/Anchors.h"
+
+/*
+ * Compares the anchor tree against a linear scan over all anchors while
+ * randomly blocking and unblocking anchors. Anchor positions are snapped to a
+ * coarse grid so that many queries have several anchors at the same distance.
+ */
+class AnchorTreeTest : public CppUnit::TestCase {
+	
+	static float randomCoord(int range) {
+		return float((rand() % range) * 25);
+	}
+	
+	static long nearest(const std::vector<ANCHOR_DATA> & anchors, const Vec3f & pos,
+	                    const EERIE_CYLINDER * cyl, long except) {
+		long best = -1;
+		float bestDist = std::numeric_limits<float>::max();
+		for(size_t i = 0; i < anchors.size(); i++) {
+			const ANCHOR_DATA & anchor = anchors[i];
+			if(!anchor.nblinked || long(i) == except) {
+				continue;
+			}
+			if(cyl && (anchor.height > cyl->height || anchor.radius < cyl->radius
+			           || (anchor.flags & ANCHOR_FLAG_BLOCKED))) {
+				continue;
+			}
+			float d = distSqr(anchor.pos, pos);
+			if(d < bestDist) {
+				best = long(i);
+				bestDist = d;
+			}
+		}
+		return best;
+	}
+	
+public:
+	
+	AnchorTreeTest(std::string name) : CppUnit::TestCase(name) { }
+	
+	void runTest() {
+		
+		srand(42);
+		
+		for(int run = 0; run < 50; run++) {
+			
+			int range = 2 + rand() % 40;
+			
+			std::vector<ANCHOR_DATA> anchors(rand() % 2000);
+			for(size_t i = 0; i < anchors.size(); i++) {
+				ANCHOR_DATA & anchor = anchors[i];
+				anchor.pos = Vec3f(randomCoord(range), randomCoord(4), randomCoord(range));
+				anchor.nblinked = short(rand() % 8 == 0 ? 0 : 1 + rand() % 4);
+				anchor.flags = (rand() % 4 == 0) ? ANCHOR_FLAG_BLOCKED : AnchorFlags();
+				anchor.linked = NULL;
+				anchor.radius = float(rand() % 80);
+				anchor.height = -float(rand() % 250);
+			}
+			
+			AnchorTree tree(anchors.empty() ? NULL : &anchors[0], anchors.size());
+			
+			for(int i = 0; i < 2000; i++) {
+				
+				if(!anchors.empty() && rand() % 3 == 0) {
+					long anchor = rand() % anchors.size();
+					tree.setBlocked(anchor, rand() % 2 == 0);
+				}
+				
+				if(rand() % 500 == 0) {
+					tree.clearBlocked();
+					for(size_t j = 0; j < anchors.size(); j++) {
+						CPPUNIT_ASSERT(!(anchors[j].flags & ANCHOR_FLAG_BLOCKED));
+					}
+				}
+				
+				Vec3f pos(randomCoord(range + 4) - 50.f, randomCoord(6) - 25.f,
+				          randomCoord(range + 4) - 50.f);
+				
+				EERIE_CYLINDER cyl;
+				cyl.origin = pos;
+				cyl.radius = float(rand() % 100);
+				cyl.height = -float(rand() % 300);
+				
+				long except = anchors.empty() ? -1 : long(rand() % anchors.size());
+				
+				CPPUNIT_ASSERT(tree.getNearest(pos) == nearest(anchors, pos, NULL, -1));
+				CPPUNIT_ASSERT(tree.getNearest(pos, cyl) == nearest(anchors, pos, &cyl, -1));
+				CPPUNIT_ASSERT(tree.getNearest(pos, cyl, except)
+				               == nearest(anchors, pos, &cyl, except));
+			}
+		}
+	}
+	
+};
+
+int main() {
+	AnchorTreeTest test("anchortree");
+	test.runTest();
+}
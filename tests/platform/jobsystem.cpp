@@ -0,0 +1,164 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <cstring>
+#include <vector>
+
+#include <cppunit/TestCase.h>
+
+#include "platform/CrashHandler.h"
+#include "platform/JobSystem.h"
+#include "platform/Platform.h"
+#include "platform/WorkerPool.h"
+
+/*
+ * Runs a small replay of entities that are updated in parallel each frame,
+ * with a serial phase after each update that depends on the results, and
+ * checks that the final state does not depend on the number of threads.
+ */
+class JobSystemTest : public CppUnit::TestCase {
+	
+	struct Body {
+		u32 seed;
+		float pos[3];
+		float vel[3];
+		u32 hits;
+	};
+	
+	class UpdateTask : public WorkerTask {
+		
+		std::vector<Body> & bodies;
+		u32 frame;
+		
+	public:
+		
+		UpdateTask(std::vector<Body> & _bodies, u32 _frame) : bodies(_bodies), frame(_frame) { }
+		
+		void process(size_t item) {
+			
+			Body & body = bodies[item];
+			
+			// Uneven amounts of work per entity
+			size_t steps = 1 + (body.seed >> 8) % 64;
+			for(size_t i = 0; i < steps; i++) {
+				body.seed = body.seed * 1664525u + 1013904223u + frame;
+				for(int j = 0; j < 3; j++) {
+					float accel = float(int((body.seed >> (j * 8)) & 0xff) - 128) * 0.001f;
+					body.vel[j] = body.vel[j] * 0.99f + accel;
+					body.pos[j] += body.vel[j];
+				}
+			}
+		}
+		
+	};
+	
+	static std::vector<Body> replay(size_t threads, size_t count, u32 frames) {
+		
+		WorkerPool::setThreadCount(threads);
+		
+		std::vector<Body> bodies(count);
+		for(size_t i = 0; i < count; i++) {
+			std::memset(&bodies[i], 0, sizeof(Body));
+			bodies[i].seed = u32(i * 2654435761u);
+		}
+		
+		for(u32 frame = 0; frame < frames; frame++) {
+			
+			UpdateTask task(bodies, frame);
+			WorkerPool::run(task, bodies.size());
+			
+			// Serial phase, in entity order like the script dispatch
+			for(size_t i = 1; i < bodies.size(); i++) {
+				if(bodies[i].pos[0] > bodies[i - 1].pos[0]) {
+					bodies[i].hits++;
+					bodies[i - 1].vel[1] += 0.01f;
+				}
+			}
+		}
+		
+		return bodies;
+	}
+	
+	class CountJob : public Job {
+		
+	public:
+		
+		size_t runs;
+		size_t work;
+		
+		CountJob() : runs(0), work(0) { }
+		
+		void run() {
+			volatile size_t sum = 0;
+			for(size_t i = 0; i < work; i++) {
+				sum += i;
+			}
+			runs++;
+		}
+		
+	};
+	
+public:
+	
+	JobSystemTest(std::string name) : CppUnit::TestCase(name) { }
+	
+	void runTest() {
+		
+		// Determinism of the replay
+		std::vector<Body> expected = replay(1, 500, 200);
+		for(size_t threads = 2; threads <= 8; threads *= 2) {
+			std::vector<Body> actual = replay(threads, 500, 200);
+			CPPUNIT_ASSERT(actual.size() == expected.size());
+			for(size_t i = 0; i < expected.size(); i++) {
+				CPPUNIT_ASSERT(!std::memcmp(&actual[i], &expected[i], sizeof(Body)));
+			}
+		}
+		WorkerPool::shutdown();
+		
+		// Every job runs exactly once, including uneven batches and reuse of the system
+		JobSystem jobs(4);
+		for(size_t batch = 0; batch < 100; batch++) {
+			std::vector<CountJob> counts(1 + batch * 7 % 97);
+			JobGroup group;
+			for(size_t i = 0; i < counts.size(); i++) {
+				counts[i].work = (i * 7919) % 20000;
+				jobs.submit(counts[i], group);
+			}
+			jobs.wait(group);
+			CPPUNIT_ASSERT(group.isDone());
+			for(size_t i = 0; i < counts.size(); i++) {
+				CPPUNIT_ASSERT(counts[i].runs == 1);
+			}
+		}
+	}
+	
+};
+
+// Worker threads register crash handlers, but the test does not install any
+bool CrashHandler::registerThreadCrashHandlers() {
+	return false;
+}
+
+void CrashHandler::unregisterThreadCrashHandlers() { }
+
+int main() {
+	JobSystemTest test("jobsystem");
+	test.runTest();
+}
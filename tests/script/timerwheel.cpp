@@ -0,0 +1,115 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include <cppunit/TestCase.h>
+
+#include "script/TimerWheel.h"
+
+/*
+ * Compares the timing wheel against a plain list of expiry times, with time
+ * steps ranging from single milliseconds to several days.
+ */
+class TimerWheelTest : public CppUnit::TestCase {
+	
+	typedef TimerWheel::Time Time;
+	
+	static const size_t capacity = 500;
+	
+	static Time randomDelay() {
+		switch(rand() % 4) {
+			case 0: return Time(rand() % 300);
+			case 1: return Time(rand() % 20000);
+			case 2: return Time(rand() % 2000000);
+			default: return Time(rand()) * Time(rand() % 64) % (Time(1) << 30);
+		}
+	}
+	
+public:
+	
+	TimerWheelTest(std::string name) : CppUnit::TestCase(name) { }
+	
+	void runTest() {
+		
+		srand(42);
+		
+		for(int run = 0; run < 20; run++) {
+			
+			Time now = Time(rand()) % 100000;
+			
+			TimerWheel wheel;
+			wheel.reset(capacity, now);
+			
+			std::vector<bool> scheduled(capacity, false);
+			std::vector<Time> times(capacity, 0);
+			
+			for(int step = 0; step < 2000; step++) {
+				
+				for(int i = rand() % 20; i > 0; i--) {
+					size_t id = size_t(rand()) % capacity;
+					if(rand() % 4 == 0) {
+						wheel.remove(id);
+						scheduled[id] = false;
+					} else {
+						// Occasionally schedule timers in the past
+						times[id] = now + randomDelay() - Time(rand() % 4 == 0 ? 10 : 0);
+						wheel.insert(id, times[id]);
+						scheduled[id] = true;
+					}
+					CPPUNIT_ASSERT(wheel.contains(id) == scheduled[id]);
+				}
+				
+				switch(rand() % 3) {
+					case 0: now += Time(rand() % 20); break;
+					case 1: now += Time(rand() % 5000); break;
+					default: now += randomDelay(); break;
+				}
+				
+				std::vector<size_t> due;
+				wheel.expire(now, due);
+				std::sort(due.begin(), due.end());
+				
+				std::vector<size_t> expected;
+				size_t remaining = 0;
+				for(size_t id = 0; id < capacity; id++) {
+					if(scheduled[id] && times[id] <= now) {
+						expected.push_back(id);
+						scheduled[id] = false;
+					} else if(scheduled[id]) {
+						remaining++;
+					}
+				}
+				
+				CPPUNIT_ASSERT(due == expected);
+				CPPUNIT_ASSERT(wheel.size() == remaining);
+				CPPUNIT_ASSERT(wheel.getTime() == now + 1);
+			}
+		}
+	}
+	
+};
+
+int main() {
+	TimerWheelTest test("timerwheel");
+	test.runTest();
+}
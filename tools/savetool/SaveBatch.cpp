@@ -0,0 +1,295 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "savetool/SaveBatch.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "io/SaveBlock.h"
+#include "io/fs/FilePath.h"
+#include "io/fs/Filesystem.h"
+#include "platform/WorkerPool.h"
+#include "scene/SaveFormat.h"
+
+using std::string;
+using std::vector;
+using std::cout;
+using std::cerr;
+using std::endl;
+
+namespace {
+
+const char * const SAVE_BLOCK_NAME = "gsave.sav";
+
+/*!
+ * Collect the save block files for the command line arguments.
+ * Directories are searched for save blocks and save game directories, one level deep.
+ */
+void find_saves(vector<fs::path> & saves, int argc, char ** argv) {
+	
+	for(int i = 0; i < argc; i++) {
+		
+		fs::path path = argv[i];
+		
+		if(!fs::is_directory(path)) {
+			saves.push_back(path);
+			continue;
+		}
+		
+		if(fs::is_regular_file(path / SAVE_BLOCK_NAME)) {
+			saves.push_back(path / SAVE_BLOCK_NAME);
+			continue;
+		}
+		
+		for(fs::directory_iterator it(path); !it.end(); ++it) {
+			string name = it.name();
+			if(it.is_directory()) {
+				fs::path savefile = path / name / SAVE_BLOCK_NAME;
+				if(fs::is_regular_file(savefile)) {
+					saves.push_back(savefile);
+				}
+			} else if(it.is_regular_file() && name.length() > 4
+			          && !name.compare(name.length() - 4, 4, ".sav")) {
+				saves.push_back(path / name);
+			}
+		}
+	}
+	
+}
+
+bool is_level(const string & name) {
+	return name.length() == 6 && !name.compare(0, 3, "lvl")
+	       && isdigit(name[3]) && isdigit(name[4]) && isdigit(name[5]);
+}
+
+/*!
+ * Processes one save game per item - results are buffered per save so that
+ * the output does not depend on the number of threads.
+ */
+class SaveTask : public WorkerTask {
+	
+protected:
+	
+	const vector<fs::path> & saves;
+	
+public:
+	
+	vector<string> output;
+	vector<char> failed;
+	
+	explicit SaveTask(const vector<fs::path> & _saves)
+		: saves(_saves), output(_saves.size()), failed(_saves.size(), 0) { }
+	
+	int print() const {
+		int ret = 0;
+		for(size_t i = 0; i < output.size(); i++) {
+			cout << output[i];
+			if(failed[i]) {
+				ret = 1;
+			}
+		}
+		return ret;
+	}
+	
+};
+
+/*
+ * Output format, one tab-separated record per line:
+ *  save    <savefile> <file count> <stored bytes> <uncompressed bytes> <ok|outdated>
+ *  file    <savefile> <name> <compression> <chunks> <stored bytes> <uncompressed bytes>
+ *  level   <savefile> <name> <entity count>
+ *  globals <savefile> <variable count>
+ *  error   <savefile> <name or -> <message>
+ */
+class StatsTask : public SaveTask {
+	
+	static void stats(std::ostream & out, const fs::path & savefile, const string & name,
+	                  const char * dat, size_t size) {
+		
+		if(is_level(name)) {
+			const ARX_CHANGELEVEL_INDEX * asi = reinterpret_cast<const ARX_CHANGELEVEL_INDEX *>(dat);
+			if(size < sizeof(*asi) || asi->version != ARX_GAMESAVE_VERSION) {
+				out << "error\t" << savefile.string() << '\t' << name << "\tbad level data\n";
+			} else {
+				out << "level\t" << savefile.string() << '\t' << name << '\t' << asi->nb_inter << '\n';
+			}
+		} else if(name == "globals") {
+			const ARX_CHANGELEVEL_SAVE_GLOBALS * asg;
+			asg = reinterpret_cast<const ARX_CHANGELEVEL_SAVE_GLOBALS *>(dat);
+			if(size < sizeof(*asg) || asg->version != ARX_GAMESAVE_VERSION) {
+				out << "error\t" << savefile.string() << '\t' << name << "\tbad globals data\n";
+			} else {
+				out << "globals\t" << savefile.string() << '\t' << asg->nb_globals << '\n';
+			}
+		}
+		
+	}
+	
+public:
+	
+	explicit StatsTask(const vector<fs::path> & _saves) : SaveTask(_saves) { }
+	
+	void process(size_t i) {
+		
+		const fs::path & savefile = saves[i];
+		std::ostringstream out;
+		
+		SaveBlock save(savefile);
+		if(!save.open()) {
+			out << "error\t" << savefile.string() << "\t-\tcould not open save\n";
+			output[i] = out.str(), failed[i] = 1;
+			return;
+		}
+		
+		std::ostringstream details;
+		size_t storedTotal = 0, uncompressedTotal = 0;
+		
+		vector<string> files = save.getFiles();
+		for(vector<string>::const_iterator file = files.begin(); file != files.end(); ++file) {
+			
+			SaveBlock::FileInfo info;
+			save.getFileInfo(*file, info);
+			
+			// Load every file: old saves don't record the uncompressed size
+			size_t size = 0;
+			char * dat = save.load(*file, size);
+			if(!dat) {
+				details << "error\t" << savefile.string() << '\t' << *file << "\tcould not load\n";
+				failed[i] = 1;
+				continue;
+			}
+			
+			details << "file\t" << savefile.string() << '\t' << *file << '\t' << info.compression
+			        << '\t' << info.chunks << '\t' << info.storedSize << '\t' << size << '\n';
+			storedTotal += info.storedSize, uncompressedTotal += size;
+			
+			stats(details, savefile, *file, dat, size);
+			
+			free(dat);
+		}
+		
+		out << "save\t" << savefile.string() << '\t' << files.size() << '\t' << storedTotal
+		    << '\t' << uncompressedTotal << '\t' << (save.isOutdated() ? "outdated" : "ok") << '\n';
+		out << details.str();
+		
+		output[i] = out.str();
+	}
+	
+};
+
+class UpgradeTask : public SaveTask {
+	
+	static bool upgrade(const fs::path & savefile, const fs::path & tempfile) {
+		
+		SaveBlock save(savefile);
+		if(!save.open()) {
+			return false;
+		}
+		
+		SaveBlock upgraded(tempfile);
+		if(!upgraded.open(true)) {
+			return false;
+		}
+		
+		vector<string> files = save.getFiles();
+		for(vector<string>::const_iterator file = files.begin(); file != files.end(); ++file) {
+			
+			size_t size = 0;
+			char * dat = save.load(*file, size);
+			if(!dat) {
+				return false;
+			}
+			
+			bool saved = upgraded.save(*file, dat, size);
+			free(dat);
+			if(!saved) {
+				return false;
+			}
+		}
+		
+		return upgraded.flush("pld");
+	}
+	
+public:
+	
+	explicit UpgradeTask(const vector<fs::path> & _saves) : SaveTask(_saves) { }
+	
+	void process(size_t i) {
+		
+		const fs::path & savefile = saves[i];
+		
+		{
+			SaveBlock save(savefile);
+			if(!save.open()) {
+				output[i] = "error\t" + savefile.string() + "\t-\tcould not open save\n";
+				failed[i] = 1;
+				return;
+			}
+			if(!save.isOutdated()) {
+				output[i] = "current\t" + savefile.string() + '\n';
+				return;
+			}
+		}
+		
+		fs::path tempfile = savefile;
+		tempfile.set_ext("upgrade");
+		fs::remove(tempfile);
+		
+		// Write the new save block next to the old one and only replace it if that succeeded
+		if(!upgrade(savefile, tempfile) || !fs::rename(tempfile, savefile, true)) {
+			fs::remove(tempfile);
+			output[i] = "error\t" + savefile.string() + "\t-\tupgrade failed\n";
+			failed[i] = 1;
+			return;
+		}
+		
+		output[i] = "upgraded\t" + savefile.string() + '\n';
+	}
+	
+};
+
+} // anonymous namespace
+
+int main_stats(int argc, char ** argv) {
+	
+	vector<fs::path> saves;
+	find_saves(saves, argc, argv);
+	
+	StatsTask task(saves);
+	WorkerPool::run(task, saves.size());
+	
+	return task.print();
+}
+
+int main_upgrade(int argc, char ** argv) {
+	
+	vector<fs::path> saves;
+	find_saves(saves, argc, argv);
+	
+	UpgradeTask task(saves);
+	WorkerPool::run(task, saves.size());
+	
+	return task.print();
+}
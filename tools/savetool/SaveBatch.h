@@ -0,0 +1,36 @@
+/*
+ * Copyright 2011-2012 Arx Libertatis Team (see the AUTHORS file)
+ *
+ * This file is part of Arx Libertatis.
+ *
+ * Arx Libertatis is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Arx Libertatis is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arx Libertatis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ARX_TOOLS_SAVETOOL_SAVEBATCH_H
+#define ARX_TOOLS_SAVETOOL_SAVEBATCH_H
+
+/*!
+ * Print machine-readable statistics for all save games under the given paths.
+ * Each argument is either a save block file or a directory containing save games.
+ */
+int main_stats(int argc, char ** argv);
+
+/*!
+ * Rewrite all outdated save games under the given paths using the current
+ * save block format and deflate compression.
+ */
+int main_upgrade(int argc, char ** argv);
+
+#endif // ARX_TOOLS_SAVETOOL_SAVEBATCH_H
@@ -23,6 +23,7 @@
 #include "io/fs/Filesystem.h"
 #include "io/log/Logger.h"
 
+#include "savetool/SaveBatch.h"
 #include "savetool/SaveFix.h"
 #include "savetool/SaveView.h"
 
@@ -39,6 +40,8 @@ static void print_help() {
 	cout << " - add <savefile> [<files>...]" << endl;
 	cout << " - fix <savefile>" << endl;
 	cout << " - view <savefile> [<ident>]" << endl;
+	cout << " - stats <savedir>... (tab-separated statistics for many saves)" << endl;
+	cout << " - upgrade <savedir>... (rewrite outdated saves in the current format)" << endl;
 }
 
 static int main_extract(SaveBlock & save, int argc, char ** argv) {
@@ -125,6 +128,13 @@ int main(int argc, char ** argv) {
 	
 	string command = argv[1];
 	
+	// Batch commands that operate on many save files
+	if(command == "s" || command == "stats") {
+		return main_stats(argc - 2, argv + 2);
+	} else if(command == "u" || command == "upgrade") {
+		return main_upgrade(argc - 2, argv + 2);
+	}
+	
 	fs::path savefile = argv[2];
 	
 	if(fs::is_directory(savefile)) {
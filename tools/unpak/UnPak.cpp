@@ -18,10 +18,13 @@
  */
 
 #include <string>
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
-#include <sstream>
-#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <boost/crc.hpp>
 
 #include "io/fs/FilePath.h"
 #include "io/fs/Filesystem.h"
@@ -30,49 +33,233 @@
 #include "io/resource/PakEntry.h"
 #include "io/resource/ResourcePath.h"
 #include "io/log/Logger.h"
+#include "platform/Lock.h"
+#include "platform/WorkerPool.h"
 
-using std::transform;
-using std::ostringstream;
 using std::string;
+using std::vector;
 
-void dump(PakDirectory & dir, const fs::path & dirname = fs::path()) {
+enum UnpakMode {
+	UnpakExtract,
+	UnpakVerify,
+	UnpakList
+};
+
+struct UnpakEntry {
+	
+	res::path name;
+	fs::path filename;
+	size_t size;
+	size_t compressedSize;
 	
-	fs::create_directories(dirname);
+	// Results
+	bool ok;
+	u32 crc;
+	
+};
+
+static void collect(vector<UnpakEntry> & entries, PakDirectory & dir,
+                    const res::path & dirname = res::path(),
+                    const fs::path & filedir = fs::path()) {
 	
 	for(PakDirectory::files_iterator i = dir.files_begin(); i != dir.files_end(); ++i) {
+		UnpakEntry entry;
+		entry.name = dirname / res::path(i->first);
+		entry.filename = filedir / i->first;
+		entry.size = i->second->size();
+		entry.compressedSize = i->second->compressedSize();
+		entry.ok = false;
+		entry.crc = 0;
+		entries.push_back(entry);
+	}
+	
+	for(PakDirectory::dirs_iterator i = dir.dirs_begin(); i != dir.dirs_end(); ++i) {
+		collect(entries, i->second, dirname / res::path(i->first), filedir / i->first);
+	}
+	
+}
+
+/*!
+ * Reads (and writes) the entries of one .pak file on the worker threads.
+ *
+ * The archive streams are not thread-safe, so every thread gets its own
+ * PakReader for the archive - readers are handed out from a free list.
+ */
+class UnpakTask : public WorkerTask {
+	
+	const fs::path & pakfile;
+	vector<UnpakEntry> & entries;
+	UnpakMode mode;
+	
+	Lock mutex;
+	vector<PakReader *> readers;
+	vector<PakReader *> freeReaders;
+	
+	PakReader * acquireReader() {
 		
-		fs::path filename = dirname / i->first;
+		{
+			Autolock lock(mutex);
+			if(!freeReaders.empty()) {
+				PakReader * reader = freeReaders.back();
+				freeReaders.pop_back();
+				return reader;
+			}
+		}
 		
-		PakFile * file = i->second;
+		PakReader * reader = new PakReader;
+		if(!reader->addArchive(pakfile)) {
+			delete reader;
+			return NULL;
+		}
 		
-		printf("%s\n", filename.string().c_str());
+		Autolock lock(mutex);
+		readers.push_back(reader);
+		return reader;
+	}
+	
+	void releaseReader(PakReader * reader) {
+		Autolock lock(mutex);
+		freeReaders.push_back(reader);
+	}
+	
+	bool unpakEntry(PakReader & reader, UnpakEntry & entry) {
 		
-		fs::ofstream ofs(filename, fs::fstream::out | fs::fstream::binary | fs::fstream::trunc);
-		if(!ofs.is_open()) {
-			printf("error opening file for writing: %s\n", filename.string().c_str());
-			exit(1);
+		PakFile * file = reader.getFile(entry.name);
+		if(!file) {
+			return false;
 		}
 		
-		if(file->size() > 0) {
-			
-			char * data = (char*)file->readAlloc();
-			arx_assert(data != NULL);
-			
-			if(ofs.write(data, file->size()).fail()) {
-				printf("error writing to file: %s\n", filename.string().c_str());
-				exit(1);
+		char * data = NULL;
+		if(entry.size > 0) {
+			data = (char *)malloc(entry.size);
+			if(!data || !file->read(data)) {
+				free(data);
+				return false;
 			}
-			
-			free(data);
-			
 		}
 		
+		boost::crc_32_type crc;
+		crc.process_bytes(data, entry.size);
+		entry.crc = crc.checksum();
+		
+		bool ok = true;
+		if(mode == UnpakExtract) {
+			fs::ofstream ofs(entry.filename, fs::fstream::out | fs::fstream::binary
+			                                 | fs::fstream::trunc);
+			ok = ofs.is_open() && (entry.size == 0 || !ofs.write(data, entry.size).fail());
+		}
+		
+		free(data);
+		
+		return ok;
 	}
 	
-	for(PakDirectory::dirs_iterator i = dir.dirs_begin(); i != dir.dirs_end(); ++i) {
-		dump(i->second, dirname / i->first);
+public:
+	
+	UnpakTask(const fs::path & _pakfile, vector<UnpakEntry> & _entries, UnpakMode _mode)
+		: pakfile(_pakfile), entries(_entries), mode(_mode) { }
+	
+	~UnpakTask() {
+		for(vector<PakReader *>::iterator i = readers.begin(); i != readers.end(); ++i) {
+			delete *i;
+		}
+	}
+	
+	void process(size_t i) {
+		
+		PakReader * reader = acquireReader();
+		if(!reader) {
+			return;
+		}
+		
+		entries[i].ok = unpakEntry(*reader, entries[i]);
+		
+		releaseReader(reader);
+	}
+	
+};
+
+static int list(const vector<UnpakEntry> & entries) {
+	
+	size_t total = 0, totalCompressed = 0;
+	
+	for(vector<UnpakEntry>::const_iterator i = entries.begin(); i != entries.end(); ++i) {
+		float ratio = i->size ? 100.f * float(i->compressedSize) / float(i->size) : 100.f;
+		printf("%10lu %10lu %5.1f%%  %s\n", (unsigned long)i->size,
+		       (unsigned long)i->compressedSize, ratio, i->name.string().c_str());
+		total += i->size, totalCompressed += i->compressedSize;
 	}
 	
+	float ratio = total ? 100.f * float(totalCompressed) / float(total) : 100.f;
+	printf("%10lu %10lu %5.1f%%  (%lu files)\n", (unsigned long)total,
+	       (unsigned long)totalCompressed, ratio, (unsigned long)entries.size());
+	
+	return 0;
+}
+
+static int unpak(const fs::path & pakfile, UnpakMode mode) {
+	
+	PakReader pak;
+	if(!pak.addArchive(pakfile)) {
+		printf("error opening PAK file: %s\n", pakfile.string().c_str());
+		return 1;
+	}
+	
+	vector<UnpakEntry> entries;
+	collect(entries, pak);
+	
+	if(mode == UnpakList) {
+		return list(entries);
+	}
+	
+	if(mode == UnpakExtract) {
+		// Create all directories up front so that the workers only need to write files.
+		fs::path lastDir;
+		for(vector<UnpakEntry>::const_iterator i = entries.begin(); i != entries.end(); ++i) {
+			fs::path dir = i->filename.parent();
+			if(dir.empty() || dir == lastDir) {
+				continue;
+			}
+			if(!fs::create_directories(dir)) {
+				printf("error creating directory: %s\n", dir.string().c_str());
+				return 1;
+			}
+			lastDir = dir;
+		}
+	}
+	
+	{
+		UnpakTask task(pakfile, entries, mode);
+		WorkerPool::run(task, entries.size());
+	}
+	
+	size_t errors = 0;
+	for(vector<UnpakEntry>::const_iterator i = entries.begin(); i != entries.end(); ++i) {
+		if(!i->ok) {
+			printf("error %s file: %s\n", mode == UnpakExtract ? "extracting" : "verifying",
+			       i->name.string().c_str());
+			errors++;
+		} else if(mode == UnpakVerify) {
+			printf("%08x %10lu  %s\n", (unsigned)i->crc, (unsigned long)i->size,
+			       i->name.string().c_str());
+		} else {
+			printf("%s\n", i->filename.string().c_str());
+		}
+	}
+	
+	if(mode == UnpakVerify) {
+		printf("%lu files verified, %lu errors\n", (unsigned long)entries.size(),
+		       (unsigned long)errors);
+	}
+	
+	return errors ? 1 : 0;
+}
+
+static void print_help() {
+	printf("usage: unpak [--list|--verify] [-j <threads>] <pakfile> [<pakfile>...]\n");
+	printf("  --list      list the files with their sizes and compression ratios\n");
+	printf("  --verify    decompress all files and check their sizes without writing them\n");
+	printf("  -j <n>      number of threads to use (default: one per processor)\n");
 }
 
 int main(int argc, char ** argv) {
@@ -81,21 +268,33 @@ int main(int argc, char ** argv) {
 	
 	Logger::initialize();
 	
-	if(argc < 2) {
-		printf("usage: unpak <pakfile> [<pakfile>...]\n");
+	UnpakMode mode = UnpakExtract;
+	
+	int i = 1;
+	for(; i < argc && argv[i][0] == '-'; i++) {
+		if(!strcmp(argv[i], "--list") || !strcmp(argv[i], "-l")) {
+			mode = UnpakList;
+		} else if(!strcmp(argv[i], "--verify") || !strcmp(argv[i], "-v")) {
+			mode = UnpakVerify;
+		} else if((!strcmp(argv[i], "--jobs") || !strcmp(argv[i], "-j")) && i + 1 < argc) {
+			WorkerPool::setThreadCount(size_t(std::max(atoi(argv[++i]), 0)));
+		} else {
+			print_help();
+			return 1;
+		}
+	}
+	
+	if(i >= argc) {
+		print_help();
 		return 1;
 	}
 	
-	for(int i = 1; i < argc; i++) {
-		
-		PakReader pak;
-		if(!pak.addArchive(argv[i])) {
-			printf("error opening PAK file\n");
-			return 1;
+	int ret = 0;
+	for(; i < argc; i++) {
+		if(int error = unpak(argv[i], mode)) {
+			ret = error;
 		}
-		
-		dump(pak);
-		
 	}
 	
+	return ret;
 }